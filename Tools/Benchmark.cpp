@@ -0,0 +1,1451 @@
+//
+//  Benchmark.cpp
+//  Tools
+//
+//  渲染引擎各子系统的性能基准测试，运行于开发机或 Linux 基准测试机上。
+//  引擎源文件与 GLStub 一同编译（参见 ReplayTrace.cpp），无需 GPU：
+//  编译方式：c++ -std=c++11 -O2 -IGLStub -I../opengles2 Benchmark.cpp GLStub/GLStub.cpp ../opengles2/*.cpp -o benchmark -pthread
+//  用法：benchmark <测试名> [参数...]，不带参数运行时列出全部测试。
+//  vectormath 还应以 -O0 编译运行一次，以衡量调试版本中的表现。
+//
+
+#include "DynamicResolution.hpp"
+#include "EngineCommandQueue.hpp"
+#include "FixedTimestep.hpp"
+#include "Fixed.hpp"
+#include "GLStub.h"
+#include "JobSystem.hpp"
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include "MeshFile.hpp"
+#include "OcclusionCuller.hpp"
+#include "Quaternion.hpp"
+#include "RayPicking.hpp"
+#include "RenderQueue.hpp"
+#include "StreamingScene.hpp"
+#include "Tessellation.hpp"
+#include "Texture.hpp"
+#include "VCCRenderingEngine.hpp"
+#include "VertexStream.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+using namespace std;
+
+static double Now()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 重复运行 body 并返回最短的一次耗时（秒），以降低系统调度带来的噪声。
+template <typename Body>
+static double BestOf(int runs, Body body)
+{
+    double best = 1e30;
+    for (int i = 0; i < runs; ++i) {
+        double start = Now();
+        body();
+        best = min(best, Now() - start);
+    }
+    return best;
+}
+
+static void PrintScalingRow(unsigned threads, double seconds, double serialSeconds)
+{
+    double speedup = serialSeconds / seconds;
+    cout << setw(8) << threads << setw(12) << fixed << setprecision(3) << seconds * 1000
+         << setw(10) << setprecision(2) << speedup << setw(11) << setprecision(0) << speedup / threads * 100 << "%" << endl;
+}
+
+// 从 1 个线程到 maxThreads 个线程，分别以粗粒度（每个任务生成若干网格）与细粒度（逐段变换顶点）的负载测量调度器的扩展性。
+static int BenchmarkJobs(int argc, char** argv)
+{
+    unsigned maxThreads = argc > 0 ? (unsigned) atoi(argv[0]) : thread::hardware_concurrency();
+    maxThreads = max(1u, maxThreads);
+    const size_t MeshCount = 256;
+    const int MeshSlices = 2048;
+    const size_t VertexCount = 1 << 21;
+
+    vector<vector<Vertex> > meshes(MeshCount);
+    vector<vec3> bounds(MeshCount * 2);
+    vector<vec3> positions(VertexCount), transformed(VertexCount);
+    for (size_t i = 0; i < VertexCount; ++i)
+        positions[i] = vec3(float(i % 1024), float(i / 1024), 1);
+    mat4 m = mat4::Rotate(30, vec3(0, 0, 1)) * mat4::Translate(1, 2, 3);
+
+    cout << "JobSystem scaling, " << thread::hardware_concurrency() << " hardware threads" << endl;
+    for (int workload = 0; workload < 2; ++workload) {
+        if (workload == 0)
+            cout << endl << "tessellation: " << MeshCount << " cones x " << MeshSlices << " slices, grain 4" << endl;
+        else
+            cout << endl << "transform: " << VertexCount << " vertices, grain 16384" << endl;
+        cout << setw(8) << "threads" << setw(12) << "ms" << setw(10) << "speedup" << setw(12) << "efficiency" << endl;
+
+        double serial = 0;
+        for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+            JobSystem jobs(threads);
+            double seconds;
+            if (workload == 0) {
+                seconds = BestOf(5, [&]() {
+                    jobs.ParallelFor(MeshCount, 4, [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) {
+                            meshes[i].clear();
+                            GenerateCone(meshes[i], ConeRadius, ConeHeight, MeshSlices);
+                            ComputeBounds(&meshes[i][0], meshes[i].size(), bounds[2 * i], bounds[2 * i + 1]);
+                        }
+                    });
+                });
+            } else {
+                seconds = BestOf(5, [&]() {
+                    jobs.ParallelFor(VertexCount, 16384, [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; ++i) {
+                            const vec3& p = positions[i];
+                            transformed[i] = vec3(p.x * m.x.x + p.y * m.y.x + p.z * m.z.x + m.w.x,
+                                                  p.x * m.x.y + p.y * m.y.y + p.z * m.z.y + m.w.y,
+                                                  p.x * m.x.z + p.y * m.y.z + p.z * m.z.z + m.w.z);
+                        }
+                    });
+                });
+            }
+            if (threads == 1)
+                serial = seconds;
+            PrintScalingRow(threads, seconds, serial);
+        }
+    }
+
+    // 输出校验值，避免计算结果被编译器整体优化掉。
+    float checksum = 0;
+    for (size_t i = 0; i < bounds.size(); ++i)
+        checksum += bounds[i].x + bounds[i].y + bounds[i].z;
+    checksum += transformed[VertexCount - 1].x;
+    cout << endl << "checksum " << checksum << endl;
+    return 0;
+}
+
+// 以 slices 个片段生成椎体与底盘：先以 GenerateCone()/GenerateDisk() 单线程生成作为基准，
+// 再以 TessellateCone()/TessellateDisk() 在 1 至 maxThreads 个线程上生成，并逐位比较两者的输出。
+static int BenchmarkTessellate(int argc, char** argv)
+{
+    int slices = argc > 0 ? atoi(argv[0]) : 1000000;
+    unsigned maxThreads = argc > 1 ? (unsigned) atoi(argv[1]) : thread::hardware_concurrency();
+    slices = max(3, slices);
+    maxThreads = max(1u, maxThreads);
+
+    vector<Vertex> serialCone, serialDisk, cone, disk;
+    double serial = BestOf(3, [&]() {
+        GenerateCone(serialCone, ConeRadius, ConeHeight, slices);
+        GenerateDisk(serialDisk, ConeRadius, ConeHeight, slices);
+    });
+    size_t vertices = serialCone.size() + serialDisk.size();
+    cout << "tessellation: " << slices << " slices, " << vertices << " vertices ("
+         << vertices * sizeof(Vertex) / (1024 * 1024) << " MB), grain " << TessellationGrain << endl;
+    cout << "serial " << fixed << setprecision(3) << serial * 1000 << " ms" << endl;
+    cout << setw(8) << "threads" << setw(12) << "ms" << setw(10) << "speedup" << setw(12) << "efficiency" << endl;
+
+    bool identical = true;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        JobSystem jobs(threads);
+        double seconds = BestOf(3, [&]() {
+            TessellateCone(jobs, cone, ConeRadius, ConeHeight, slices);
+            TessellateDisk(jobs, disk, ConeRadius, ConeHeight, slices);
+        });
+        identical = identical && memcmp(&cone[0], &serialCone[0], cone.size() * sizeof(Vertex)) == 0
+                              && memcmp(&disk[0], &serialDisk[0], disk.size() * sizeof(Vertex)) == 0;
+        PrintScalingRow(threads, seconds, serial);
+    }
+
+    // 最后一个圆周点（角度为 2π）与第一个圆周点的距离，用于检验高细分度下圆周是否闭合。
+    vec3 closure = disk.back().Position - disk[1].Position;
+    cout << "output " << (identical ? "identical to" : "DIFFERS from") << " serial, closure error "
+         << scientific << setprecision(2) << sqrt(closure.Dot(closure)) << endl;
+    return identical ? 0 : 1;
+}
+
+// 逐通道以整数求 2×2 平均、每一级都由上一级的 8 位像素生成的 mipmap 链，即常见的朴素实现，作为比较的基准。
+static void ScalarBoxMipChain(const TextureImage& base, vector<TextureImage>& levels)
+{
+    levels.assign(1, base);
+    while (levels.back().Width > 1 || levels.back().Height > 1) {
+        const TextureImage& source = levels.back();
+        TextureImage next;
+        next.Width = max(1, source.Width / 2);
+        next.Height = max(1, source.Height / 2);
+        next.Pixels.resize(size_t(next.Width) * next.Height * 4);
+        for (int y = 0; y < next.Height; ++y) {
+            int y0 = min(2 * y, source.Height - 1), y1 = min(2 * y + 1, source.Height - 1);
+            for (int x = 0; x < next.Width; ++x) {
+                int x0 = min(2 * x, source.Width - 1), x1 = min(2 * x + 1, source.Width - 1);
+                for (int c = 0; c < 4; ++c) {
+                    int sum = source.Pixels[(size_t(y0) * source.Width + x0) * 4 + c] + source.Pixels[(size_t(y0) * source.Width + x1) * 4 + c]
+                            + source.Pixels[(size_t(y1) * source.Width + x0) * 4 + c] + source.Pixels[(size_t(y1) * source.Width + x1) * 4 + c];
+                    next.Pixels[(size_t(y) * next.Width + x) * 4 + c] = (uint8_t) ((sum + 2) / 4);
+                }
+            }
+        }
+        levels.push_back(next);
+    }
+}
+
+static bool SameMipChain(const vector<TextureImage>& a, const vector<TextureImage>& b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].Pixels != b[i].Pixels)
+            return false;
+    return true;
+}
+
+static int MaxMipDifference(const vector<TextureImage>& a, const vector<TextureImage>& b)
+{
+    int difference = 0;
+    for (size_t i = 0; i < min(a.size(), b.size()); ++i)
+        for (size_t p = 0; p < min(a[i].Pixels.size(), b[i].Pixels.size()); ++p)
+            difference = max(difference, abs(int(a[i].Pixels[p]) - int(b[i].Pixels[p])));
+    return difference;
+}
+
+// 比较朴素的整数 2×2 平均与 GenerateMipChain() 的 SIMD 实现（盒式与 Kaiser 滤波）在 1 至 maxThreads 个线程上的吞吐量，
+// 并核对多线程的结果与单线程逐位相同。也可传入原始 RGBA 文件及其尺寸代替程序生成的图像。
+static int BenchmarkMipmaps(int argc, char** argv)
+{
+    int size = argc > 0 ? atoi(argv[0]) : 2048;
+    unsigned maxThreads = argc > 1 ? (unsigned) atoi(argv[1]) : thread::hardware_concurrency();
+    maxThreads = max(1u, maxThreads);
+    TextureImage base;
+    if (argc > 4) {
+        if (!LoadRawImage(argv[2], atoi(argv[3]), atoi(argv[4]), base))
+            return 1;
+    } else {
+        // 渐变叠加伪随机噪声，各通道互不相同。
+        size = max(1, size);
+        base.Width = base.Height = size;
+        base.Pixels.resize(size_t(size) * size * 4);
+        uint32_t seed = 1;
+        for (size_t i = 0; i < base.Pixels.size(); ++i) {
+            seed = seed * 1664525 + 1013904223;
+            size_t pixel = i / 4;
+            int gradient = int((pixel % size + pixel / size) * 255 / (2 * size));
+            base.Pixels[i] = (uint8_t) min(255, gradient / 2 + int(seed >> 25));
+        }
+    }
+    double megapixels = base.Width * double(base.Height) / 1e6;
+    vector<TextureImage> reference, serial, levels;
+    double scalar = BestOf(3, [&]() { ScalarBoxMipChain(base, reference); });
+    cout << "mipmaps: " << base.Width << "x" << base.Height << ", " << MipLevelCount(base.Width, base.Height) << " levels"
+         << (IsPowerOfTwo(base.Width) && IsPowerOfTwo(base.Height) ? "" : " (not a power of two, level 0 only)") << endl;
+    cout << "scalar 8-bit box " << fixed << setprecision(3) << scalar * 1000 << " ms (" << setprecision(1)
+         << megapixels / scalar << " Mpixel/s)" << endl;
+
+    bool identical = true;
+    const MipFilter filters[] = { MipFilterBox, MipFilterKaiser };
+    const char* names[] = { "box", "Kaiser" };
+    for (int f = 0; f < 2; ++f) {
+        double single = BestOf(3, [&]() { GenerateMipChain(base, filters[f], serial); });
+        cout << names[f] << ": SIMD, no job system " << setprecision(3) << single * 1000 << " ms (" << setprecision(1)
+             << megapixels / single << " Mpixel/s, " << setprecision(2) << scalar / single << "x scalar)";
+        if (filters[f] == MipFilterBox)
+            cout << ", max difference from 8-bit chain " << MaxMipDifference(serial, reference);
+        cout << endl;
+        cout << setw(8) << "threads" << setw(12) << "ms" << setw(10) << "speedup" << setw(12) << "efficiency" << endl;
+        for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+            JobSystem jobs(threads);
+            double seconds = BestOf(3, [&]() { GenerateMipChain(base, filters[f], levels, &jobs); });
+            identical = identical && SameMipChain(levels, serial);
+            PrintScalingRow(threads, seconds, single);
+        }
+    }
+    cout << "parallel output " << (identical ? "identical to" : "DIFFERS from") << " single-threaded output" << endl;
+    return identical ? 0 : 1;
+}
+
+// 表达式模板引入之前 Vector.hpp 与 Quaternion.hpp 中的运算符：每一步运算都返回一个新的对象。
+struct EagerVector3 {
+    EagerVector3() {}
+    EagerVector3(float x, float y, float z) : x(x), y(y), z(z) {}
+    EagerVector3 operator+(const EagerVector3& v) const { return EagerVector3(x + v.x, y + v.y, z + v.z); }
+    EagerVector3 operator-(const EagerVector3& v) const { return EagerVector3(x - v.x, y - v.y, z - v.z); }
+    EagerVector3 operator*(float s) const { return EagerVector3(x * s, y * s, z * s); }
+    float x, y, z;
+};
+
+struct EagerQuaternion {
+    EagerQuaternion() {}
+    EagerQuaternion(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    EagerQuaternion operator+(const EagerQuaternion& q) const { return EagerQuaternion(x + q.x, y + q.y, z + q.z, w + q.w); }
+    EagerQuaternion operator-(const EagerQuaternion& q) const { return EagerQuaternion(x - q.x, y - q.y, z - q.z, w - q.w); }
+    EagerQuaternion Scaled(float s) const { return EagerQuaternion(x * s, y * s, z * s, w * s); }
+    float x, y, z, w;
+};
+
+static void PrintVectorMathRow(const char* name, double eager, double fused, bool identical)
+{
+    cout << setw(28) << left << name << right << setw(12) << fixed << setprecision(3) << eager * 1000
+         << setw(12) << fused * 1000 << setw(10) << setprecision(2) << eager / fused << (identical ? "" : "  DIFFERS") << endl;
+}
+
+// 比较逐步求值的运算符与表达式模板在典型运算链上的耗时，并逐位比较两者的结果。
+// 分别以 -O2 与 -O0 编译运行，后者对应调试版本。
+static int BenchmarkVectorMath(int argc, char** argv)
+{
+    size_t count = argc > 0 ? (size_t) atol(argv[0]) : 1 << 20;
+    count = max<size_t>(1, count);
+    const int Runs = 5;
+    const float t = 0.375f;
+
+#ifdef __OPTIMIZE__
+    cout << "vector math, optimized build, ";
+#else
+    cout << "vector math, unoptimized build (-O0), ";
+#endif
+    cout << count << " elements" << endl;
+    cout << setw(28) << left << "chain" << right << setw(12) << "eager ms" << setw(12) << "fused ms" << setw(10) << "speedup" << endl;
+
+    // 顶点插值 a + (b - a) * t：逐元素书写与以 VectorSpan 对整个数组求值两种形式。
+    vector<EagerVector3> eagerA(count), eagerB(count), eagerOut(count);
+    vector<vec3> a(count), b(count), out(count), spanOut(count);
+    for (size_t i = 0; i < count; ++i) {
+        a[i] = vec3(float(i % 1024), float(i / 1024), 1);
+        b[i] = vec3(float(i % 7), 0.5f, float(i % 13));
+        eagerA[i] = EagerVector3(a[i].x, a[i].y, a[i].z);
+        eagerB[i] = EagerVector3(b[i].x, b[i].y, b[i].z);
+    }
+    double eager = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            eagerOut[i] = eagerA[i] + (eagerB[i] - eagerA[i]) * t;
+    });
+    double fused = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = a[i] + (b[i] - a[i]) * t;
+    });
+    bool identical = memcmp(&out[0], &eagerOut[0], count * sizeof(vec3)) == 0;
+    PrintVectorMathRow("vec3 lerp", eager, fused, identical);
+
+    VectorSpan<vec3> spanA(&a[0], count), spanB(&b[0], count);
+    double span = BestOf(Runs, [&]() { Evaluate(&spanOut[0], spanA + (spanB - spanA) * t); });
+    identical = memcmp(&spanOut[0], &eagerOut[0], count * sizeof(vec3)) == 0;
+    PrintVectorMathRow("vec3 lerp, VectorSpan", eager, span, identical);
+
+    // QuaternionT::Slerp() 中夹角很小时的线性插值 q + (v1 - q).Scaled(t)。
+    vector<EagerQuaternion> eagerQ(count), eagerV(count), eagerR(count);
+    vector<Quaternion> q(count), v(count), r(count);
+    for (size_t i = 0; i < count; ++i) {
+        q[i] = Quaternion::CreateFromAxisAngle(vec3(0, 1, 0), float(i % 360) * Pi / 180);
+        v[i] = Quaternion::CreateFromAxisAngle(vec3(1, 0, 0), float(i % 90) * Pi / 180);
+        eagerQ[i] = EagerQuaternion(q[i].x, q[i].y, q[i].z, q[i].w);
+        eagerV[i] = EagerQuaternion(v[i].x, v[i].y, v[i].z, v[i].w);
+    }
+    eager = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            eagerR[i] = eagerV[i] + (eagerQ[i] - eagerV[i]).Scaled(t);
+    });
+    fused = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            r[i] = v[i] + (q[i] - v[i]).Scaled(t);
+    });
+    identical = memcmp(&r[0], &eagerR[0], count * sizeof(Quaternion)) == 0;
+    PrintVectorMathRow("quaternion nlerp chain", eager, fused, identical);
+    return 0;
+}
+
+// 同一组输入分别以 float、double 与 Fixed16 计算：组合物体的变换矩阵、四元数 Slerp 与向量归一化。
+// 各结果转换为 double 后与 double 的结果比较。
+struct ScalarRun {
+    double Seconds[3];
+    vector<double> Results[3];
+};
+
+template <typename T>
+static ScalarRun RunScalarWorkloads(size_t count, int runs)
+{
+    // 输入取在 Fixed16 的范围之内。
+    vector<T> angles(count);
+    vector<Vector3<T> > offsets(count), vectors(count), normalized(count);
+    vector<QuaternionT<T> > from(count), to(count), slerped(count);
+    vector<Matrix4<T> > matrices(count);
+    Matrix4<T> parent = Matrix4<T>::Rotate(T(15), Vector3<T>(1, 0, 0)) * Matrix4<T>::Translate(T(0), T(0), T(-7));
+    for (size_t i = 0; i < count; ++i) {
+        angles[i] = T(double(i % 360));
+        offsets[i] = Vector3<T>(T((i % 97) * 0.25), T((i % 89) * 0.5 - 20), T(-double(i % 31)));
+        vectors[i] = Vector3<T>(T((i % 1000) * 0.1 - 49.95), T((i % 37) * 0.5 - 9), T(0.25 + i % 5));
+        from[i] = QuaternionT<T>::CreateFromAxisAngle(Vector3<T>(0, 1, 0), T((i % 360) * 3.14159265358979 / 180));
+        to[i] = QuaternionT<T>::CreateFromAxisAngle(Vector3<T>(1, 0, 0), T((i % 90) * 3.14159265358979 / 180));
+    }
+    const Vector3<T> axis(0, 0, 1);
+    const T t = T(0.375);
+    ScalarRun run;
+    run.Seconds[0] = BestOf(runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            matrices[i] = Matrix4<T>::Rotate(angles[i], axis) * Matrix4<T>::Translate(offsets[i].x, offsets[i].y, offsets[i].z) * parent;
+    });
+    run.Seconds[1] = BestOf(runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            slerped[i] = from[i].Slerp(t, to[i]);
+    });
+    run.Seconds[2] = BestOf(runs, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            normalized[i] = vectors[i].Normalized();
+    });
+    for (size_t i = 0; i < count; ++i) {
+        for (int k = 0; k < 16; ++k)
+            run.Results[0].push_back(double(matrices[i].Pointer()[k]));
+        for (int k = 0; k < 4; ++k)
+            run.Results[1].push_back(double(slerped[i][k]));
+        for (int k = 0; k < 3; ++k)
+            run.Results[2].push_back(double(normalized[i][k]));
+    }
+    return run;
+}
+
+static double MaxAbsoluteError(const vector<double>& values, const vector<double>& reference)
+{
+    double error = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+        error = max(error, fabs(values[i] - reference[i]));
+    return error;
+}
+
+static int BenchmarkScalars(int argc, char** argv)
+{
+    size_t count = argc > 0 ? (size_t) atol(argv[0]) : 100000;
+    count = max<size_t>(1, count);
+    const int Runs = 5;
+    const char* names[] = { "float", "double", "Fixed16" };
+    ScalarRun runs[] = { RunScalarWorkloads<float>(count, Runs), RunScalarWorkloads<double>(count, Runs),
+                         RunScalarWorkloads<Fixed16>(count, Runs) };
+
+    cout << "scalar types, " << count << " elements, ns per element (error: max absolute difference from double)" << endl;
+    cout << setw(10) << left << "type" << right << setw(12) << "compose" << setw(12) << "slerp" << setw(12) << "normalize"
+         << setw(14) << "compose err" << setw(12) << "slerp err" << setw(14) << "normalize err" << endl;
+    for (int type = 0; type < 3; ++type) {
+        cout << setw(10) << left << names[type] << right << fixed << setprecision(2);
+        for (int k = 0; k < 3; ++k)
+            cout << setw(12) << runs[type].Seconds[k] * 1e9 / count;
+        cout << scientific << setprecision(1);
+        cout << setw(14) << MaxAbsoluteError(runs[type].Results[0], runs[1].Results[0]);
+        cout << setw(12) << MaxAbsoluteError(runs[type].Results[1], runs[1].Results[1]);
+        cout << setw(14) << MaxAbsoluteError(runs[type].Results[2], runs[1].Results[2]) << endl;
+    }
+    cout << fixed << setprecision(2);
+    for (int type = 1; type < 3; ++type)
+        cout << names[type] << " vs float: compose " << runs[0].Seconds[0] / runs[type].Seconds[0] << "x, slerp "
+             << runs[0].Seconds[1] / runs[type].Seconds[1] << "x, normalize " << runs[0].Seconds[2] / runs[type].Seconds[2] << "x" << endl;
+
+    // 远离原点的物体：世界变换与摄像机变换以 float 组合时，平移分量的舍入误差随坐标增大；
+    // 以 double 组合后再转换为 float，摄像机附近的物体仍精确至 float 的相对精度。
+    double floatError = 0, doubleError = 0;
+    for (int i = 0; i < 1000; ++i) {
+        double camera = 1e6 + i * 7.31, world = camera + (i % 100) * 0.0137 - 0.5;
+        mat4 single = mat4::Translate(float(world), 1, -2) * mat4::Translate(float(-camera), 0, 0);
+        mat4 downcast(dmat4::Translate(world, 1, -2) * dmat4::Translate(-camera, 0, 0));
+        floatError = max(floatError, fabs(single.w.x - (world - camera)));
+        doubleError = max(doubleError, fabs(downcast.w.x - (world - camera)));
+    }
+    cout << "large world (camera 1e6 units from origin): view-space error " << scientific << setprecision(1)
+         << floatError << " composed in float, " << doubleError << " composed in double" << endl;
+    cout << defaultfloat;
+    return 0;
+}
+
+// 每个动画物体每帧提交至 GPU 的变换数据：CPU 上逐帧 Slerp 并展开为 Modelview 矩阵（16 个浮点数），
+// 逐帧 Slerp 后只提交四元数与平移（QuaternionTransform 的前 8 个浮点数），或只提交起止四元数与插值系数、由顶点着色器插值（12 个浮点数）。
+static int BenchmarkTransforms(int argc, char** argv)
+{
+    size_t count = argc > 0 ? (size_t) atol(argv[0]) : 100000;
+    count = max<size_t>(1, count);
+    const int Runs = 5;
+    const float AnimationDuration = 0.25f;
+
+    vector<Quaternion> start(count), end(count);
+    vector<float> elapsed(count);
+    vector<vec3> translation(count);
+    for (size_t i = 0; i < count; ++i) {
+        start[i] = Quaternion::CreateFromAxisAngle(vec3(0, 1, 0), float(i % 180) * Pi / 180);
+        end[i] = Quaternion::CreateFromAxisAngle(vec3(1, 0, 0), float(i % 90) * Pi / 180);
+        elapsed[i] = float(i % 100) / 100 * AnimationDuration;
+        translation[i] = vec3(float(i % 100), float(i / 100 % 100), -7);
+    }
+    mat4 dequantization;
+    vector<mat4> matrices(count);
+    vector<QuaternionTransform> transforms(count);
+
+    double matrix = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            Quaternion current = start[i].Slerp(elapsed[i] / AnimationDuration, end[i]);
+            matrices[i] = dequantization * mat4(current.ToMatrix()) * mat4::Translate(translation[i].x, translation[i].y, translation[i].z);
+        }
+    });
+    double quaternion = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            transforms[i].Rotation = start[i].Slerp(elapsed[i] / AnimationDuration, end[i]);
+            transforms[i].Translation = translation[i];
+            transforms[i].Blend = 0;
+        }
+    });
+    // 着色器中的插值与 QuaternionTransform::Apply() 相同，这里顺便检验其与矩阵路径的差异（nlerp 与 slerp 并不完全相同）。
+    double blend = BestOf(Runs, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            transforms[i].Rotation = start[i];
+            transforms[i].RotationEnd = end[i];
+            transforms[i].Blend = elapsed[i] / AnimationDuration;
+            transforms[i].Translation = translation[i];
+        }
+    });
+    float maxError = 0;
+    vec3 p(1, 1, 1);
+    for (size_t i = 0; i < count; ++i) {
+        const mat4& m = matrices[i];
+        vec3 expected(p.x * m.x.x + p.y * m.y.x + p.z * m.z.x + m.w.x, p.x * m.x.y + p.y * m.y.y + p.z * m.z.y + m.w.y,
+                      p.x * m.x.z + p.y * m.y.z + p.z * m.z.z + m.w.z);
+        vec3 d = transforms[i].Apply(p) - expected;
+        maxError = max(maxError, sqrt(d.Dot(d)));
+    }
+
+    cout << count << " animated objects" << endl;
+    cout << setw(28) << left << "path" << right << setw(12) << "ms" << setw(14) << "ns/object" << setw(16) << "bytes/object" << endl;
+    const char* names[] = { "CPU slerp, mat4 Modelview", "CPU slerp, quaternion", "GPU nlerp, quaternions" };
+    double seconds[] = { matrix, quaternion, blend };
+    size_t bytes[] = { sizeof(mat4), 8 * sizeof(float), sizeof(QuaternionTransform) };
+    for (int i = 0; i < 3; ++i)
+        cout << setw(28) << left << names[i] << right << fixed << setprecision(3) << setw(12) << seconds[i] * 1000
+             << setprecision(1) << setw(14) << seconds[i] * 1e9 / count << setw(16) << bytes[i] << endl;
+    cout << "max position difference of GPU nlerp from slerp: " << setprecision(6) << maxError << endl;
+    return 0;
+}
+
+// 在 XZ 平面上排列 instances 个椎体实例（与流式场景的网格相同）并从斜上方观察，以随机的屏幕坐标反投影出 rays 条射线，
+// 比较逐一求交的参照实现与 RayPicker 的批量拾取，并检验二者的结果一致。参照实现只计算部分射线，以免耗时过长。
+static int BenchmarkPick(int argc, char** argv)
+{
+    size_t count = argc > 0 ? (size_t) atol(argv[0]) : 1000000;
+    size_t rayCount = argc > 1 ? (size_t) atol(argv[1]) : 10000;
+    count = max<size_t>(1, count);
+    rayCount = max<size_t>(1, rayCount);
+    const int Width = 320, Height = 480;
+
+    uint32_t columns = (uint32_t) ceil(sqrt((double) count));
+    uint32_t rows = (uint32_t) ((count + columns - 1) / columns);
+    float spacing = 3.0f / columns;
+    vector<PickInstance> instances(count);
+    for (size_t i = 0; i < count; ++i) {
+        float column = float(i % columns) - (columns - 1) * 0.5f;
+        float row = float(i / columns) - (rows - 1) * 0.5f;
+        instances[i].Position = vec3(column * spacing, 0, row * spacing);
+        instances[i].Scale = spacing * 0.4f;
+        instances[i].Id = (int32_t) i;
+    }
+    mat4 modelview = mat4::Rotate(40, vec3(1, 0, 0)) * mat4::Translate(0, 0, -7);
+    mat4 projection = mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10);
+    vector<PickRay> rays(rayCount);
+    srand(1);
+    for (size_t i = 0; i < rayCount; ++i)
+        rays[i] = UnprojectScreenPoint(float(rand()) / RAND_MAX * Width, float(rand()) / RAND_MAX * Height, Width, Height,
+                                       modelview, projection);
+
+    RayPicker picker;
+    double build = BestOf(1, [&]() { picker.SetInstances(&instances[0], count); });
+    vector<PickHit> hits(rayCount);
+    PickStats stats = {};
+    double batched = BestOf(3, [&]() {
+        stats = PickStats();
+        picker.Pick(&rays[0], rayCount, &hits[0], FLT_MAX, &stats);
+    });
+
+    size_t referenceCount = min(rayCount, max<size_t>(1, 200000000 / count));
+    vector<PickHit> reference(referenceCount);
+    double bruteForce = BestOf(1, [&]() {
+        for (size_t r = 0; r < referenceCount; ++r) {
+            reference[r].Instance = -1;
+            reference[r].Distance = FLT_MAX;
+            for (size_t i = 0; i < count; ++i) {
+                float distance;
+                if (IntersectConeInstance(rays[r], instances[i], ConeRadius, ConeHeight, distance) && distance < reference[r].Distance) {
+                    reference[r].Instance = instances[i].Id;
+                    reference[r].Distance = distance;
+                }
+            }
+        }
+    });
+    // 两个实例到射线的距离几乎相等时，二者的舍入误差可能使结果不同，因此只有距离也不同时才算作不一致。
+    size_t mismatches = 0;
+    for (size_t r = 0; r < referenceCount; ++r) {
+        const PickHit& a = hits[r];
+        const PickHit& b = reference[r];
+        if (a.Instance != b.Instance && (a.Instance < 0 || b.Instance < 0 || fabs(a.Distance - b.Distance) > 1e-4f * max(1.0f, b.Distance)))
+            mismatches++;
+    }
+
+    cout << count << " instances, " << rayCount << " rays, " << stats.Hits << " hits, built in " << fixed << setprecision(1)
+         << build * 1000 << " ms" << endl;
+    cout << setw(28) << left << "path" << right << setw(12) << "ns/ray" << setw(14) << "bounds/ray" << setw(16) << "instances/ray" << endl;
+    cout << setw(28) << left << "scalar, every instance" << right << setw(12) << bruteForce * 1e9 / referenceCount
+         << setw(14) << 0.0 << setw(16) << (double) count << endl;
+    cout << setw(28) << left << "RayPicker, SIMD + bounds" << right << setw(12) << batched * 1e9 / rayCount
+         << setw(14) << (double) stats.BoundsTested / rayCount << setw(16) << (double) stats.InstancesTested / rayCount << endl;
+    cout << "speedup " << setprecision(0) << bruteForce / referenceCount / (batched / rayCount) << "x, " << mismatches
+         << " mismatches in " << referenceCount << " rays checked against the scalar reference" << endl;
+    return mismatches ? 1 : 0;
+}
+
+// 以给定的帧时间驱动控制器 frames 帧，返回第一次改变比例的帧（从 1 开始），比例始终不变时返回 0。
+static int RunResolutionFrames(DynamicResolutionController& controller, int frames, float frameTime)
+{
+    int changed = 0;
+    for (int i = 1; i <= frames; ++i)
+        if (controller.Update(frameTime) && !changed)
+            changed = i;
+    return changed;
+}
+
+static int CheckFailures = 0;
+
+static void Check(bool passed, const char* description)
+{
+    cout << (passed ? "  ok    " : "  FAIL  ") << description << endl;
+    if (!passed)
+        CheckFailures++;
+}
+
+static bool Near(float a, float b) { return fabs(a - b) < 1e-4f; }
+
+// 以合成的帧时间序列检验动态分辨率控制器：稳定时不调整、超标时降低（每次至多 4 级，不低于下限）、
+// 忽略异常值、达标 ProbeFrames 帧后试探提高一级，以及试探失败后再次尝试同一比例前的等待加倍。
+static void CheckDynamicResolution()
+{
+    const float Target = 1.0f / 60;
+    const int Settle = DynamicResolutionController::SettleFrames;
+    const int Probe = DynamicResolutionController::ProbeFrames;
+    cout << "DynamicResolutionController (target 60 Hz, scale 0.5 to 1)" << endl;
+
+    DynamicResolutionController controller(Target, 0.5f, 1);
+    Check(RunResolutionFrames(controller, 600, Target) == 0 && Near(controller.Scale(), 1), "on target: scale stays at 1");
+    Check(RunResolutionFrames(controller, 1, Target * 8) == 0 && Near(controller.Scale(), 1)
+          && Near(controller.SmoothedFrameTime(), Target), "outlier frame (8x target) ignored");
+
+    // 滑动平均在第 2 帧达到 1.19 倍，按像素数估算的比例 sqrt(1 / 1.19) 量化为 0.9。
+    Check(RunResolutionFrames(controller, 10, Target * 2) == 2 && Near(controller.Scale(), 0.9f),
+          "vsync halving (2x target): drops to 0.9 on the 2nd frame");
+    RunResolutionFrames(controller, 200, Target * 2);
+    Check(Near(controller.Scale(), 0.5f), "sustained 2x target: settles at the 0.5 floor");
+
+    // 第一帧即为滑动平均的初值；sqrt(1 / 3) 约为 0.58，但单次至多降低 4 级。
+    controller.Reset();
+    Check(RunResolutionFrames(controller, 1, Target * 3) == 1 && Near(controller.Scale(), 0.8f),
+          "3x target from the first frame: drops at most 4 steps to 0.8");
+    
+    controller.Reset();
+    RunResolutionFrames(controller, 1, Target * 2);
+    Check(RunResolutionFrames(controller, Settle + Probe, Target) == Settle + Probe && Near(controller.Scale(), 0.85f),
+          "back on target: probes one step up after SettleFrames + ProbeFrames");
+    // 1.15 倍的帧时间在等待期后使滑动平均超出 1.1 倍，试探的比例随即退回一级。
+    Check(RunResolutionFrames(controller, Settle + 1, Target * 1.15f) == Settle + 1 && Near(controller.Scale(), 0.8f),
+          "probe fails at 1.15x target: backs off to 0.8");
+    Check(RunResolutionFrames(controller, Settle + Probe, Target) == 0 && Near(controller.Scale(), 0.8f),
+          "failed scale not retried after ProbeFrames");
+    controller.Reset();
+    RunResolutionFrames(controller, 1, Target * 2);
+    RunResolutionFrames(controller, Settle + Probe, Target);
+    RunResolutionFrames(controller, Settle + 1, Target * 1.15f);
+    Check(RunResolutionFrames(controller, Settle + 2 * Probe, Target) == Settle + 2 * Probe && Near(controller.Scale(), 0.85f),
+          "failed scale retried after twice ProbeFrames");
+    Check(RunResolutionFrames(controller, Settle + Probe, Target) == 0 && Near(controller.Scale(), 0.85f),
+          "successful retry holds the scale");
+}
+
+// 以合成的帧时间序列检验固定步长时钟：步数、插值系数、单帧步数上限以及丢弃整数步后插值系数不变。
+static void CheckFixedTimestep()
+{
+    const float Step = 1.0f / 60;
+    cout << "FixedTimestep (60 Hz, at most 4 steps per frame)" << endl;
+
+    FixedTimestep clock(Step, 4);
+    int steps = 0;
+    bool single = true;
+    for (int i = 0; i < 600; ++i) {
+        int n = clock.Advance(Step);
+        single = single && n == 1;
+        steps += n;
+    }
+    Check(single && steps == 600 && clock.Alpha() < 1e-3f, "display at 60 Hz: one step per frame");
+
+    clock.Reset();
+    steps = 0;
+    bool alternating = true;
+    for (int i = 0; i < 600; ++i) {
+        int n = clock.Advance(Step / 2);
+        alternating = alternating && n == i % 2;
+        if (i % 2 == 0)
+            alternating = alternating && Near(clock.Alpha(), 0.5f);
+        steps += n;
+    }
+    Check(alternating && steps == 300, "display at 120 Hz: a step every other frame, alpha 0.5 between");
+
+    clock.Reset();
+    steps = 0;
+    for (int i = 0; i < 700; ++i)
+        steps += clock.Advance(i % 2 ? 1.0f / 50 : 1.0f / 70);
+    int expected = (int) floor((350.0 / 50 + 350.0 / 70) / Step);
+    Check(abs(steps - expected) <= 1 && clock.Stats().CappedFrames == 0, "jittered 50/70 Hz: steps follow elapsed time");
+
+    clock.Reset();
+    clock.Advance(Step / 2);
+    int spike = clock.Advance(1);
+    Check(spike == 4 && clock.Stats().CappedFrames == 1 && Near(clock.Alpha(), 0.5f)
+          && fabs(clock.Stats().DroppedSeconds - 56 * Step) < 1e-3,
+          "1 s spike: capped at 4 steps, 56 whole steps dropped, alpha kept");
+    Check(clock.Advance(Step) == 1 && Near(clock.Alpha(), 0.5f), "next frame after the spike: one step");
+    Check(clock.Advance(-Step) == 0 && Near(clock.Alpha(), 0.5f), "negative time step: no steps");
+}
+
+// 以单位投影矩阵（裁剪空间即 NDC）检验遮挡剔除：只遮住部分屏幕的遮挡体不得剔除延伸至未遮挡区域的物体，
+// 包括缓冲区尺寸经逐级减半出现奇数、金字塔末行（列）单独构成纹素的情形。
+static void CheckOcclusionCuller()
+{
+    cout << "OcclusionCuller (64x96 depth buffer, occluder over rows 0 to 63)" << endl;
+    // 覆盖 NDC y ∈ [-1, 1/3]（即第 0 至 63 行）、深度为 0.25 的矩形。
+    const float Top = 1.0f / 3;
+    const vec3 occluder[] = {
+        vec3(-1, -1, -0.5f), vec3(1, -1, -0.5f), vec3(1, Top, -0.5f),
+        vec3(-1, -1, -0.5f), vec3(1, Top, -0.5f), vec3(-1, Top, -0.5f),
+    };
+    mat4 identity;
+    OcclusionCuller culler;
+    culler.BeginFrame(identity);
+    culler.AddOccluder(occluder, 6, identity);
+    culler.RasterizeOccluders();
+
+    Check(culler.IsVisible(vec3(-1, -1, 0.5f), vec3(1, 1, 0.6f), identity), "full-screen box behind the occluder: visible");
+    Check(culler.IsVisible(vec3(-0.5f, 0.5f, 0.5f), vec3(0.5f, 0.9f, 0.6f), identity), "box beside the occluder: visible");
+    Check(culler.IsVisible(vec3(-0.5f, -0.8f, -0.9f), vec3(0.5f, 0, -0.8f), identity), "box in front of the occluder: visible");
+    Check(!culler.IsVisible(vec3(-0.5f, -0.8f, 0.5f), vec3(0.5f, 0, 0.6f), identity), "box behind the occluder: occluded");
+    Check(culler.Stats().Tested == 4 && culler.Stats().Occluded == 1, "stats: 1 of 4 objects occluded");
+}
+
+// 以固定的输入序列检验 GL 无关的控制器与剔除逻辑，任一检查失败时以非零状态退出。
+static int BenchmarkCheck(int, char**)
+{
+    CheckFailures = 0;
+    CheckDynamicResolution();
+    CheckFixedTimestep();
+    CheckOcclusionCuller();
+    cout << (CheckFailures ? "FAILED: " : "passed, ") << CheckFailures << " failure(s)" << endl;
+    return CheckFailures ? 1 : 0;
+}
+
+// 只统计收到的命令、不做任何渲染的引擎，用于单独衡量命令队列的开销。
+struct CountingEngine : VCCRenderingEngine {
+    CountingEngine() : Rotations(0) {}
+    void Initialize(int, int) {}
+    void Prepare(int, int) {}
+    void Finalize() {}
+    void RenderPlaceholder() {}
+    void Render() const {}
+    void UpdateAnimation(float) {}
+    void OnRotate(VCCDeviceOrientation) { Rotations++; }
+    void Resize(int, int) {}
+    bool LoadMesh(const char*) { return true; }
+    void SetSnapshotPath(const char*) {}
+    bool SaveSnapshot() const { return true; }
+    void SetCameras(const Camera*, size_t) {}
+    bool Pick(float, float, int&, float&) const { return false; }
+    VCCFrameStats GetFrameStats() const { return FrameStatsRecorder().Stats(); }
+    uint64_t Rotations;
+};
+
+// 以互斥量保护的 std::deque 作为对照：生产者与渲染线程争用同一把锁，deque 也会随增长分配内存。
+struct LockedCommandQueue {
+    mutex Mutex;
+    deque<EngineCommand> Commands;
+    bool Post(const EngineCommand& command)
+    {
+        lock_guard<mutex> lock(Mutex);
+        Commands.push_back(command);
+        return true;
+    }
+    size_t Drain(VCCRenderingEngine& engine)
+    {
+        lock_guard<mutex> lock(Mutex);
+        size_t count = Commands.size();
+        for (size_t i = 0; i < count; ++i)
+            engine.OnRotate(Commands[i].Orientation);
+        Commands.clear();
+        return count;
+    }
+};
+
+// producers 个线程持续投递方向变化，渲染线程每隔约 1 毫秒执行一次 Drain()，测量投递吞吐量以及单次 Drain() 的最长耗时，
+// 后者即输入对一帧的最坏影响。
+template <typename Queue>
+static void RunCommandQueue(const char* name, Queue& queue, unsigned producers, double seconds)
+{
+    CountingEngine engine;
+    atomic<bool> stopping(false);
+    atomic<uint64_t> posted(0), dropped(0);
+    vector<thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.push_back(thread([&, p]() {
+            EngineCommand command;
+            command.Type = EngineCommandRotate;
+            command.Orientation = (VCCDeviceOrientation) (p % 4 + 1);
+            uint64_t localPosted = 0, localDropped = 0;
+            while (!stopping.load(memory_order_relaxed)) {
+                if (queue.Post(command))
+                    localPosted++;
+                else
+                    localDropped++;
+            }
+            posted += localPosted;
+            dropped += localDropped;
+        }));
+    }
+    double start = Now(), worst = 0, total = 0;
+    uint64_t drains = 0;
+    while (Now() - start < seconds) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+        double drainStart = Now();
+        queue.Drain(engine);
+        double elapsed = Now() - drainStart;
+        worst = max(worst, elapsed);
+        total += elapsed;
+        drains++;
+    }
+    stopping = true;
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+    cout << setw(24) << left << name << right << fixed << setprecision(2) << setw(12) << posted / seconds / 1e6
+         << setw(12) << dropped / seconds / 1e6 << setw(14) << engine.Rotations / seconds / 1e6
+         << setprecision(1) << setw(12) << total / drains * 1e6 << setw(12) << worst * 1e6 << endl;
+}
+
+static int BenchmarkCommands(int argc, char** argv)
+{
+    unsigned producers = argc > 0 ? (unsigned) max(1, atoi(argv[0])) : 2;
+    const double Seconds = 1;
+    EngineCommandQueue lockFree;
+    LockedCommandQueue locked;
+    cout << producers << " producer threads, drain every ~1 ms, lock-free capacity " << lockFree.Capacity() << endl;
+    cout << setw(24) << left << "queue" << right << setw(12) << "posted M/s" << setw(12) << "dropped M/s" << setw(14)
+         << "applied M/s" << setw(12) << "drain us" << setw(12) << "worst us" << endl;
+    RunCommandQueue("EngineCommandQueue", lockFree, producers, Seconds);
+    RunCommandQueue("mutex + std::deque", locked, producers, Seconds);
+    return 0;
+}
+
+// 进程的峰值常驻内存（KB）。Linux 上 ru_maxrss 的单位为 KB，macOS 上则为字节。
+static long PeakResidentKB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// 流式生成一遍场景，消费者将每个数据块复制到暂存区以模拟 glBufferData 上传。
+static void RunStreamingPass(StreamingScene& scene, const char* label)
+{
+    vector<Vertex> staging(scene.Indices().size() / scene.IndicesPerInstance() * scene.VerticesPerInstance());
+    StreamingStats before = scene.Stats();
+    double start = Now();
+    scene.BeginPass();
+    while (const SceneChunk* chunk = scene.NextChunk()) {
+        memcpy(&staging[0], &chunk->Vertices[0], chunk->InstanceCount * scene.VerticesPerInstance() * sizeof(Vertex));
+        scene.ReleaseChunk(chunk);
+    }
+    double seconds = Now() - start;
+    StreamingStats after = scene.Stats();
+    uint64_t instances = after.Instances - before.Instances;
+    double bytes = (double) instances * scene.VerticesPerInstance() * sizeof(Vertex);
+    cout << label << ": " << instances << " instances in " << after.Chunks - before.Chunks << " chunks, "
+         << fixed << setprecision(1) << seconds * 1000 << " ms (" << instances / seconds / 1e6 << " M instances/s, "
+         << bytes / seconds / 1e9 << " GB/s), stalls producer " << after.ProducerStalls - before.ProducerStalls
+         << " consumer " << after.ConsumerStalls - before.ConsumerStalls << ", peak RSS " << PeakResidentKB() << " KB" << endl;
+}
+
+// 以生产者/消费者流水线流式生成网格场景或点文件场景，并比较规模相差十倍的两个场景的峰值内存，二者应基本相同。
+static int BenchmarkStream(int argc, char** argv)
+{
+    uint64_t instances = argc > 0 ? strtoull(argv[0], 0, 10) : 10000000;
+    const char* pointFile = argc > 1 ? argv[1] : 0;
+
+    StreamingScene scene;
+    cout << "StreamingScene: " << scene.VerticesPerInstance() << " vertices per instance, "
+         << scene.Indices().size() / scene.IndicesPerInstance() << " instances per chunk, "
+         << scene.PoolBytes() / 1024 << " KB buffer pool" << endl;
+    if (pointFile) {
+        if (!scene.SetPointFile(pointFile, 0.01f))
+            return 1;
+        RunStreamingPass(scene, pointFile);
+        return 0;
+    }
+    uint32_t columns = (uint32_t) max<uint64_t>(1, (uint64_t) sqrt((double) instances));
+    uint32_t rows = (uint32_t) ((instances + columns - 1) / columns);
+    scene.SetGrid(columns / 4 + 1, rows / 4 + 1, 0.01f, 0.004f);
+    RunStreamingPass(scene, "1/16 grid");
+    scene.SetGrid(columns, rows, 0.01f, 0.004f);
+    RunStreamingPass(scene, "full grid");
+    return 0;
+}
+
+// VertexStream 经 GLStub 调用 GL；映射返回的内存与 GL 缓冲区一样只写不读。
+struct StubStreamTraits {
+    typedef GLsync Fence;
+    static void* Map(GLuint buffer, size_t offset, size_t bytes)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        return glMapBufferRangeEXT(GL_ARRAY_BUFFER, offset, bytes,
+                                   GL_MAP_WRITE_BIT_EXT | GL_MAP_INVALIDATE_RANGE_BIT_EXT | GL_MAP_UNSYNCHRONIZED_BIT_EXT);
+    }
+    static void Unmap(GLuint) { glUnmapBufferOES(GL_ARRAY_BUFFER); }
+    static void Orphan(GLuint buffer, size_t bytes)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, 0, GL_STREAM_DRAW);
+    }
+    static GLsync InsertFence() { return glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0); }
+    static bool FenceSignaled(GLsync fence) { return glClientWaitSyncAPPLE(fence, 0, 0) != GL_TIMEOUT_EXPIRED_APPLE; }
+    static void WaitFence(GLsync fence) { glClientWaitSyncAPPLE(fence, GL_SYNC_FLUSH_COMMANDS_BIT_APPLE, GL_TIMEOUT_IGNORED_APPLE); }
+    static void DeleteFence(GLsync fence) { glDeleteSyncAPPLE(fence); }
+};
+
+// 以 VertexStream 流式提交 frames 帧形变的椎体，每帧 objects 个；返回每帧耗时（秒）。
+static double RunVertexStream(const vector<Vertex>& cone, int objects, int frames, size_t bufferBytes, unsigned int regions,
+                              VertexStreamSync sync, const char* label)
+{
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, bufferBytes, 0, GL_STREAM_DRAW);
+    VertexStream<StubStreamTraits> stream;
+    stream.Attach(buffer, bufferBytes, regions, sync);
+    size_t bytes = cone.size() * sizeof(Vertex);
+    double start = Now();
+    for (int frame = 0; frame < frames; ++frame) {
+        stream.BeginFrame();
+        for (int i = 0; i < objects; ++i) {
+            size_t offset;
+            Vertex* vertices = (Vertex*) stream.Map(bytes, offset);
+            if (!vertices)
+                continue;
+            MorphConeVertices(&cone[0], cone.size(), 0.15f, frame * 0.05f + i, vertices);
+            stream.Unmap();
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei) cone.size());
+        }
+        stream.EndFrame();
+    }
+    double seconds = (Now() - start) / frames;
+    const VertexStreamStats& stats = stream.Stats();
+    cout << setw(28) << left << label << right << fixed << setprecision(3) << setw(10) << seconds * 1000
+         << setw(10) << setprecision(0) << stats.BytesStreamed / 1024.0 / max<uint64_t>(1, stats.Frames)
+         << setw(10) << stats.StallsAvoided << setw(8) << stats.Stalls << setw(9) << stats.Orphans << setw(11) << stats.Overflows << endl;
+    stream.Detach();
+    glDeleteBuffers(1, &buffer);
+    return seconds;
+}
+
+// 每帧形变的几何：比较每帧重建 vector<Vertex> 并以客户端指针提交（驱动在绘制时复制一次）与经 VertexStream 写指针直接写入
+// 映射的缓冲区；再以不同的分区数与同步方式报告等待栅栏与避免等待的次数。GLStub 模拟 GPU 落后 CPU 两帧，等待栅栏只计数而不耗时。
+static int BenchmarkVertexStream(int argc, char** argv)
+{
+    int objects = argc > 0 ? max(1, atoi(argv[0])) : 64;
+    const int Frames = 300;
+    const int Slices = 256;
+    vector<Vertex> cone;
+    GenerateCone(cone, 0.5f, 1.866f, Slices);
+    size_t bytes = cone.size() * sizeof(Vertex);
+    size_t frameBytes = bytes * objects;
+    GLStubSetFenceLatency(2);
+    cout << objects << " morphing cones per frame, " << cone.size() << " vertices each, " << frameBytes / 1024 << " KB per frame, "
+         << "GPU 2 frames behind" << endl;
+
+    // 客户端数组：每个物体每帧分配新的数组，驱动在绘制调用中将其复制至自己的暂存区。
+    vector<unsigned char> driverCopy(bytes);
+    double start = Now();
+    for (int frame = 0; frame < Frames; ++frame) {
+        for (int i = 0; i < objects; ++i) {
+            vector<Vertex> morphed(cone.size());
+            MorphConeVertices(&cone[0], cone.size(), 0.15f, frame * 0.05f + i, &morphed[0]);
+            memcpy(&driverCopy[0], &morphed[0], bytes);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, (GLsizei) cone.size());
+        }
+    }
+    double clientSeconds = (Now() - start) / Frames;
+    cout << setw(28) << left << "stream" << right << setw(10) << "ms/frame" << setw(10) << "KB/frame" << setw(10) << "avoided"
+         << setw(8) << "stalls" << setw(9) << "orphans" << setw(11) << "overflows" << endl;
+    cout << setw(28) << left << "vector + client pointers" << right << fixed << setprecision(3) << setw(10) << clientSeconds * 1000
+         << setw(10) << setprecision(0) << frameBytes / 1024.0 << endl;
+
+    // 缓冲区为每帧数据量的 3 倍（向上取 64 KB），分区数不同时每个分区的大小随之变化。
+    size_t bufferBytes = (frameBytes * 3 + 65535) & ~size_t(65535);
+    double streamSeconds = RunVertexStream(cone, objects, Frames, bufferBytes, 3, VertexStreamFence, "fence, 3 regions");
+    RunVertexStream(cone, objects, Frames, bufferBytes, 2, VertexStreamFence, "fence, 2 regions");
+    RunVertexStream(cone, objects, Frames, bufferBytes, 3, VertexStreamOrphan, "orphan, 3 regions");
+    RunVertexStream(cone, objects, Frames, bufferBytes / 2, 3, VertexStreamFence, "fence, 3 regions, half size");
+    cout << "client pointers / stream: " << setprecision(2) << clientSeconds / streamSeconds << "x" << endl;
+    GLStubResetStats();
+    return 0;
+}
+
+// 测量从创建引擎到完成第一帧的时间：冷启动前删除快照，预热启动则从上一次写入的快照恢复。
+// 引擎的日志输出在计时期间被屏蔽。
+static int BenchmarkStartup(int argc, char** argv)
+{
+    int runs = 20;
+    bool es1 = false;
+    const char* snapshotPath = "startup.vccsnapshot";
+    for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], "--es1") == 0)
+            es1 = true;
+        else
+            runs = max(1, atoi(argv[i]));
+    }
+
+    double medians[2];
+    for (int warm = 0; warm < 2; ++warm) {
+        vector<double> times;
+        int restored = 0;
+        for (int run = 0; run < runs; ++run) {
+            if (!warm)
+                unlink(snapshotPath);
+            streambuf* log = cout.rdbuf(0);
+            double start = Now();
+            VCCRenderingEngine* engine = es1 ? CreateRenderer1() : CreateRenderer2();
+            engine->SetSnapshotPath(snapshotPath);
+            engine->Initialize(320, 480);
+            engine->Render();
+            double seconds = Now() - start;
+            restored += engine->GetFrameStats().SnapshotBytes > 0;
+            delete engine;
+            cout.rdbuf(log);
+            cout.clear();
+            times.push_back(seconds);
+        }
+        sort(times.begin(), times.end());
+        medians[warm] = times[times.size() / 2];
+        cout << (warm ? "warm" : "cold") << " start (" << (es1 ? "ES 1.1" : "ES 2.0") << "): " << runs << " runs, min "
+             << fixed << setprecision(3) << times.front() * 1000 << " ms, median " << medians[warm] * 1000
+             << " ms, max " << times.back() * 1000 << " ms, " << restored << " restored from the snapshot" << endl;
+    }
+    struct stat info;
+    if (stat(snapshotPath, &info) == 0)
+        cout << "snapshot " << info.st_size << " bytes, warm/cold " << setprecision(2) << medians[1] / medians[0] << endl;
+    unlink(snapshotPath);
+    return 0;
+}
+
+// 当前的常驻内存（KB），用于计算单个引擎实例占用的内存；峰值常驻内存只增不减，无法区分各项配置。
+static long CurrentResidentKB()
+{
+#ifdef __APPLE__
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return (long) (info.resident_size / 1024);
+#else
+    long pages = 0, resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file) {
+        if (fscanf(file, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        fclose(file);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#endif
+}
+
+// 进程全部线程（包括引擎的工作线程）累计占用的 CPU 时间（秒）。
+static double ProcessCpuSeconds()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// 将 objects 个椎体（各含椎体与底盘两个绘制区间）排列在视口内，写入 .vccmesh 文件，每个绘制区间即一次绘制调用。
+static bool WriteFrameBenchmarkMesh(const char* path, uint32_t objects, int slices)
+{
+    vector<Vertex> cone, disk, vertices;
+    GenerateCone(cone, ConeRadius, ConeHeight, slices);
+    GenerateDisk(disk, ConeRadius, ConeHeight, slices);
+    vector<MeshFileSubmesh> submeshes;
+    uint32_t columns = (uint32_t) ceil(sqrt((double) objects));
+    float scale = 2.0f / columns;
+    for (uint32_t i = 0; i < objects; ++i) {
+        vec3 offset((i % columns + 0.5f) * scale - 1, 0, (i / columns + 0.5f) * scale - 1);
+        MeshFileSubmesh strip = { MeshTopologyTriangleStrip, (uint32_t) vertices.size(), (uint32_t) cone.size(), 0 };
+        for (size_t v = 0; v < cone.size(); ++v) {
+            vertices.push_back(cone[v]);
+            vertices.back().Position = cone[v].Position * scale + offset;
+        }
+        MeshFileSubmesh fan = { MeshTopologyTriangleFan, (uint32_t) vertices.size(), (uint32_t) disk.size(), 0 };
+        for (size_t v = 0; v < disk.size(); ++v) {
+            vertices.push_back(disk[v]);
+            vertices.back().Position = disk[v].Position * scale + offset;
+        }
+        submeshes.push_back(strip);
+        submeshes.push_back(fan);
+    }
+
+    MeshFileSource source = {};
+    source.Vertices = &vertices[0];
+    source.VertexStride = sizeof(Vertex);
+    source.VertexCount = (uint32_t) vertices.size();
+    source.Attributes = VertexLayout(&source.AttributeCount);
+    source.Submeshes = &submeshes[0];
+    source.SubmeshCount = (uint32_t) submeshes.size();
+    ComputeBounds(&vertices[0], vertices.size(), source.BoundsMin, source.BoundsMax);
+    return WriteMeshFile(path, source);
+}
+
+struct FrameBenchmarkResult {
+    double FramesPerSecond;
+    double CpuMsPerFrame;
+    double MemoryKB;                    // 引擎自身统计的网格与 GL 对象占用（GetFrameStats() 的 MeshBytes + GLBytes）
+};
+
+// 以 GLStub 为后端无头运行一个引擎：预热后连续绘制至少 frames 帧、至少 seconds 秒，其间每 30 帧旋转一次以驱动动画。
+// 内存取自引擎的统计而非常驻内存之差：分配器会保留先前配置释放的页面，映射的网格在上传后也不再计入常驻内存，
+// 两者都会使差值失真；引擎的统计与运行次数和进程历史无关。
+static FrameBenchmarkResult RunFrameBenchmark(bool es1, const char* meshPath, int width, int height, int frames, double seconds)
+{
+    static const VCCDeviceOrientation Orientations[] = {
+        VCCDeviceOrientationLandscapeLeft, VCCDeviceOrientationPortraitUpsideDown,
+        VCCDeviceOrientationLandscapeRight, VCCDeviceOrientationPortrait,
+    };
+    const int WarmupFrames = 10;
+    streambuf* log = cout.rdbuf(0);
+    VCCRenderingEngine* engine = es1 ? CreateRenderer1() : CreateRenderer2();
+    engine->Initialize(width, height);
+    engine->LoadMesh(meshPath);
+
+    double wallStart = 0, cpuStart = 0;
+    int frame = -WarmupFrames;
+    for (; frame < frames || Now() - wallStart < seconds; ++frame) {
+        if (frame == 0) {
+            wallStart = Now();
+            cpuStart = ProcessCpuSeconds();
+        }
+        if (frame % 30 == 0)
+            engine->OnRotate(Orientations[(frame / 30 + WarmupFrames) % 4]);
+        engine->UpdateAnimation(1.0f / 60);
+        engine->Render();
+    }
+    FrameBenchmarkResult result;
+    double wall = Now() - wallStart;
+    result.FramesPerSecond = frame / max(wall, 1e-9);
+    result.CpuMsPerFrame = (ProcessCpuSeconds() - cpuStart) * 1000 / frame;
+    VCCFrameStats stats = engine->GetFrameStats();
+    result.MemoryKB = (stats.MeshBytes + stats.GLBytes) / 1024.0;
+    delete engine;
+    cout.rdbuf(log);
+    cout.clear();
+    return result;
+}
+
+// 各次运行的帧率、CPU 时间与内存分别取中位数。
+static FrameBenchmarkResult MedianFrameResult(vector<FrameBenchmarkResult> runs)
+{
+    size_t middle = runs.size() / 2;
+    FrameBenchmarkResult result;
+    sort(runs.begin(), runs.end(), [](const FrameBenchmarkResult& a, const FrameBenchmarkResult& b) { return a.FramesPerSecond < b.FramesPerSecond; });
+    result.FramesPerSecond = runs[middle].FramesPerSecond;
+    sort(runs.begin(), runs.end(), [](const FrameBenchmarkResult& a, const FrameBenchmarkResult& b) { return a.CpuMsPerFrame < b.CpuMsPerFrame; });
+    result.CpuMsPerFrame = runs[middle].CpuMsPerFrame;
+    sort(runs.begin(), runs.end(), [](const FrameBenchmarkResult& a, const FrameBenchmarkResult& b) { return a.MemoryKB < b.MemoryKB; });
+    result.MemoryKB = runs[middle].MemoryKB;
+    return result;
+}
+
+// 基准文件每行一项配置：配置名 帧率 每帧CPU毫秒 内存KB，以 # 开头的行为注释。
+static map<string, FrameBenchmarkResult> LoadFrameBaseline(const char* path)
+{
+    map<string, FrameBenchmarkResult> baseline;
+    ifstream file(path);
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        istringstream fields(line);
+        string key;
+        FrameBenchmarkResult result;
+        if (fields >> key >> result.FramesPerSecond >> result.CpuMsPerFrame >> result.MemoryKB)
+            baseline[key] = result;
+    }
+    return baseline;
+}
+
+// 在“引擎 x 物体数 x 细分度 x 分辨率”的矩阵上测量帧率、每帧 CPU 时间与内存，并与基准文件比较：
+// 每项配置运行 runs 次、每次至少 seconds 秒，取中位数；任何一项比基准差出 tolerance 以上即视为性能退化，以非零状态退出。
+// 帧时间与 CPU 时间另有 floorMs 的绝对容差，亚毫秒级的配置因而不会因计时抖动误报；内存另有 64 KB 的绝对容差。
+// 基准结果因机器而异，应在同一台基准测试机上以 --update-baseline 生成，不提交至仓库。
+// 目前唯一可用的后端是 GLStub，测得的是引擎自身的 CPU 开销，不含驱动与 GPU 的时间。
+static int BenchmarkFrames(int argc, char** argv)
+{
+    const char* baselinePath = "frames.baseline";
+    bool updateBaseline = false;
+    double tolerance = 0.25;
+    double floorMs = 0.05;
+    double seconds = 1;
+    int runs = 5;
+    int frames = 600;
+    for (int i = 0; i < argc; ++i) {
+        if (strcmp(argv[i], "--update-baseline") == 0)
+            updateBaseline = true;
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            seconds = max(0.0, atof(argv[++i]));
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            runs = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--floor-ms") == 0 && i + 1 < argc)
+            floorMs = max(0.0, atof(argv[++i]));
+    }
+
+    static const uint32_t ObjectCounts[] = { 1, 64, 1024 };
+    static const int SliceCounts[] = { 8, 40, 256 };
+    static const int Resolutions[][2] = { { 320, 480 }, { 750, 1334 }, { 1536, 2048 } };
+    map<string, FrameBenchmarkResult> baseline = LoadFrameBaseline(baselinePath);
+    map<string, FrameBenchmarkResult> results;
+    if (!updateBaseline && baseline.empty())
+        cout << "no baseline in " << baselinePath << ", run with --update-baseline to create one" << endl;
+
+    cout << setw(36) << left << "configuration" << right << setw(12) << "frames/s" << setw(12) << "CPU ms" << setw(12) << "memory KB" << endl;
+    int regressions = 0;
+    for (size_t o = 0; o < sizeof(ObjectCounts) / sizeof(ObjectCounts[0]); ++o) {
+        for (size_t s = 0; s < sizeof(SliceCounts) / sizeof(SliceCounts[0]); ++s) {
+            const char* meshPath = "frames.vccmesh";
+            streambuf* log = cout.rdbuf(0);
+            bool written = WriteFrameBenchmarkMesh(meshPath, ObjectCounts[o], SliceCounts[s]);
+            cout.rdbuf(log);
+            cout.clear();
+            if (!written) {
+                cout << "Unable to write " << meshPath << endl;
+                return 1;
+            }
+            for (int es1 = 0; es1 < 2; ++es1) {
+                for (size_t r = 0; r < sizeof(Resolutions) / sizeof(Resolutions[0]); ++r) {
+                    ostringstream key;
+                    key << (es1 ? "es1" : "es2") << "/objects=" << ObjectCounts[o] << "/slices=" << SliceCounts[s]
+                        << "/" << Resolutions[r][0] << "x" << Resolutions[r][1];
+                    // 取多次运行的中位数，单次运行受机器上其他负载的影响不会造成误报。
+                    vector<FrameBenchmarkResult> samples;
+                    for (int run = 0; run < runs; ++run)
+                        samples.push_back(RunFrameBenchmark(es1 != 0, meshPath, Resolutions[r][0], Resolutions[r][1], frames, seconds));
+                    FrameBenchmarkResult result = MedianFrameResult(samples);
+                    results[key.str()] = result;
+                    cout << setw(36) << left << key.str() << right << fixed << setw(12) << setprecision(1) << result.FramesPerSecond
+                         << setw(12) << setprecision(3) << result.CpuMsPerFrame << setw(12) << setprecision(0) << result.MemoryKB;
+
+                    map<string, FrameBenchmarkResult>::const_iterator base = baseline.find(key.str());
+                    if (updateBaseline || base == baseline.end()) {
+                        cout << (updateBaseline ? "" : "  (new)") << endl;
+                        continue;
+                    }
+                    const FrameBenchmarkResult& b = base->second;
+                    // 帧率换算为每帧毫秒后再比较，以便施加绝对容差。
+                    bool slower = 1000 / result.FramesPerSecond > 1000 / b.FramesPerSecond * (1 + tolerance) + floorMs
+                               || result.CpuMsPerFrame > b.CpuMsPerFrame * (1 + tolerance) + floorMs;
+                    bool larger = result.MemoryKB > b.MemoryKB * (1 + tolerance) + 64;
+                    if (slower || larger) {
+                        regressions++;
+                        cout << "  REGRESSED (baseline " << setprecision(1) << b.FramesPerSecond << " frames/s, "
+                             << setprecision(3) << b.CpuMsPerFrame << " ms, " << setprecision(0) << b.MemoryKB << " KB)";
+                    }
+                    cout << endl;
+                }
+            }
+            unlink(meshPath);
+        }
+    }
+
+    if (updateBaseline) {
+        ofstream file(baselinePath);
+        file << "# benchmark frames baseline: configuration frames/s CPU-ms-per-frame memory-KB" << endl;
+        for (map<string, FrameBenchmarkResult>::const_iterator i = results.begin(); i != results.end(); ++i)
+            file << i->first << " " << setprecision(6) << i->second.FramesPerSecond << " " << i->second.CpuMsPerFrame
+                 << " " << i->second.MemoryKB << endl;
+        if (!file) {
+            cout << "Unable to write " << baselinePath << endl;
+            return 1;
+        }
+        cout << "baseline written to " << baselinePath << endl;
+        return 0;
+    }
+    if (regressions) {
+        cout << regressions << " configuration(s) regressed beyond " << setprecision(0) << tolerance * 100 << "%" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+struct CameraBenchmarkResult {
+    double CpuMsPerFrame;
+    double GLCallsPerFrame;
+    double DrawCallsPerFrame;
+    double MemoryKB;
+};
+
+// 以 engines 个引擎（各自只有一个视口）或单个引擎的 cameras 个摄像机绘制 views 个视图，每个视图的分辨率相同。
+static CameraBenchmarkResult RunCameraBenchmark(bool es1, const char* meshPath, int columns, int rows, bool shared, int frames)
+{
+    const int Width = 1536, Height = 2048;
+    streambuf* log = cout.rdbuf(0);
+    long memoryBefore = CurrentResidentKB();
+    vector<VCCRenderingEngine*> engines;
+    for (int i = 0; i < (shared ? 1 : columns * rows); ++i) {
+        VCCRenderingEngine* engine = es1 ? CreateRenderer1() : CreateRenderer2();
+        if (shared)
+            engine->Initialize(Width, Height);
+        else
+            engine->Initialize(Width / columns, Height / rows);
+        engine->LoadMesh(meshPath);
+        engine->OnRotate(VCCDeviceOrientationLandscapeLeft);
+        engines.push_back(engine);
+    }
+    if (shared) {
+        vector<Camera> cameras;
+        TileCameras(columns, rows, 7, mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10), cameras);
+        engines[0]->SetCameras(&cameras[0], cameras.size());
+    }
+
+    double cpuStart = 0;
+    GLStubStats glStart = {};
+    for (int frame = -10; frame < frames; ++frame) {
+        if (frame == 0) {
+            cpuStart = ProcessCpuSeconds();
+            glStart = GLStubGetStats();
+        }
+        for (size_t i = 0; i < engines.size(); ++i) {
+            engines[i]->UpdateAnimation(1.0f / 60);
+            engines[i]->Render();
+        }
+    }
+    CameraBenchmarkResult result;
+    result.CpuMsPerFrame = (ProcessCpuSeconds() - cpuStart) * 1000 / frames;
+    result.GLCallsPerFrame = double(GLStubGetStats().Calls - glStart.Calls) / frames;
+    result.DrawCallsPerFrame = double(GLStubGetStats().DrawCalls - glStart.DrawCalls) / frames;
+    result.MemoryKB = (double) max(0L, CurrentResidentKB() - memoryBefore);
+    for (size_t i = 0; i < engines.size(); ++i)
+        delete engines[i];
+    cout.rdbuf(log);
+    cout.clear();
+    return result;
+}
+
+// 监控墙：同一场景的 views 个视图（按近似正方形的网格平铺），比较每个视图各用一个引擎与单个引擎以多个摄像机绘制时的
+// 每帧 CPU 时间、GL 调用数与内存。场景为 64 个椎体构成的网格，以 GLStub 为后端，不含驱动与 GPU 的时间。
+static int BenchmarkCameras(int argc, char** argv)
+{
+    int views = argc > 0 ? max(1, atoi(argv[0])) : 16;
+    int columns = (int) ceil(sqrt((double) views));
+    int rows = (views + columns - 1) / columns;
+    const int Frames = 300;
+    const char* meshPath = "cameras.vccmesh";
+    streambuf* log = cout.rdbuf(0);
+    bool written = WriteFrameBenchmarkMesh(meshPath, 64, 40);
+    cout.rdbuf(log);
+    cout.clear();
+    if (!written) {
+        cout << "Unable to write " << meshPath << endl;
+        return 1;
+    }
+    cout << columns * rows << " views (" << columns << " x " << rows << "), 64 objects" << endl;
+    cout << setw(28) << left << "configuration" << right << setw(12) << "CPU ms" << setw(12) << "GL calls"
+         << setw(12) << "draw calls" << setw(12) << "memory KB" << endl;
+    for (int es1 = 0; es1 < 2; ++es1) {
+        for (int shared = 0; shared < 2; ++shared) {
+            // 每种配置在独立的子进程中运行，常驻内存的增量因而不受之前配置释放的内存影响。
+            CameraBenchmarkResult result = {};
+            int fds[2];
+            if (pipe(fds) != 0)
+                return 1;
+            pid_t child = fork();
+            if (child == 0) {
+                result = RunCameraBenchmark(es1 != 0, meshPath, columns, rows, shared != 0, Frames);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == (ssize_t) sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            bool received = child > 0 && read(fds[0], &result, sizeof(result)) == (ssize_t) sizeof(result);
+            close(fds[0]);
+            if (child > 0)
+                waitpid(child, 0, 0);
+            if (!received) {
+                cout << "Benchmark process failed" << endl;
+                unlink(meshPath);
+                return 1;
+            }
+            string name = string(es1 ? "es1" : "es2") + (shared ? " one engine, cameras" : " one engine per view");
+            cout << setw(28) << left << name << right << fixed << setprecision(3) << setw(12) << result.CpuMsPerFrame
+                 << setprecision(1) << setw(12) << result.GLCallsPerFrame << setw(12) << result.DrawCallsPerFrame
+                 << setprecision(0) << setw(12) << result.MemoryKB << endl;
+        }
+    }
+    unlink(meshPath);
+    return 0;
+}
+
+struct BenchmarkEntry {
+    const char* Name;
+    const char* Usage;
+    int (*Run)(int argc, char** argv);
+};
+
+static const BenchmarkEntry Benchmarks[] = {
+    { "jobs", "jobs [maxThreads]", BenchmarkJobs },
+    { "tessellate", "tessellate [slices] [maxThreads]", BenchmarkTessellate },
+    { "vectormath", "vectormath [count]", BenchmarkVectorMath },
+    { "scalars", "scalars [count]", BenchmarkScalars },
+    { "transforms", "transforms [objects]", BenchmarkTransforms },
+    { "pick", "pick [instances] [rays]", BenchmarkPick },
+    { "check", "check", BenchmarkCheck },
+    { "mipmaps", "mipmaps [size] [maxThreads] [image.rgba width height]", BenchmarkMipmaps },
+    { "commands", "commands [producers]", BenchmarkCommands },
+    { "stream", "stream [instances] [points.vccpoints]", BenchmarkStream },
+    { "vertexstream", "vertexstream [objects]", BenchmarkVertexStream },
+    { "startup", "startup [runs] [--es1]", BenchmarkStartup },
+    { "cameras", "cameras [views]", BenchmarkCameras },
+    { "frames", "frames [--baseline file] [--update-baseline] [--tolerance 0.25] [--floor-ms 0.05] [--frames 600] [--seconds 1] [--runs 5]",
+      BenchmarkFrames },
+};
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2) {
+        for (size_t i = 0; i < sizeof(Benchmarks) / sizeof(Benchmarks[0]); ++i)
+            if (strcmp(argv[1], Benchmarks[i].Name) == 0)
+                return Benchmarks[i].Run(argc - 2, argv + 2);
+    }
+    cout << "usage:" << endl;
+    for (size_t i = 0; i < sizeof(Benchmarks) / sizeof(Benchmarks[0]); ++i)
+        cout << "  " << argv[0] << " " << Benchmarks[i].Usage << endl;
+    return 1;
+}
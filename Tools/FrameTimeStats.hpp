@@ -0,0 +1,67 @@
+//
+//  FrameTimeStats.hpp
+//  Tools
+//
+//  基准测试工具共用的帧时间统计。
+//
+
+#ifndef FrameTimeStats_hpp
+#define FrameTimeStats_hpp
+
+#include <stddef.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+struct FrameTimeSummary {
+    size_t Frames;
+    size_t OverBudget;          // 超出帧预算 5% 以上的帧数；容差用于吸收显示链接时间戳的舍入误差
+    double Total;
+    double Mean;
+    double StdDev;
+    double Min;
+    double P50;
+    double P90;
+    double P99;
+    double Max;
+};
+
+// times 与 budget 的单位均为秒；百分位数按最近秩法计算。
+inline FrameTimeSummary SummarizeFrameTimes(std::vector<double> times, double budget = 1.0 / 60)
+{
+    FrameTimeSummary s = FrameTimeSummary();
+    s.Frames = times.size();
+    if (times.empty())
+        return s;
+    std::sort(times.begin(), times.end());
+    for (size_t i = 0; i < times.size(); ++i) {
+        s.Total += times[i];
+        if (times[i] > budget * 1.05)
+            s.OverBudget++;
+    }
+    s.Mean = s.Total / times.size();
+    double variance = 0;
+    for (size_t i = 0; i < times.size(); ++i)
+        variance += (times[i] - s.Mean) * (times[i] - s.Mean);
+    s.StdDev = std::sqrt(variance / times.size());
+    s.Min = times.front();
+    s.Max = times.back();
+    s.P50 = times[std::min(times.size() - 1, (size_t) std::ceil(0.50 * times.size()) - 1)];
+    s.P90 = times[std::min(times.size() - 1, (size_t) std::ceil(0.90 * times.size()) - 1)];
+    s.P99 = times[std::min(times.size() - 1, (size_t) std::ceil(0.99 * times.size()) - 1)];
+    return s;
+}
+
+// 以毫秒为单位输出一行统计结果。
+inline void PrintFrameTimeSummary(const char* label, const FrameTimeSummary& s)
+{
+    std::cout << label << ": " << s.Frames << " frames" << std::fixed << std::setprecision(3)
+              << ", mean " << s.Mean * 1000 << " ms (sd " << s.StdDev * 1000 << ")"
+              << ", min " << s.Min * 1000 << ", p50 " << s.P50 * 1000 << ", p90 " << s.P90 * 1000
+              << ", p99 " << s.P99 * 1000 << ", max " << s.Max * 1000
+              << ", over budget " << s.OverBudget << std::endl;
+}
+
+#endif /* FrameTimeStats_hpp */
@@ -0,0 +1,186 @@
+//
+//  GLStub.cpp
+//  Tools
+//
+
+#include "GLStub.h"
+#include <string.h>
+#include <vector>
+
+static GLStubStats Stats;
+static GLuint NextName = 1;
+// 栅栏以插入的序号（从 1 开始）作为句柄。
+static uintptr_t InsertedFences = 0;
+static unsigned int FenceLatency = 2;
+// 映射返回的内存，其内容被丢弃。
+static std::vector<unsigned char> MappedStorage;
+
+const GLStubStats& GLStubGetStats()
+{
+    return Stats;
+}
+
+void GLStubResetStats()
+{
+    memset(&Stats, 0, sizeof(Stats));
+}
+
+void GLStubSetFenceLatency(unsigned int fences)
+{
+    FenceLatency = fences;
+}
+
+static void Call()
+{
+    Stats.Calls++;
+}
+
+static void StateCall()
+{
+    Stats.Calls++;
+    Stats.StateCalls++;
+}
+
+static void GenerateNames(GLsizei n, GLuint* names)
+{
+    Stats.Calls++;
+    for (GLsizei i = 0; i < n; ++i)
+        names[i] = NextName++;
+}
+
+static void Draw(GLsizei count)
+{
+    Stats.Calls++;
+    Stats.DrawCalls++;
+    Stats.Vertices += count;
+}
+
+void glBindTexture(GLenum, GLuint) { StateCall(); }
+void glClear(GLbitfield) { Call(); }
+void glClearColor(GLclampf, GLclampf, GLclampf, GLclampf) { StateCall(); }
+void glDeleteTextures(GLsizei, const GLuint*) { Call(); }
+void glDisable(GLenum) { StateCall(); }
+void glDrawArrays(GLenum, GLint, GLsizei count) { Draw(count); }
+void glDrawElements(GLenum, GLsizei count, GLenum, const GLvoid*) { Draw(count); }
+void glEnable(GLenum) { StateCall(); }
+void glGenTextures(GLsizei n, GLuint* textures) { GenerateNames(n, textures); }
+const GLubyte* glGetString(GLenum) { Call(); return (const GLubyte*) "GLStub"; }
+void glScissor(GLint, GLint, GLsizei, GLsizei) { StateCall(); }
+void glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) { Call(); }
+void glTexParameteri(GLenum, GLenum, GLint) { StateCall(); }
+void glViewport(GLint, GLint, GLsizei, GLsizei) { StateCall(); }
+
+void glColor4f(GLfloat, GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glColorPointer(GLint, GLenum, GLsizei, const GLvoid*) { StateCall(); }
+void glDisableClientState(GLenum) { StateCall(); }
+void glEnableClientState(GLenum) { StateCall(); }
+void glFrustumf(GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glLoadIdentity(void) { StateCall(); }
+void glLoadMatrixf(const GLfloat*) { StateCall(); }
+void glMatrixMode(GLenum) { StateCall(); }
+void glMultMatrixf(const GLfloat*) { StateCall(); }
+void glMultiTexCoord4f(GLenum, GLfloat, GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glOrthof(GLfloat, GLfloat, GLfloat, GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glPopMatrix(void) { StateCall(); }
+void glPushMatrix(void) { StateCall(); }
+void glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*) { StateCall(); }
+void glTranslatef(GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) { StateCall(); }
+
+void glBindFramebufferOES(GLenum, GLuint) { StateCall(); }
+void glBindRenderbufferOES(GLenum, GLuint) { StateCall(); }
+void glDeleteFramebuffersOES(GLsizei, const GLuint*) { Call(); }
+void glDeleteRenderbuffersOES(GLsizei, const GLuint*) { Call(); }
+void glFramebufferRenderbufferOES(GLenum, GLenum, GLenum, GLuint) { Call(); }
+void glGenFramebuffersOES(GLsizei n, GLuint* framebuffers) { GenerateNames(n, framebuffers); }
+void glGenRenderbuffersOES(GLsizei n, GLuint* renderbuffers) { GenerateNames(n, renderbuffers); }
+void glRenderbufferStorageOES(GLenum, GLenum, GLsizei, GLsizei) { Call(); }
+
+void glAttachShader(GLuint, GLuint) { Call(); }
+void glBindBuffer(GLenum, GLuint) { StateCall(); }
+void glBindFramebuffer(GLenum, GLuint) { StateCall(); }
+void glBindRenderbuffer(GLenum, GLuint) { StateCall(); }
+void glBufferData(GLenum, GLsizeiptr size, const GLvoid*, GLenum)
+{
+    Call();
+    Stats.BufferBytes += size;
+}
+GLenum glCheckFramebufferStatus(GLenum) { Call(); return GL_FRAMEBUFFER_COMPLETE; }
+void glCompileShader(GLuint) { Call(); }
+GLuint glCreateProgram(void) { Call(); return NextName++; }
+GLuint glCreateShader(GLenum) { Call(); return NextName++; }
+void glDeleteBuffers(GLsizei, const GLuint*) { Call(); }
+void glDeleteFramebuffers(GLsizei, const GLuint*) { Call(); }
+void glDeleteProgram(GLuint) { Call(); }
+void glDeleteRenderbuffers(GLsizei, const GLuint*) { Call(); }
+void glDeleteShader(GLuint) { Call(); }
+void glDetachShader(GLuint, GLuint) { Call(); }
+void glDisableVertexAttribArray(GLuint) { StateCall(); }
+void glEnableVertexAttribArray(GLuint) { StateCall(); }
+void glFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint) { Call(); }
+void glFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint, GLint) { Call(); }
+void glGenBuffers(GLsizei n, GLuint* buffers) { GenerateNames(n, buffers); }
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers) { GenerateNames(n, framebuffers); }
+void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers) { GenerateNames(n, renderbuffers); }
+
+// 属性与 uniform 的位置按名称的长度分配，不同名称得到的位置通常互不相同，足以满足引擎的需要。
+int glGetAttribLocation(GLuint, const GLchar* name) { Call(); return (int) (strlen(name) % 16); }
+int glGetUniformLocation(GLuint, const GLchar* name) { Call(); return (int) (strlen(name) % 64); }
+
+void glGetProgramInfoLog(GLuint, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    Call();
+    if (length)
+        *length = 0;
+    if (bufsize > 0)
+        infolog[0] = 0;
+}
+void glGetProgramiv(GLuint, GLenum, GLint* params) { Call(); *params = GL_TRUE; }
+void glGetShaderInfoLog(GLuint, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+    Call();
+    if (length)
+        *length = 0;
+    if (bufsize > 0)
+        infolog[0] = 0;
+}
+void glGetShaderiv(GLuint, GLenum, GLint* params) { Call(); *params = GL_TRUE; }
+void glLinkProgram(GLuint) { Call(); }
+void glRenderbufferStorage(GLenum, GLenum, GLsizei, GLsizei) { Call(); }
+void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { Call(); }
+void glUniform1i(GLint, GLint) { StateCall(); }
+void glUniform2f(GLint, GLfloat, GLfloat) { StateCall(); }
+void glUniform4fv(GLint, GLsizei, const GLfloat*) { StateCall(); }
+void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { StateCall(); }
+void glUseProgram(GLuint) { StateCall(); }
+void glVertexAttrib4f(GLuint, GLfloat, GLfloat, GLfloat, GLfloat) { StateCall(); }
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const GLvoid*) { StateCall(); }
+
+void glDiscardFramebufferEXT(GLenum, GLsizei, const GLenum*) { Call(); }
+
+void* glMapBufferRangeEXT(GLenum, GLintptr, GLsizeiptr length, GLbitfield)
+{
+    Call();
+    Stats.MappedBytes += length;
+    if (MappedStorage.size() < size_t(length))
+        MappedStorage.resize(length);
+    return &MappedStorage[0];
+}
+GLboolean glUnmapBufferOES(GLenum) { Call(); return GL_TRUE; }
+
+GLsync glFenceSyncAPPLE(GLenum, GLbitfield)
+{
+    Call();
+    return (GLsync) ++InsertedFences;
+}
+GLenum glClientWaitSyncAPPLE(GLsync sync, GLbitfield, GLuint64 timeout)
+{
+    Call();
+    if (InsertedFences - (uintptr_t) sync >= FenceLatency)
+        return GL_ALREADY_SIGNALED_APPLE;
+    if (timeout == 0)
+        return GL_TIMEOUT_EXPIRED_APPLE;
+    Stats.FenceWaits++;
+    return GL_CONDITION_SATISFIED_APPLE;
+}
+void glDeleteSyncAPPLE(GLsync) { Call(); }
@@ -0,0 +1,232 @@
+//
+//  GLStub.h
+//  Tools
+//
+//  不执行任何绘制操作的 OpenGL ES 1.1/2.0 桩实现，使渲染引擎的源文件能够在没有 GPU 的开发机上编译并运行。
+//  OpenGLES/ES1 与 OpenGLES/ES2 目录下的同名头文件均包含本文件，编译时以 -IGLStub 替代 iOS SDK 中的 OpenGLES 框架。
+//  这里只声明引擎实际用到的函数与常量，常量的取值与 Khronos 头文件一致；引擎用到新的 GL 函数时需同步补充。
+//
+/*
+ 桩函数仅更新调用计数：glGen* 与 glCreate* 返回递增的名称，状态查询一律返回成功，
+ 因此测得的时间只包含引擎自身在 CPU 上的开销，以及组织绘制命令的代价。
+ */
+
+#ifndef GLStub_h
+#define GLStub_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int GLenum;
+typedef unsigned int GLuint;
+typedef int GLint;
+typedef int GLsizei;
+typedef float GLfloat;
+typedef float GLclampf;
+typedef unsigned char GLboolean;
+typedef unsigned int GLbitfield;
+typedef unsigned char GLubyte;
+typedef char GLchar;
+typedef void GLvoid;
+typedef intptr_t GLintptr;
+typedef intptr_t GLsizeiptr;
+typedef uint64_t GLuint64;
+typedef struct __GLsync* GLsync;
+
+#define GL_FALSE                        0
+#define GL_TRUE                         1
+#define GL_NO_ERROR                     0
+
+#define GL_DEPTH_BUFFER_BIT             0x00000100
+#define GL_COLOR_BUFFER_BIT             0x00004000
+
+#define GL_TRIANGLES                    0x0004
+#define GL_TRIANGLE_STRIP               0x0005
+#define GL_TRIANGLE_FAN                 0x0006
+
+#define GL_DEPTH_TEST                   0x0B71
+#define GL_SCISSOR_TEST                 0x0C11
+#define GL_TEXTURE_2D                   0x0DE1
+
+#define GL_UNSIGNED_BYTE                0x1401
+#define GL_SHORT                        0x1402
+#define GL_UNSIGNED_SHORT               0x1403
+#define GL_UNSIGNED_INT                 0x1405
+#define GL_FLOAT                        0x1406
+
+#define GL_RENDERER                     0x1F01
+#define GL_VERSION                      0x1F02
+
+#define GL_MODELVIEW                    0x1700
+#define GL_PROJECTION                   0x1701
+#define GL_RGBA                         0x1908
+
+#define GL_LINEAR                       0x2601
+#define GL_LINEAR_MIPMAP_LINEAR         0x2703
+#define GL_TEXTURE_MAG_FILTER           0x2800
+#define GL_TEXTURE_MIN_FILTER           0x2801
+#define GL_TEXTURE_WRAP_S               0x2802
+#define GL_TEXTURE_WRAP_T               0x2803
+#define GL_CLAMP_TO_EDGE                0x812F
+
+#define GL_VERTEX_ARRAY                 0x8074
+#define GL_COLOR_ARRAY                  0x8076
+#define GL_TEXTURE_COORD_ARRAY          0x8078
+#define GL_TEXTURE0                     0x84C0
+
+#define GL_DEPTH_COMPONENT16            0x81A5
+#define GL_ARRAY_BUFFER                 0x8892
+#define GL_ELEMENT_ARRAY_BUFFER         0x8893
+#define GL_STATIC_DRAW                  0x88E4
+#define GL_STREAM_DRAW                  0x88E0
+
+#define GL_FRAGMENT_SHADER              0x8B30
+#define GL_VERTEX_SHADER                0x8B31
+#define GL_COMPILE_STATUS               0x8B81
+#define GL_LINK_STATUS                  0x8B82
+
+#define GL_FRAMEBUFFER_COMPLETE         0x8CD5
+#define GL_COLOR_ATTACHMENT0            0x8CE0
+#define GL_DEPTH_ATTACHMENT             0x8D00
+#define GL_FRAMEBUFFER                  0x8D40
+#define GL_RENDERBUFFER                 0x8D41
+
+#define GL_DEPTH_COMPONENT16_OES        GL_DEPTH_COMPONENT16
+#define GL_FRAMEBUFFER_COMPLETE_OES     GL_FRAMEBUFFER_COMPLETE
+#define GL_COLOR_ATTACHMENT0_OES        GL_COLOR_ATTACHMENT0
+#define GL_DEPTH_ATTACHMENT_OES         GL_DEPTH_ATTACHMENT
+#define GL_FRAMEBUFFER_OES              GL_FRAMEBUFFER
+#define GL_RENDERBUFFER_OES             GL_RENDERBUFFER
+
+#define GL_MAP_WRITE_BIT_EXT                    0x0002
+#define GL_MAP_INVALIDATE_RANGE_BIT_EXT         0x0004
+#define GL_MAP_UNSYNCHRONIZED_BIT_EXT           0x0020
+#define GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE     0x9117
+#define GL_ALREADY_SIGNALED_APPLE               0x911A
+#define GL_TIMEOUT_EXPIRED_APPLE                0x911B
+#define GL_CONDITION_SATISFIED_APPLE            0x911C
+#define GL_SYNC_FLUSH_COMMANDS_BIT_APPLE        0x00000001
+#define GL_TIMEOUT_IGNORED_APPLE                0xFFFFFFFFFFFFFFFFull
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// OpenGL ES 1.1 与 2.0 共有的函数
+void glBindTexture(GLenum target, GLuint texture);
+void glClear(GLbitfield mask);
+void glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
+void glDeleteTextures(GLsizei n, const GLuint* textures);
+void glDisable(GLenum cap);
+void glDrawArrays(GLenum mode, GLint first, GLsizei count);
+void glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+void glEnable(GLenum cap);
+void glGenTextures(GLsizei n, GLuint* textures);
+const GLubyte* glGetString(GLenum name);
+void glScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+                  GLenum format, GLenum type, const GLvoid* pixels);
+void glTexParameteri(GLenum target, GLenum pname, GLint param);
+void glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+// OpenGL ES 1.1
+void glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glDisableClientState(GLenum array);
+void glEnableClientState(GLenum array);
+void glFrustumf(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar);
+void glLoadIdentity(void);
+void glLoadMatrixf(const GLfloat* m);
+void glMatrixMode(GLenum mode);
+void glMultMatrixf(const GLfloat* m);
+void glMultiTexCoord4f(GLenum target, GLfloat s, GLfloat t, GLfloat r, GLfloat q);
+void glOrthof(GLfloat left, GLfloat right, GLfloat bottom, GLfloat top, GLfloat zNear, GLfloat zFar);
+void glPopMatrix(void);
+void glPushMatrix(void);
+void glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+void glTranslatef(GLfloat x, GLfloat y, GLfloat z);
+void glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid* pointer);
+
+// OES_framebuffer_object
+void glBindFramebufferOES(GLenum target, GLuint framebuffer);
+void glBindRenderbufferOES(GLenum target, GLuint renderbuffer);
+void glDeleteFramebuffersOES(GLsizei n, const GLuint* framebuffers);
+void glDeleteRenderbuffersOES(GLsizei n, const GLuint* renderbuffers);
+void glFramebufferRenderbufferOES(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void glGenFramebuffersOES(GLsizei n, GLuint* framebuffers);
+void glGenRenderbuffersOES(GLsizei n, GLuint* renderbuffers);
+void glRenderbufferStorageOES(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+
+// OpenGL ES 2.0
+void glAttachShader(GLuint program, GLuint shader);
+void glBindBuffer(GLenum target, GLuint buffer);
+void glBindFramebuffer(GLenum target, GLuint framebuffer);
+void glBindRenderbuffer(GLenum target, GLuint renderbuffer);
+void glBufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+GLenum glCheckFramebufferStatus(GLenum target);
+void glCompileShader(GLuint shader);
+GLuint glCreateProgram(void);
+GLuint glCreateShader(GLenum type);
+void glDeleteBuffers(GLsizei n, const GLuint* buffers);
+void glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+void glDeleteProgram(GLuint program);
+void glDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+void glDeleteShader(GLuint shader);
+void glDetachShader(GLuint program, GLuint shader);
+void glDisableVertexAttribArray(GLuint index);
+void glEnableVertexAttribArray(GLuint index);
+void glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer);
+void glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+void glGenBuffers(GLsizei n, GLuint* buffers);
+void glGenFramebuffers(GLsizei n, GLuint* framebuffers);
+void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+int glGetAttribLocation(GLuint program, const GLchar* name);
+void glGetProgramInfoLog(GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void glGetProgramiv(GLuint program, GLenum pname, GLint* params);
+void glGetShaderInfoLog(GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog);
+void glGetShaderiv(GLuint shader, GLenum pname, GLint* params);
+int glGetUniformLocation(GLuint program, const GLchar* name);
+void glLinkProgram(GLuint program);
+void glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
+void glShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+void glUniform1i(GLint location, GLint x);
+void glUniform2f(GLint location, GLfloat x, GLfloat y);
+void glUniform4fv(GLint location, GLsizei count, const GLfloat* v);
+void glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+void glUseProgram(GLuint program);
+void glVertexAttrib4f(GLuint index, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+void glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+// EXT_discard_framebuffer
+void glDiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum* attachments);
+
+// EXT_map_buffer_range、OES_mapbuffer
+void* glMapBufferRangeEXT(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+GLboolean glUnmapBufferOES(GLenum target);
+
+// APPLE_sync
+GLsync glFenceSyncAPPLE(GLenum condition, GLbitfield flags);
+GLenum glClientWaitSyncAPPLE(GLsync sync, GLbitfield flags, GLuint64 timeout);
+void glDeleteSyncAPPLE(GLsync sync);
+
+#ifdef __cplusplus
+}
+#endif
+
+// 桩实现累计的调用次数，供基准测试工具输出。
+struct GLStubStats {
+    uint64_t Calls;             // 全部 GL 函数的调用次数
+    uint64_t DrawCalls;         // glDrawArrays 与 glDrawElements 的调用次数
+    uint64_t Vertices;          // 绘制调用提交的顶点（或索引）总数
+    uint64_t StateCalls;        // 绑定、启用以及 uniform 等状态设置函数的调用次数
+    uint64_t BufferBytes;       // glBufferData 上传的字节数
+    uint64_t MappedBytes;       // glMapBufferRangeEXT 映射以供写入的字节数
+    uint64_t FenceWaits;        // glClientWaitSyncAPPLE 遇到尚未完成的栅栏的次数
+};
+
+const GLStubStats& GLStubGetStats();
+void GLStubResetStats();
+// 模拟 GPU 落后于 CPU 的程度：栅栏在其后又插入 fences 个栅栏时才视为完成（默认为 2，即 GPU 落后两帧）。
+void GLStubSetFenceLatency(unsigned int fences);
+
+#endif /* GLStub_h */
@@ -0,0 +1,8 @@
+//
+//  gl.h
+//  Tools
+//
+//  以 GLStub 替代 iOS SDK 中的 OpenGLES/ES2/gl.h，参见 GLStub.h。
+//
+
+#include "../../GLStub.h"
@@ -0,0 +1,137 @@
+//
+//  ObjToMesh.cpp
+//  Tools
+//
+//  离线转换工具：将 Wavefront OBJ 模型转换为 .vccmesh 网格文件。
+//  支持 "v x y z [r g b [a]]" 形式的顶点（可选的顶点颜色）以及任意边数的面（按三角扇拆分），其余指令均被忽略。
+//  顶点数不超过 65536 时使用 16 位索引，否则使用 32 位索引（ES 1.1 渲染器不支持后者）。
+//  指定 --quantize 时位置坐标以 16 位整数存储，并输出相对于浮点坐标的误差统计。
+//  编译方式：c++ -std=c++11 -O2 -I../opengles2 ObjToMesh.cpp ../opengles2/MeshFile.cpp -o objtomesh
+//  用法：objtomesh [--quantize] model.obj model.vccmesh
+//
+
+#include "MeshFile.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+using namespace std;
+
+// OBJ 索引从 1 开始，负数表示相对于当前顶点列表末尾的位置。
+static bool ResolveIndex(const char* token, size_t vertexCount, uint32_t* index)
+{
+    long value = strtol(token, 0, 10);
+    if (value < 0)
+        value += (long) vertexCount + 1;
+    if (value < 1 || (size_t) value > vertexCount)
+        return false;
+    *index = (uint32_t) (value - 1);
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const char* program = argv[0];
+    bool quantize = argc > 1 && strcmp(argv[1], "--quantize") == 0;
+    if (quantize) {
+        argc--;
+        argv++;
+    }
+    if (argc < 3) {
+        cout << "usage: " << program << " [--quantize] input.obj output.vccmesh" << endl;
+        return 1;
+    }
+    FILE* input = fopen(argv[1], "r");
+    if (!input) {
+        cout << "Unable to open " << argv[1] << endl;
+        return 1;
+    }
+
+    vector<Vertex> vertices;
+    vector<uint32_t> indices;
+    char line[1024];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), input)) {
+        lineNumber++;
+        if (line[0] == 'v' && line[1] == ' ') {
+            Vertex vertex;
+            vertex.Color = vec4(1, 1, 1, 1);
+            vertex.TexCoord = vec2(0, 0);
+            int count = sscanf(line + 2, "%f %f %f %f %f %f %f",
+                               &vertex.Position.x, &vertex.Position.y, &vertex.Position.z,
+                               &vertex.Color.x, &vertex.Color.y, &vertex.Color.z, &vertex.Color.w);
+            if (count < 3) {
+                cout << argv[1] << ":" << lineNumber << ": malformed vertex" << endl;
+                fclose(input);
+                return 1;
+            }
+            vertices.push_back(vertex);
+        } else if (line[0] == 'f' && line[1] == ' ') {
+            vector<uint32_t> face;
+            for (char* token = strtok(line + 2, " \t\r\n"); token; token = strtok(0, " \t\r\n")) {
+                uint32_t index;
+                if (!ResolveIndex(token, vertices.size(), &index)) {
+                    cout << argv[1] << ":" << lineNumber << ": invalid face index" << endl;
+                    fclose(input);
+                    return 1;
+                }
+                face.push_back(index);
+            }
+            for (size_t i = 2; i < face.size(); ++i) {
+                indices.push_back(face[0]);
+                indices.push_back(face[i - 1]);
+                indices.push_back(face[i]);
+            }
+        }
+    }
+    fclose(input);
+
+    if (vertices.empty() || indices.empty()) {
+        cout << argv[1] << " contains no triangles" << endl;
+        return 1;
+    }
+
+    vector<uint16_t> shortIndices;
+    MeshFileSource source = {};
+    if (vertices.size() <= 65536) {
+        shortIndices.assign(indices.begin(), indices.end());
+        source.Indices = &shortIndices[0];
+        source.IndexSize = 2;
+    } else {
+        source.Indices = &indices[0];
+        source.IndexSize = 4;
+    }
+    source.IndexCount = (uint32_t) indices.size();
+
+    MeshFileSubmesh submesh = { MeshTopologyTriangles, 0, (uint32_t) indices.size(), 0 };
+    source.VertexCount = (uint32_t) vertices.size();
+    source.Submeshes = &submesh;
+    source.SubmeshCount = 1;
+    ComputeBounds(&vertices[0], vertices.size(), source.BoundsMin, source.BoundsMax);
+
+    vector<QuantizedVertex> quantized;
+    PositionQuantization quantization;
+    if (quantize) {
+        quantization = ComputePositionQuantization(source.BoundsMin, source.BoundsMax);
+        quantized.resize(vertices.size());
+        QuantizePositions(&vertices[0], vertices.size(), quantization, &quantized[0]);
+        QuantizationErrorReport report = MeasureQuantizationError(&vertices[0], &quantized[0], vertices.size(), quantization);
+        cout << "Quantization error: max " << report.MaxError << ", rms " << report.RmsError << endl;
+        source.Vertices = &quantized[0];
+        source.VertexStride = sizeof(QuantizedVertex);
+        source.Attributes = QuantizedVertexLayout(&source.AttributeCount);
+        source.Quantization = &quantization;
+    } else {
+        source.Vertices = &vertices[0];
+        source.VertexStride = sizeof(Vertex);
+        source.Attributes = VertexLayout(&source.AttributeCount);
+    }
+
+    if (!WriteMeshFile(argv[2], source))
+        return 1;
+    cout << "Wrote " << vertices.size() << " vertices and " << indices.size() / 3
+         << " triangles to " << argv[2] << endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+//
+//  ReplayTrace.cpp
+//  Tools
+//
+//  以录制的输入序列（.vcctrace，参见 InputTrace.hpp）无头驱动渲染引擎，并统计每帧的 CPU 耗时。
+//  引擎源文件与 GLStub 一同编译，因此无需 GPU 或 iOS 设备：
+//  编译方式：c++ -std=c++11 -O2 -IGLStub -I../opengles2 ReplayTrace.cpp GLStub/GLStub.cpp ../opengles2/*.cpp -o replaytrace -pthread
+//  用法：replaytrace input.vcctrace [--es1] [--mesh Scene.vccmesh] [--repeat N] [--timeline timeline.json]
+//  --mesh 在初始化后载入网格；录制的序列中含有载入网格事件时，改为以该文件替代各事件中设备上的路径。
+//  --timeline 将引擎的时间线导出为 Chrome 跟踪格式（参见 Tracing.hpp），需在编译时加上 -DVCC_ENABLE_TRACING=1。
+//
+
+#include "InputTrace.hpp"
+#include "FrameTimeStats.hpp"
+#include "GLStub.h"
+#include "Tracing.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+static double Now()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main(int argc, char** argv)
+{
+    const char* program = argv[0];
+    const char* tracePath = 0;
+    const char* meshPath = 0;
+    const char* timelinePath = 0;
+    bool es1 = false;
+    int repeat = 1;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--es1") == 0)
+            es1 = true;
+        else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+            meshPath = argv[++i];
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc)
+            timelinePath = argv[++i];
+        else if (!tracePath && argv[i][0] != '-')
+            tracePath = argv[i];
+        else
+            usage = true;
+    }
+    if (usage || !tracePath) {
+        cout << "usage: " << program << " input.vcctrace [--es1] [--mesh Scene.vccmesh] [--repeat N] [--timeline timeline.json]" << endl;
+        return 1;
+    }
+    if (timelinePath && !VCC_ENABLE_TRACING) {
+        cout << "--timeline requires building with -DVCC_ENABLE_TRACING=1" << endl;
+        return 1;
+    }
+    VCC_TRACE_THREAD_NAME("Replay");
+
+    InputTrace trace;
+    if (!LoadInputTrace(tracePath, trace))
+        return 1;
+
+    bool tracedMesh = false;
+    for (size_t i = 0; i < trace.Events.size(); ++i) {
+        if (trace.Events[i].Type == InputEventLoadMesh) {
+            tracedMesh = true;
+            if (meshPath)
+                trace.Events[i].Path = meshPath;
+        }
+    }
+
+    VCCRenderingEngine* engine = es1 ? CreateRenderer1() : CreateRenderer2();
+    double start = Now();
+    engine->Initialize(trace.Width, trace.Height);
+    if (meshPath && !tracedMesh && !engine->LoadMesh(meshPath)) {
+        delete engine;
+        return 1;
+    }
+    double initializeTime = Now() - start;
+
+    // 帧时间自上一次 Render() 返回起，至本次 Render() 返回为止，包括其间的 UpdateAnimation() 与 OnRotate()。
+    vector<double> frameTimes, recordedIntervals;
+    GLStubResetStats();
+    start = Now();
+    for (int pass = 0; pass < repeat; ++pass) {
+        double frameStart = Now();
+        for (size_t i = 0; i < trace.Events.size(); ++i) {
+            const InputEvent& event = trace.Events[i];
+            ApplyInputEvent(engine, event);
+            if (event.Type == InputEventRender) {
+                double now = Now();
+                frameTimes.push_back(now - frameStart);
+                frameStart = now;
+            } else if (event.Type == InputEventUpdate && pass == 0) {
+                recordedIntervals.push_back(event.TimeStep);
+            }
+        }
+    }
+    double replayTime = Now() - start;
+    VCCFrameStats engineStats = engine->GetFrameStats();
+    delete engine;
+
+    cout << tracePath << ": " << trace.Width << "x" << trace.Height << ", " << trace.Events.size() << " events, "
+         << (es1 ? "ES 1.1" : "ES 2.0") << " engine, " << repeat << " pass(es)" << endl;
+    cout << fixed << setprecision(3) << "initialize " << initializeTime * 1000 << " ms, replay " << replayTime * 1000
+         << " ms (" << setprecision(1) << frameTimes.size() / max(replayTime, 1e-9) << " frames/s)" << endl;
+    engineStats.Initialization.Print(cout, es1 ? "ES 1.1 initialization" : "ES 2.0 initialization");
+    PrintFrameTimeSummary("replayed CPU frame time", SummarizeFrameTimes(frameTimes));
+    PrintFrameTimeSummary("recorded display interval", SummarizeFrameTimes(recordedIntervals));
+
+    const GLStubStats& gl = GLStubGetStats();
+    double frames = max<size_t>(1, frameTimes.size());
+    cout << setprecision(1) << "per frame: " << gl.Calls / frames << " GL calls, " << gl.DrawCalls / frames << " draw calls, "
+         << gl.StateCalls / frames << " state calls, " << gl.Vertices / frames << " vertices" << endl;
+    // 引擎自身的统计按逻辑上的状态切换计数，绘制调用与顶点数应与 GLStub 的计数一致。
+    const VCCRenderCounters& total = engineStats.Total;
+    double engineFrames = max<uint64_t>(1, engineStats.Frames);
+    cout << "engine stats per frame: " << total.Vertices / engineFrames << " vertices, " << total.Primitives / engineFrames
+         << " primitives, " << total.DrawCalls / engineFrames << " draw calls, " << total.StateChanges / engineFrames
+         << " state changes (" << total.StateChangesSaved / engineFrames << " saved by sorting), "
+         << total.UniformBytes / engineFrames << " uniform bytes, " << total.BufferBytes / engineFrames << " buffer bytes;"
+         << " meshes " << engineStats.MeshBytes / 1024 << " KB, GL objects " << engineStats.GLBytes / 1024 << " KB" << endl;
+    cout << "culling per frame: " << total.Occluded / engineFrames << " of " << total.OcclusionTested / engineFrames
+         << " objects occluded, " << total.LodVerticesSaved / engineFrames << " vertices saved by LOD ("
+         << total.LodSwitches << " level switches)" << endl;
+    const VertexStreamStats& stream = engineStats.Stream;
+    if (stream.Frames > 0)
+        cout << "vertex stream: " << stream.BytesStreamed / 1024 << " KB in " << stream.Allocations << " allocations, "
+             << stream.StallsAvoided << " stalls avoided, " << stream.Stalls << " stalls, " << stream.Orphans << " orphans ("
+             << stream.Overflows << " overflows)" << endl;
+    const StreamingStats& scene = engineStats.Scene;
+    if (scene.Passes > 0)
+        cout << "streaming scene: " << scene.SceneInstances << " instances through a " << scene.PoolBytes / 1024
+             << " KB buffer pool, " << scene.Chunks << " chunks in " << scene.Passes << " passes, "
+             << scene.ProducerStalls << " producer stalls, " << scene.ConsumerStalls << " consumer stalls" << endl;
+    if (timelinePath && !Tracing::WriteChromeTrace(timelinePath))
+        return 1;
+    return 0;
+}
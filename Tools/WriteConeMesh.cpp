@@ -0,0 +1,54 @@
+//
+//  WriteConeMesh.cpp
+//  Tools
+//
+//  将渲染引擎程序化生成的椎体与底盘写入 .vccmesh 网格文件。
+//  编译方式：c++ -std=c++11 -O2 -I../opengles2 WriteConeMesh.cpp ../opengles2/MeshFile.cpp -o writeconemesh
+//  用法：writeconemesh Scene.vccmesh [slices]
+//
+
+#include "MeshFile.hpp"
+
+#include <stdlib.h>
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        cout << "usage: " << argv[0] << " output.vccmesh [slices]" << endl;
+        return 1;
+    }
+    int slices = argc > 2 ? atoi(argv[2]) : ConeSlices;
+    if (slices < 3) {
+        cout << "slices must be at least 3" << endl;
+        return 1;
+    }
+
+    // 椎体与底盘共享同一个顶点块，并以两个绘制区间区分各自的拓扑关系。
+    vector<Vertex> cone, disk;
+    GenerateCone(cone, ConeRadius, ConeHeight, slices);
+    GenerateDisk(disk, ConeRadius, ConeHeight, slices);
+    vector<Vertex> vertices(cone);
+    vertices.insert(vertices.end(), disk.begin(), disk.end());
+
+    MeshFileSubmesh submeshes[] = {
+        { MeshTopologyTriangleStrip, 0, (uint32_t) cone.size(), 0 },
+        { MeshTopologyTriangleFan, (uint32_t) cone.size(), (uint32_t) disk.size(), 0 },
+    };
+
+    MeshFileSource source = {};
+    source.Vertices = &vertices[0];
+    source.VertexStride = sizeof(Vertex);
+    source.VertexCount = (uint32_t) vertices.size();
+    source.Attributes = VertexLayout(&source.AttributeCount);
+    source.Submeshes = submeshes;
+    source.SubmeshCount = sizeof(submeshes) / sizeof(submeshes[0]);
+    ComputeBounds(&vertices[0], vertices.size(), source.BoundsMin, source.BoundsMax);
+
+    if (!WriteMeshFile(argv[1], source))
+        return 1;
+    cout << "Wrote " << vertices.size() << " vertices to " << argv[1] << endl;
+    return 0;
+}
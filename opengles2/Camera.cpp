@@ -0,0 +1,108 @@
+//
+//  Camera.cpp
+//  opengles2
+//
+
+#include "Camera.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+CameraViewport ViewportInTarget(const Camera& camera, int targetWidth, int targetHeight)
+{
+    // 相邻视口的边界取整到同一像素，平铺时既无缝隙也不重叠。
+    CameraViewport viewport;
+    viewport.X = int(camera.ViewportX * targetWidth + 0.5f);
+    viewport.Y = int(camera.ViewportY * targetHeight + 0.5f);
+    viewport.Width = std::max(1, int((camera.ViewportX + camera.ViewportWidth) * targetWidth + 0.5f) - viewport.X);
+    viewport.Height = std::max(1, int((camera.ViewportY + camera.ViewportHeight) * targetHeight + 0.5f) - viewport.Y);
+    return viewport;
+}
+
+int CameraAtPoint(const std::vector<Camera>& cameras, int targetWidth, int targetHeight, float x, float y, CameraViewport& viewport)
+{
+    float flippedY = targetHeight - y;
+    for (size_t i = cameras.size(); i-- > 0;) {
+        if (cameras[i].Framebuffer)
+            continue;
+        CameraViewport v = ViewportInTarget(cameras[i], targetWidth, targetHeight);
+        if (x >= v.X && x < v.X + v.Width && flippedY > v.Y && flippedY <= v.Y + v.Height) {
+            viewport = v;
+            return (int) i;
+        }
+    }
+    return -1;
+}
+
+void TileCameras(int columns, int rows, float distance, const mat4& projection, std::vector<Camera>& cameras)
+{
+    cameras.clear();
+    int count = columns * rows;
+    for (int i = 0; i < count; ++i) {
+        Camera camera;
+        // 第一行位于视口顶部。
+        camera.ViewportWidth = 1.0f / columns;
+        camera.ViewportHeight = 1.0f / rows;
+        camera.ViewportX = (i % columns) * camera.ViewportWidth;
+        camera.ViewportY = (rows - 1 - i / columns) * camera.ViewportHeight;
+        camera.View = mat4::Translate(0, 0, distance) * mat4::Rotate(360.0f * i / count, vec3(0, 1, 0))
+                    * mat4::Translate(0, 0, -distance);
+        camera.Projection = projection;
+        camera.Framebuffer = 0;
+        camera.TargetWidth = camera.TargetHeight = 0;
+        cameras.push_back(camera);
+    }
+}
+
+// 行向量约定下，v * M 的第 i 个分量为 v 与 M 第 i 列的点积。
+static vec4 Column(const mat4& m, int i)
+{
+    const float* p = m.Pointer();
+    return vec4(p[i], p[4 + i], p[8 + i], p[12 + i]);
+}
+
+static float RowLength(const vec4& row)
+{
+    return std::sqrt(row.x * row.x + row.y * row.y + row.z * row.z);
+}
+
+// 包围球的半径按 Modelview 线性部分各行的最大长度放大；缩放先于旋转（如反量化矩阵之后的刚体变换）时恰为最大的伸缩比例。
+void TransformBoundingSphere(const vec3& boundsMin, const vec3& boundsMax, const mat4& modelview, vec3& center, float& radius)
+{
+    const mat4& m = modelview;
+    vec3 c = (boundsMin + boundsMax) * 0.5f;
+    vec3 extent = (boundsMax - boundsMin) * 0.5f;
+    center = vec3(c.x * m.x.x + c.y * m.y.x + c.z * m.z.x + m.w.x,
+                  c.x * m.x.y + c.y * m.y.y + c.z * m.z.y + m.w.y,
+                  c.x * m.x.z + c.y * m.y.z + c.z * m.z.z + m.w.z);
+    float scale = std::max(RowLength(m.x), std::max(RowLength(m.y), RowLength(m.z)));
+    radius = std::sqrt(extent.Dot(extent)) * scale;
+}
+
+CameraFrustum::CameraFrustum(const mat4& viewProjection)
+{
+    // 裁剪坐标满足 -w <= x, y, z <= w，每个不等式即一个平面（Gribb 与 Hartmann 的方法）。
+    vec4 x = Column(viewProjection, 0), y = Column(viewProjection, 1);
+    vec4 z = Column(viewProjection, 2), w = Column(viewProjection, 3);
+    m_planes[0] = w + x;
+    m_planes[1] = w - x;
+    m_planes[2] = w + y;
+    m_planes[3] = w - y;
+    m_planes[4] = w + z;
+    m_planes[5] = w - z;
+    for (int i = 0; i < 6; ++i) {
+        float length = RowLength(m_planes[i]);
+        if (length > 0)
+            m_planes[i] = m_planes[i] * (1 / length);
+    }
+}
+
+bool CameraFrustum::Intersects(const vec3& center, float radius) const
+{
+    for (int i = 0; i < 6; ++i) {
+        const vec4& p = m_planes[i];
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius)
+            return false;
+    }
+    return true;
+}
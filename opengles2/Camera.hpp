@@ -0,0 +1,59 @@
+//
+//  Camera.hpp
+//  opengles2
+//
+//  以多个摄像机渲染同一场景：分屏、画中画小地图或监控墙上的多个预览视图。
+//
+/*
+ 每个摄像机由渲染目标中的视口、观察矩阵与投影矩阵组成。观察矩阵作用于物体的 Modelview 之后（行向量约定下即 v * Modelview * View），
+ 单位矩阵即 Initialize() 中唯一的默认视图；引擎把 View * Projection 作为该摄像机的投影矩阵上传，顶点着色器因而无需修改。
+ 网格、缓冲区、动画、LOD 选择与渲染队列的排序在所有摄像机之间共享，每个摄像机只设置渲染目标、视口与投影并提交绘制命令。
+ 可见性同样只计算一次：各绘制命令的包围球每帧只变换一次，每个摄像机再以 CameraFrustum 的 6 个平面测试这些包围球，
+ 视锥之外的绘制命令不会提交。
+ */
+
+#ifndef Camera_hpp
+#define Camera_hpp
+
+#include "Matrix.hpp"
+#include <vector>
+
+struct Camera {
+    // 视口在渲染目标中所占的比例，原点位于左下角（与 glViewport 一致）。
+    float ViewportX, ViewportY, ViewportWidth, ViewportHeight;
+    mat4 View;
+    mat4 Projection;                    // 须由 mat4::Frustum 构造，拾取依赖于此
+    // 0 表示引擎自身的渲染目标；否则为调用者创建的帧缓冲区对象（须带有深度附着），TargetWidth、TargetHeight 为其尺寸。
+    unsigned int Framebuffer;
+    int TargetWidth, TargetHeight;
+};
+
+// 视口在渲染目标中的像素矩形。
+struct CameraViewport {
+    int X, Y, Width, Height;
+};
+
+CameraViewport ViewportInTarget(const Camera& camera, int targetWidth, int targetHeight);
+
+// 在渲染至引擎自身渲染目标的摄像机中找出视口包含屏幕坐标 (x, y)（原点位于左上角）的最后一个，即最上层的视口；
+// 返回其下标并写入其视口，没有时返回 -1。
+int CameraAtPoint(const std::vector<Camera>& cameras, int targetWidth, int targetHeight, float x, float y, CameraViewport& viewport);
+
+// 以 columns × rows 的网格平铺引擎的渲染目标，第 i 个摄像机绕位于 (0, 0, -distance) 的场景中心旋转 i * 360° / (columns * rows) 观察，
+// 例如监控墙上同一场景的多个视角。
+void TileCameras(int columns, int rows, float distance, const mat4& projection, std::vector<Camera>& cameras);
+
+// 由 Modelview 变换后的包围盒求保守的包围球：中心为变换后的包围盒中心，半径按 Modelview 的最大缩放放大。
+void TransformBoundingSphere(const vec3& boundsMin, const vec3& boundsMax, const mat4& modelview, vec3& center, float& radius);
+
+// 从 View * Projection 中提取的视锥，用于包围球的可见性测试。
+class CameraFrustum {
+public:
+    explicit CameraFrustum(const mat4& viewProjection);
+    // 包围球与视锥相交（或位于其中）时返回 true；测试是保守的，视锥角落附近的包围球可能被误判为可见。
+    bool Intersects(const vec3& center, float radius) const;
+private:
+    vec4 m_planes[6];                   // 法向量指向视锥内部并已归一化
+};
+
+#endif /* Camera_hpp */
@@ -0,0 +1,108 @@
+//
+//  DynamicResolution.cpp
+//  opengles2
+//
+
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+const float DynamicResolutionController::Step = 0.05f;
+const float DynamicResolutionController::OutlierFactor = 4;
+
+// 滑动平均的权重；值越大对帧时间变化的响应越快。
+static const float SmoothingFactor = 0.1f;
+// 帧时间超出目标值该比例时视为超标，低于目标值该比例时视为达标。
+static const float OverBudget = 1.1f;
+static const float WithinBudget = 1.02f;
+// 单次调整最多降低的级数；受垂直同步影响，帧时间往往成倍跳变，据此估算的比例通常偏低。
+static const int MaxStepsDown = 4;
+
+DynamicResolutionController::DynamicResolutionController(float targetFrameTime, float minScale, float maxScale)
+    : m_targetFrameTime(targetFrameTime), m_minScale(minScale), m_maxScale(maxScale)
+{
+    Reset();
+}
+
+void DynamicResolutionController::Reset()
+{
+    m_scale = m_maxScale;
+    m_smoothedFrameTime = 0;
+    m_cooldown = 0;
+    m_stableFrames = 0;
+    m_probeFrames = ProbeFrames;
+    m_probing = false;
+    m_failedScale = m_maxScale + Step;
+}
+
+float DynamicResolutionController::Quantize(float scale) const
+{
+    scale = std::floor(scale / Step + 0.5f) * Step;
+    return std::max(m_minScale, std::min(m_maxScale, scale));
+}
+
+bool DynamicResolutionController::Update(float frameTime)
+{
+    if (frameTime <= 0 || frameTime > m_targetFrameTime * OutlierFactor)
+        return false;
+
+    if (m_smoothedFrameTime == 0)
+        m_smoothedFrameTime = frameTime;
+    else
+        m_smoothedFrameTime += (frameTime - m_smoothedFrameTime) * SmoothingFactor;
+
+    if (m_cooldown > 0) {
+        m_cooldown--;
+        return false;
+    }
+
+    if (m_smoothedFrameTime > m_targetFrameTime * OverBudget) {
+        // 刚提高的比例无法维持，下一次尝试该比例前等待更久。
+        if (m_probing) {
+            m_failedScale = m_scale;
+            m_probeFrames *= 2;
+        }
+        m_probing = false;
+        m_stableFrames = 0;
+
+        // 像素数与比例的平方成正比，按帧时间的超出程度估算所需的比例，且至少降低一级。
+        float scale = m_scale * std::sqrt(m_targetFrameTime / m_smoothedFrameTime);
+        scale = std::max(scale, m_scale - MaxStepsDown * Step);
+        scale = Quantize(std::min(scale, m_scale - Step));
+        if (scale == m_scale)
+            return false;
+        m_scale = scale;
+        m_cooldown = SettleFrames;
+        m_smoothedFrameTime = m_targetFrameTime;
+        return true;
+    }
+
+    if (m_smoothedFrameTime > m_targetFrameTime * WithinBudget) {
+        m_stableFrames = 0;
+        return false;
+    }
+
+    m_stableFrames++;
+    if (m_probing) {
+        // 提高比例后又经过一个完整的等待期仍然达标，说明此次尝试是成功的。
+        if (m_stableFrames >= SettleFrames) {
+            m_probing = false;
+            m_stableFrames = 0;
+            if (m_scale >= m_failedScale - Step / 2) {
+                m_failedScale = m_maxScale + Step;
+                m_probeFrames = ProbeFrames;
+            }
+        }
+    } else if (m_scale < m_maxScale) {
+        // 只有再次尝试曾经失败的比例时，才需要等待加长后的帧数。
+        bool retryingFailure = m_scale + Step >= m_failedScale - Step / 2;
+        if (m_stableFrames < (retryingFailure ? m_probeFrames : ProbeFrames))
+            return false;
+        m_scale = Quantize(m_scale + Step);
+        m_stableFrames = 0;
+        m_cooldown = SettleFrames;
+        m_probing = true;
+        return true;
+    }
+    return false;
+}
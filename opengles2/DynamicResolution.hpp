@@ -0,0 +1,46 @@
+//
+//  DynamicResolution.hpp
+//  opengles2
+//
+//  动态分辨率控制器：根据测得的帧时间调整场景的渲染分辨率。
+//
+/*
+ 控制器不依赖 OpenGL，仅依据输入的帧时间序列给出缩放比例，因而可以直接以合成的帧时间驱动。
+ 帧时间通常来自显示链接的时间间隔，受垂直同步限制而无法低于目标值，因此控制器采用如下策略：
+   帧时间的指数滑动平均超出目标值时，按填充率与像素数成正比的假设立即降低比例；
+   帧时间连续 ProbeFrames 帧达标后，尝试提高一级比例；若提高后随即再次超标，则加倍再次尝试该比例前的等待帧数。
+ 比例以 Step 为单位量化，每次调整后等待 SettleFrames 帧，使滑动平均反映新比例下的帧时间。
+ 超过目标值 OutlierFactor 倍的帧（例如应用被挂起）被视为异常值而忽略。
+ */
+
+#ifndef DynamicResolution_hpp
+#define DynamicResolution_hpp
+
+class DynamicResolutionController {
+public:
+    static const int SettleFrames = 15;
+    static const int ProbeFrames = 120;
+    static const float Step;
+    static const float OutlierFactor;
+
+    DynamicResolutionController(float targetFrameTime = 1.0f / 60, float minScale = 0.5f, float maxScale = 1.0f);
+    // 提交一帧的耗时（秒），缩放比例发生变化时返回 true。
+    bool Update(float frameTime);
+    float Scale() const { return m_scale; }
+    float SmoothedFrameTime() const { return m_smoothedFrameTime; }
+    void Reset();
+private:
+    float Quantize(float scale) const;
+    float m_targetFrameTime;
+    float m_minScale;
+    float m_maxScale;
+    float m_scale;
+    float m_smoothedFrameTime;
+    int m_cooldown;
+    int m_stableFrames;
+    int m_probeFrames;
+    bool m_probing;
+    float m_failedScale;        // 最近一次尝试失败的比例
+};
+
+#endif /* DynamicResolution_hpp */
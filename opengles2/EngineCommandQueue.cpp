@@ -0,0 +1,128 @@
+//
+//  EngineCommandQueue.cpp
+//  opengles2
+//
+
+#include "EngineCommandQueue.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <iostream>
+
+EngineCommandQueue::EngineCommandQueue(size_t capacity)
+    : m_enqueuePosition(0), m_dequeuePosition(0), m_posted(0), m_dropped(0), m_applied(0)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size *= 2;
+    m_mask = size - 1;
+    m_cells = new Cell[size];
+    // 序号等于位置表示该槽位空闲，可供该位置的生产者写入；等于位置 + 1 表示命令已写入，可供消费者读取。
+    for (size_t i = 0; i < size; ++i)
+        m_cells[i].Sequence.store(i, std::memory_order_relaxed);
+}
+
+EngineCommandQueue::~EngineCommandQueue()
+{
+    delete[] m_cells;
+}
+
+bool EngineCommandQueue::Post(const EngineCommand& command)
+{
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &m_cells[position & m_mask];
+        size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+        intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+        if (difference == 0) {
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        } else if (difference < 0) {
+            // 该槽位上一轮的命令尚未被取出，即队列已满。
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+    cell->Command = command;
+    cell->Sequence.store(position + 1, std::memory_order_release);
+    m_posted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool EngineCommandQueue::PostRotate(VCCDeviceOrientation orientation)
+{
+    EngineCommand command;
+    command.Type = EngineCommandRotate;
+    command.Orientation = orientation;
+    return Post(command);
+}
+
+bool EngineCommandQueue::PostResize(int width, int height)
+{
+    EngineCommand command;
+    command.Type = EngineCommandResize;
+    command.Width = width;
+    command.Height = height;
+    return Post(command);
+}
+
+bool EngineCommandQueue::PostLoadMesh(const char* path)
+{
+    size_t length = strlen(path);
+    if (length >= EngineCommandPathCapacity) {
+        std::cout << "Mesh path is longer than " << EngineCommandPathCapacity - 1 << " bytes: " << path << std::endl;
+        return false;
+    }
+    EngineCommand command;
+    command.Type = EngineCommandLoadMesh;
+    memcpy(command.Path, path, length + 1);
+    return Post(command);
+}
+
+bool EngineCommandQueue::Pop(EngineCommand& command)
+{
+    Cell& cell = m_cells[m_dequeuePosition & m_mask];
+    if (cell.Sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1)
+        return false;
+    command = cell.Command;
+    // 释放槽位，供下一轮（位置加上容量）的生产者写入。
+    cell.Sequence.store(m_dequeuePosition + m_mask + 1, std::memory_order_release);
+    m_dequeuePosition++;
+    return true;
+}
+
+size_t EngineCommandQueue::Drain(VCCRenderingEngine& engine, EngineCommandCallback callback, void* context)
+{
+    size_t applied = 0;
+    EngineCommand command;
+    while (applied < Capacity() && Pop(command)) {
+        bool succeeded = true;
+        switch (command.Type) {
+            case EngineCommandRotate:
+                engine.OnRotate(command.Orientation);
+                break;
+            case EngineCommandResize:
+                engine.Resize(command.Width, command.Height);
+                break;
+            case EngineCommandLoadMesh:
+                succeeded = engine.LoadMesh(command.Path);
+                break;
+        }
+        if (callback)
+            callback(command, succeeded, context);
+        applied++;
+    }
+    m_applied += applied;
+    return applied;
+}
+
+EngineCommandStats EngineCommandQueue::Stats() const
+{
+    EngineCommandStats stats;
+    stats.Posted = m_posted.load(std::memory_order_relaxed);
+    stats.Dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.Applied = m_applied;
+    return stats;
+}
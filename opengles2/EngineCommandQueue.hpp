@@ -0,0 +1,84 @@
+//
+//  EngineCommandQueue.hpp
+//  opengles2
+//
+//  位于 VCCRenderingEngine 接口之前的无锁命令队列：任意线程投递方向变化、尺寸变化与场景编辑，渲染线程在每帧的固定位置统一执行。
+//
+/*
+ 通知回调、触摸事件以及后台线程都可能要求改变引擎的状态，而引擎的方法只能在持有 GL 上下文的渲染线程上调用。
+ 投递命令的线程（生产者，可有多个）只把命令写入队列，从不等待渲染线程；渲染线程（唯一的消费者）在 Drain() 中依次执行命令。
+ 队列是固定容量的环形缓冲区（Vyukov 的有界队列）：每个槽位带有一个序号，生产者以 CAS 争用写入位置，
+ 写完命令后以 release 语义发布该槽位的序号，消费者以 acquire 语义读取序号后即可安全地读取命令。
+ 全部槽位在构造时一次性分配，命令也不含指针（路径复制进命令中），因此投递与执行均不分配内存。
+ 队列已满时 Post*() 立即返回 false 并计入 Dropped，而非阻塞生产者。
+ Drain() 每次至多执行 Capacity() 条命令，生产者持续投递时也不会使一帧无限延长。
+ */
+
+#ifndef EngineCommandQueue_hpp
+#define EngineCommandQueue_hpp
+
+#include "VCCRenderingEngine.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// 命令中路径的最大长度（含结尾的 0）。
+static const size_t EngineCommandPathCapacity = 256;
+
+enum EngineCommandType {
+    EngineCommandRotate,
+    EngineCommandResize,
+    EngineCommandLoadMesh,
+};
+
+struct EngineCommand {
+    EngineCommandType Type;
+    VCCDeviceOrientation Orientation;   // EngineCommandRotate
+    int Width;                          // EngineCommandResize
+    int Height;
+    char Path[EngineCommandPathCapacity];   // EngineCommandLoadMesh
+};
+
+struct EngineCommandStats {
+    uint64_t Posted;
+    uint64_t Dropped;                   // 因队列已满而丢弃的命令数
+    uint64_t Applied;
+};
+
+// 每条命令执行之后调用，succeeded 为 LoadMesh() 等方法的返回值（其余命令总为 true）。
+typedef void (*EngineCommandCallback)(const EngineCommand& command, bool succeeded, void* context);
+
+class EngineCommandQueue {
+public:
+    // capacity 向上取整为 2 的幂。
+    explicit EngineCommandQueue(size_t capacity = 64);
+    ~EngineCommandQueue();
+    size_t Capacity() const { return m_mask + 1; }
+    // 可在任意线程上调用，队列已满（或路径过长）时返回 false。
+    bool PostRotate(VCCDeviceOrientation orientation);
+    bool PostResize(int width, int height);
+    bool PostLoadMesh(const char* path);
+    bool Post(const EngineCommand& command);
+    // 只能在渲染线程上调用：按投递顺序取出命令并对 engine 执行，返回执行的命令数。
+    size_t Drain(VCCRenderingEngine& engine, EngineCommandCallback callback = 0, void* context = 0);
+    // 只取出一条命令而不执行，队列为空时返回 false；与 Drain() 同样只能由消费者调用。
+    bool Pop(EngineCommand& command);
+    // Applied 只由消费者更新，应在渲染线程上读取。
+    EngineCommandStats Stats() const;
+private:
+    EngineCommandQueue(const EngineCommandQueue&);
+    EngineCommandQueue& operator=(const EngineCommandQueue&);
+    struct Cell {
+        std::atomic<size_t> Sequence;
+        EngineCommand Command;
+    };
+    Cell* m_cells;
+    size_t m_mask;
+    std::atomic<size_t> m_enqueuePosition;
+    size_t m_dequeuePosition;           // 只由消费者读写
+    std::atomic<uint64_t> m_posted;
+    std::atomic<uint64_t> m_dropped;
+    uint64_t m_applied;
+};
+
+#endif /* EngineCommandQueue_hpp */
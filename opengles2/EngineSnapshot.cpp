@@ -0,0 +1,161 @@
+//
+//  EngineSnapshot.cpp
+//  opengles2
+//
+
+#include "EngineSnapshot.hpp"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool WritePadding(FILE* file, uint64_t from, uint64_t to)
+{
+    static const unsigned char zeros[EngineSnapshotAlignment] = {};
+    return from == to || fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+void EngineSnapshotWriter::AddBlock(uint32_t id, const void* data, size_t size)
+{
+    PendingBlock block = { id, data, size };
+    m_blocks.push_back(block);
+}
+
+bool EngineSnapshotWriter::Save(const char* path, uint64_t parameterHash) const
+{
+    EngineSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = EngineSnapshotMagic;
+    header.Version = EngineSnapshotVersion;
+    header.ParameterHash = parameterHash;
+    header.BlockCount = (uint32_t) m_blocks.size();
+
+    std::vector<EngineSnapshotBlock> table(m_blocks.size());
+    uint64_t offset = sizeof(header) + table.size() * sizeof(EngineSnapshotBlock);
+    for (size_t i = 0; i < m_blocks.size(); ++i) {
+        memset(&table[i], 0, sizeof(table[i]));
+        table[i].Id = m_blocks[i].Id;
+        table[i].Offset = AlignUp(offset, EngineSnapshotAlignment);
+        table[i].Size = m_blocks[i].Size;
+        offset = table[i].Offset + table[i].Size;
+    }
+    header.FileSize = offset;
+
+    // 先写入临时文件，完整写入后再以 rename() 原子地替换旧快照。
+    std::string temporaryPath = std::string(path) + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        std::cout << "Unable to create snapshot " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (table.empty() || fwrite(&table[0], sizeof(EngineSnapshotBlock), table.size(), file) == table.size());
+    uint64_t position = sizeof(header) + table.size() * sizeof(EngineSnapshotBlock);
+    for (size_t i = 0; ok && i < m_blocks.size(); ++i) {
+        ok = WritePadding(file, position, table[i].Offset);
+        ok = ok && (m_blocks[i].Size == 0 || fwrite(m_blocks[i].Data, 1, m_blocks[i].Size, file) == m_blocks[i].Size);
+        position = table[i].Offset + table[i].Size;
+    }
+    ok = (fclose(file) == 0) && ok;
+    ok = ok && rename(temporaryPath.c_str(), path) == 0;
+    if (!ok) {
+        std::cout << "Failed writing snapshot " << path << std::endl;
+        unlink(temporaryPath.c_str());
+    }
+    return ok;
+}
+
+EngineSnapshot::EngineSnapshot() : m_data(0), m_size(0)
+{
+}
+
+EngineSnapshot::~EngineSnapshot()
+{
+    Close();
+}
+
+bool EngineSnapshot::Open(const char* path, uint64_t parameterHash)
+{
+    Close();
+
+    // 首次启动时快照尚不存在，属于正常情况，不输出任何信息。
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(EngineSnapshotHeader)) {
+        std::cout << "Snapshot " << path << " is truncated" << std::endl;
+        close(fd);
+        return false;
+    }
+    void* data = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cout << "Unable to map snapshot " << path << std::endl;
+        return false;
+    }
+    m_data = (const unsigned char*) data;
+    m_size = info.st_size;
+
+    if (!Validate(path, parameterHash)) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void EngineSnapshot::Close()
+{
+    if (m_data)
+        munmap((void*) m_data, m_size);
+    m_data = 0;
+    m_size = 0;
+}
+
+bool EngineSnapshot::Validate(const char* path, uint64_t parameterHash) const
+{
+    const EngineSnapshotHeader& header = *(const EngineSnapshotHeader*) m_data;
+    if (header.Magic != EngineSnapshotMagic || header.Version != EngineSnapshotVersion) {
+        std::cout << "Snapshot " << path << " has an unsupported format or version" << std::endl;
+        return false;
+    }
+    if (header.ParameterHash != parameterHash) {
+        std::cout << "Snapshot " << path << " was built with different parameters" << std::endl;
+        return false;
+    }
+    uint64_t tableEnd = sizeof(header) + uint64_t(header.BlockCount) * sizeof(EngineSnapshotBlock);
+    bool layoutOk = header.FileSize == m_size && tableEnd <= m_size;
+    const EngineSnapshotBlock* table = (const EngineSnapshotBlock*) (m_data + sizeof(header));
+    for (uint32_t i = 0; layoutOk && i < header.BlockCount; ++i)
+        layoutOk = table[i].Offset % EngineSnapshotAlignment == 0 && table[i].Offset >= tableEnd
+                && table[i].Size <= m_size && table[i].Offset <= m_size - table[i].Size;
+    if (!layoutOk) {
+        std::cout << "Snapshot " << path << " is corrupt" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+const void* EngineSnapshot::FindBlock(uint32_t id, size_t& size) const
+{
+    size = 0;
+    if (!m_data)
+        return 0;
+    const EngineSnapshotHeader& header = *(const EngineSnapshotHeader*) m_data;
+    const EngineSnapshotBlock* table = (const EngineSnapshotBlock*) (m_data + sizeof(header));
+    for (uint32_t i = 0; i < header.BlockCount; ++i) {
+        if (table[i].Id == id) {
+            size = (size_t) table[i].Size;
+            return m_data + table[i].Offset;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+//
+//  EngineSnapshot.hpp
+//  opengles2
+//
+//  保存 Initialize() 计算结果的快照文件（.vccsnapshot），用于缩短再次启动时到第一帧的时间。
+//
+/*
+ 快照由若干以编号标识的数据块组成，各引擎自行定义数据块的编号与内容（网格、投影矩阵、动画状态、着色器变量位置等），文件布局如下：
+   EngineSnapshotHeader
+   EngineSnapshotBlock[BlockCount]     数据块目录
+   数据块内容                           各块的起始位置均按 EngineSnapshotAlignment 字节对齐
+ 头部记录了参数散列值（ParameterHash），由引擎对所有影响初始化结果的常量、视口尺寸、顶点格式以及着色器源码求得；依赖 GL 驱动的内容（着色器变量位置）由引擎另行记录驱动标识并在恢复时比对。
+ 版本或参数散列值不一致时 Open() 返回 false，引擎随即退回完整的初始化流程并重新写入快照；因此快照永远不会恢复出过时的状态。
+ 读取时以一次 mmap 映射整个文件，各数据块直接从映射中复制到引擎的容器内；写入时先写至临时文件再重命名，中途失败不会留下残缺的快照。
+ 快照采用本机字节序与本机结构体布局，只用于同一设备上同一程序的再次启动，不可跨设备分发。
+ */
+
+#ifndef EngineSnapshot_hpp
+#define EngineSnapshot_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+static const uint32_t EngineSnapshotMagic = 0x53434356; // "VCCS"
+static const uint32_t EngineSnapshotVersion = 1;
+static const uint32_t EngineSnapshotAlignment = 16;
+
+struct EngineSnapshotHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t ParameterHash;
+    uint32_t BlockCount;
+    uint32_t Reserved;
+    uint64_t FileSize;
+};
+
+struct EngineSnapshotBlock {
+    uint32_t Id;
+    uint32_t Reserved;
+    uint64_t Offset;
+    uint64_t Size;
+};
+
+// 以 FNV-1a 算法累积参数散列值。
+class SnapshotHasher {
+public:
+    SnapshotHasher() : m_hash(14695981039346656037ull) {}
+    void Add(const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*) data;
+        for (size_t i = 0; i < size; ++i) {
+            m_hash ^= bytes[i];
+            m_hash *= 1099511628211ull;
+        }
+    }
+    void AddString(const char* text) { if (text) Add(text, strlen(text) + 1); }
+    template <typename T>
+    void AddValue(const T& value) { Add(&value, sizeof(T)); }
+    uint64_t Hash() const { return m_hash; }
+private:
+    uint64_t m_hash;
+};
+
+// 收集数据块并写入快照文件。AddBlock() 只记录指针，数据在 Save() 返回之前必须保持有效。
+class EngineSnapshotWriter {
+public:
+    void AddBlock(uint32_t id, const void* data, size_t size);
+    template <typename T>
+    void AddVector(uint32_t id, const std::vector<T>& values) { AddBlock(id, values.empty() ? 0 : &values[0], values.size() * sizeof(T)); }
+    template <typename T>
+    void AddValue(uint32_t id, const T& value) { AddBlock(id, &value, sizeof(T)); }
+    bool Save(const char* path, uint64_t parameterHash) const;
+private:
+    struct PendingBlock {
+        uint32_t Id;
+        const void* Data;
+        size_t Size;
+    };
+    std::vector<PendingBlock> m_blocks;
+};
+
+class EngineSnapshot {
+public:
+    EngineSnapshot();
+    ~EngineSnapshot();
+    // 文件不存在、格式错误或参数散列值不一致时返回 false。
+    bool Open(const char* path, uint64_t parameterHash);
+    void Close();
+    bool IsOpen() const { return m_data != 0; }
+    size_t Size() const { return m_size; }
+    // 返回数据块内容，不存在时返回 0。
+    const void* FindBlock(uint32_t id, size_t& size) const;
+    // 数据块不存在或长度不是 sizeof(T) 的整数倍（ReadValue 则要求恰好相等）时返回 false。
+    template <typename T>
+    bool ReadVector(uint32_t id, std::vector<T>& values) const
+    {
+        size_t size;
+        const void* data = FindBlock(id, size);
+        if (!data || size % sizeof(T) != 0)
+            return false;
+        values.resize(size / sizeof(T));
+        if (size)
+            memcpy(&values[0], data, size);
+        return true;
+    }
+    template <typename T>
+    bool ReadValue(uint32_t id, T& value) const
+    {
+        size_t size;
+        const void* data = FindBlock(id, size);
+        if (!data || size != sizeof(T))
+            return false;
+        memcpy(&value, data, size);
+        return true;
+    }
+private:
+    EngineSnapshot(const EngineSnapshot&);
+    EngineSnapshot& operator=(const EngineSnapshot&);
+    bool Validate(const char* path, uint64_t parameterHash) const;
+    const unsigned char* m_data;
+    size_t m_size;
+};
+
+#endif /* EngineSnapshot_hpp */
@@ -0,0 +1,225 @@
+//
+//  Fixed.hpp
+//  opengles2
+//
+//  16.16 定点数 Fixed16，供没有浮点单元（或浮点运算昂贵）的低功耗协处理器使用；Vector、Matrix 与 QuaternionT 均可以其实例化。
+//
+/*
+ Raw 的低 16 位为小数部分：表示范围约为 ±32768，精度为 1/65536。乘法与除法以 64 位中间结果计算，乘法舍入至最近，
+ 除法向零截断；溢出不检查，与整数运算一样回绕。与 float、double 之间的转换须显式写出（构造可以隐式），
+ 与 int 的混合运算则将 int 隐式转换为定点数，模板中 1 - c、2 * near 之类的写法因此无需修改。
+ 数学函数全部以整数运算实现（快速路径），不经过浮点：
+   sqrt      逐位求 64 位整数的平方根，精确至最低位
+   sin、cos  化简至 [-π/2, π/2] 后以 9 次泰勒多项式在 2.30 定点下求值，误差约 1 个最低位
+   acos      Abramowitz 与 Stegun 4.4.46 的 7 次多项式，误差约 1 个最低位
+ 点积、归一化与 4×4 矩阵乘法另有特化（快速路径）：各乘积以 32.32 的 64 位整数累加后只舍入一次，比逐项舍入更精确，
+ 中间结果也不会溢出（逐项计算时分量超过 181 即溢出）；归一化直接对累加结果求整数平方根，只做一次除法求倒数。
+ 定点数只适合范围有限的局部坐标：世界坐标、透视投影矩阵中的近平面项等应在主处理器上以 float 或 double 计算。
+ */
+
+#ifndef Fixed_hpp
+#define Fixed_hpp
+
+#include "Quaternion.hpp"
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+
+struct Fixed16 {
+    Fixed16() {}
+    Fixed16(int n) : Raw(int32_t(uint32_t(n) << 16)) {}
+    Fixed16(float f) : Raw(int32_t(std::floor(f * 65536.0 + 0.5))) {}
+    Fixed16(double d) : Raw(int32_t(std::floor(d * 65536.0 + 0.5))) {}
+    static Fixed16 FromRaw(int32_t raw)
+    {
+        Fixed16 f;
+        f.Raw = raw;
+        return f;
+    }
+    explicit operator float() const { return Raw * (1.0f / 65536); }
+    explicit operator double() const { return Raw * (1.0 / 65536); }
+
+    friend Fixed16 operator+(Fixed16 a, Fixed16 b) { return FromRaw(int32_t(uint32_t(a.Raw) + uint32_t(b.Raw))); }
+    friend Fixed16 operator-(Fixed16 a, Fixed16 b) { return FromRaw(int32_t(uint32_t(a.Raw) - uint32_t(b.Raw))); }
+    friend Fixed16 operator-(Fixed16 a) { return FromRaw(int32_t(0u - uint32_t(a.Raw))); }
+    friend Fixed16 operator*(Fixed16 a, Fixed16 b) { return FromRaw(int32_t((int64_t(a.Raw) * b.Raw + 0x8000) >> 16)); }
+    friend Fixed16 operator/(Fixed16 a, Fixed16 b) { return FromRaw(int32_t(int64_t(a.Raw) * 65536 / b.Raw)); }
+    Fixed16& operator+=(Fixed16 b) { return *this = *this + b; }
+    Fixed16& operator-=(Fixed16 b) { return *this = *this - b; }
+    Fixed16& operator*=(Fixed16 b) { return *this = *this * b; }
+    Fixed16& operator/=(Fixed16 b) { return *this = *this / b; }
+
+    friend bool operator==(Fixed16 a, Fixed16 b) { return a.Raw == b.Raw; }
+    friend bool operator!=(Fixed16 a, Fixed16 b) { return a.Raw != b.Raw; }
+    friend bool operator<(Fixed16 a, Fixed16 b) { return a.Raw < b.Raw; }
+    friend bool operator>(Fixed16 a, Fixed16 b) { return a.Raw > b.Raw; }
+    friend bool operator<=(Fixed16 a, Fixed16 b) { return a.Raw <= b.Raw; }
+    friend bool operator>=(Fixed16 a, Fixed16 b) { return a.Raw >= b.Raw; }
+
+    int32_t Raw;
+};
+
+// 64 位整数平方根的整数部分，逐位求得；从 n 的最高位开始，迭代次数为 n 的位数的一半。
+inline uint32_t FixedSquareRoot(uint64_t n)
+{
+    if (n == 0)
+        return 0;
+    uint64_t root = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    uint64_t bit = uint64_t(1) << ((63 - __builtin_clzll(n)) & ~1);
+#else
+    uint64_t bit = uint64_t(1) << 62;
+    while (bit > n)
+        bit >>= 2;
+#endif
+    // 每一步的比较结果难以预测，以掩码代替分支。
+    while (bit) {
+        uint64_t trial = root + bit;
+        uint64_t mask = uint64_t(0) - uint64_t(n >= trial);
+        n -= trial & mask;
+        root = (root >> 1) | (bit & mask);
+        bit >>= 2;
+    }
+    return uint32_t(root);
+}
+
+// 将 Raw 平方和为 squares（32.32）的各分量除以长度：只求一次倒数（2^48 / 长度），各分量乘以倒数。
+// 分量不超过长度，乘积因此不超过 2^48；倒数至少有 17 位有效数字，误差不超过半个最低位。
+inline void FixedNormalize(int32_t* components, int count, uint64_t squares)
+{
+    int64_t length = FixedSquareRoot(squares);
+    if (length == 0)
+        return;
+    int64_t reciprocal = (int64_t(1) << 48) / length;
+    for (int i = 0; i < count; ++i)
+        components[i] = int32_t((int64_t(components[i]) * reciprocal + (int64_t(1) << 31)) >> 32);
+}
+
+// 32.32 的累加结果舍入为 16.16。
+inline Fixed16 FixedFromProducts(int64_t sum)
+{
+    return Fixed16::FromRaw(int32_t((sum + 0x8000) >> 16));
+}
+
+// 2.30 定点数的乘法，sin、cos、acos 的多项式以此求值。
+inline int64_t FixedMultiply30(int64_t a, int64_t b)
+{
+    return (a * b + (int64_t(1) << 29)) >> 30;
+}
+
+static const int64_t FixedPi30 = 3373259426;           // π * 2^30
+static const int64_t FixedHalfPi30 = 1686629713;
+
+// x 为 2.30 定点数表示的弧度，可以是任意大小（不超过 64 位整数的范围）。
+inline Fixed16 FixedSine30(int64_t x)
+{
+    // 64 位取模很慢，参数通常已在 [-π, π] 之内。
+    if (x > FixedPi30 || x < -FixedPi30) {
+        x %= 2 * FixedPi30;
+        if (x > FixedPi30)
+            x -= 2 * FixedPi30;
+        else if (x < -FixedPi30)
+            x += 2 * FixedPi30;
+    }
+    if (x > FixedHalfPi30)
+        x = FixedPi30 - x;
+    else if (x < -FixedHalfPi30)
+        x = -FixedPi30 - x;
+    // sin(x) = x(1 - x²/3!(1 - x²/(4·5)(1 - x²/(6·7)(1 - x²/(8·9)))))，系数为 2^30 / (n(n + 1))。
+    int64_t x2 = FixedMultiply30(x, x);
+    int64_t one = int64_t(1) << 30;
+    int64_t s = one - FixedMultiply30(x2, 14913081);    // 1/72
+    s = one - FixedMultiply30(FixedMultiply30(x2, 25565282), s);    // 1/42
+    s = one - FixedMultiply30(FixedMultiply30(x2, 53687091), s);    // 1/20
+    s = one - FixedMultiply30(FixedMultiply30(x2, 178956971), s);   // 1/6
+    return Fixed16::FromRaw(int32_t((FixedMultiply30(x, s) + (1 << 13)) >> 14));
+}
+
+inline Fixed16 sqrt(Fixed16 f)
+{
+    return f.Raw <= 0 ? Fixed16(0) : Fixed16::FromRaw(int32_t(FixedSquareRoot(uint64_t(f.Raw) << 16)));
+}
+
+inline Fixed16 sin(Fixed16 f)
+{
+    return FixedSine30(int64_t(f.Raw) * 16384);
+}
+
+inline Fixed16 cos(Fixed16 f)
+{
+    return FixedSine30(int64_t(f.Raw) * 16384 + FixedHalfPi30);
+}
+
+// 参数截断至 [-1, 1]。
+inline Fixed16 acos(Fixed16 f)
+{
+    int64_t x = std::min<int64_t>(std::abs(int64_t(f.Raw)), 65536) * 16384;
+    static const int64_t Coefficients[] = {
+        -1355589, 7161955, -18348235, 33169905, -53874249, 95540460, -230423709, 1686629690,
+    };
+    int64_t p = Coefficients[0];
+    for (int i = 1; i < 8; ++i)
+        p = FixedMultiply30(p, x) + Coefficients[i];
+    // acos(x) = sqrt(1 - x) p(x)，x < 0 时为 π - acos(-x)。
+    int64_t root = FixedSquareRoot(uint64_t((int64_t(1) << 30) - x) << 30);
+    int64_t result = FixedMultiply30(root, p);
+    if (f.Raw < 0)
+        result = FixedPi30 - result;
+    return Fixed16::FromRaw(int32_t((result + (1 << 13)) >> 14));
+}
+
+template <>
+inline Fixed16 Vector3<Fixed16>::Dot(const Vector3<Fixed16>& v) const
+{
+    return FixedFromProducts(int64_t(x.Raw) * v.x.Raw + int64_t(y.Raw) * v.y.Raw + int64_t(z.Raw) * v.z.Raw);
+}
+
+template <>
+inline void Vector3<Fixed16>::Normalize()
+{
+    FixedNormalize(&x.Raw, 3, uint64_t(int64_t(x.Raw) * x.Raw + int64_t(y.Raw) * y.Raw + int64_t(z.Raw) * z.Raw));
+}
+
+template <>
+inline Fixed16 Vector4<Fixed16>::Dot(const Vector4<Fixed16>& v) const
+{
+    return FixedFromProducts(int64_t(x.Raw) * v.x.Raw + int64_t(y.Raw) * v.y.Raw
+                             + int64_t(z.Raw) * v.z.Raw + int64_t(w.Raw) * v.w.Raw);
+}
+
+template <>
+inline Fixed16 QuaternionT<Fixed16>::Dot(const QuaternionT<Fixed16>& q) const
+{
+    return FixedFromProducts(int64_t(x.Raw) * q.x.Raw + int64_t(y.Raw) * q.y.Raw
+                             + int64_t(z.Raw) * q.z.Raw + int64_t(w.Raw) * q.w.Raw);
+}
+
+template <>
+inline void QuaternionT<Fixed16>::Normalize()
+{
+    FixedNormalize(&x.Raw, 4, uint64_t(int64_t(x.Raw) * x.Raw + int64_t(y.Raw) * y.Raw
+                                       + int64_t(z.Raw) * z.Raw + int64_t(w.Raw) * w.Raw));
+}
+
+template <>
+inline Matrix4<Fixed16> Matrix4<Fixed16>::operator*(const Matrix4<Fixed16>& b) const
+{
+    const Fixed16* a = Pointer();
+    const Fixed16* c = b.Pointer();
+    Matrix4<Fixed16> m;
+    Fixed16* out = &m.x.x;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 4; ++j)
+            out[i * 4 + j] = FixedFromProducts(int64_t(a[i * 4].Raw) * c[j].Raw + int64_t(a[i * 4 + 1].Raw) * c[4 + j].Raw
+                                               + int64_t(a[i * 4 + 2].Raw) * c[8 + j].Raw + int64_t(a[i * 4 + 3].Raw) * c[12 + j].Raw);
+    return m;
+}
+
+typedef Vector2<Fixed16> fxvec2;
+typedef Vector3<Fixed16> fxvec3;
+typedef Vector4<Fixed16> fxvec4;
+typedef Matrix3<Fixed16> fxmat3;
+typedef Matrix4<Fixed16> fxmat4;
+typedef QuaternionT<Fixed16> FixedQuaternion;
+
+#endif /* Fixed_hpp */
@@ -0,0 +1,50 @@
+//
+//  FixedTimestep.cpp
+//  opengles2
+//
+
+#include "FixedTimestep.hpp"
+
+#include <cmath>
+
+FixedTimestep::FixedTimestep(float stepSeconds, int maxSteps)
+    : m_step(stepSeconds), m_maxSteps(maxSteps)
+{
+    Reset();
+}
+
+int FixedTimestep::Advance(float timeStep)
+{
+    m_stats.Frames++;
+    // 时间戳回退（例如显示链接重新开始）时不推进模拟。
+    if (timeStep > 0)
+        m_accumulator += timeStep;
+    float due = std::floor(m_accumulator / m_step);
+    int steps = m_maxSteps;
+    if (due > m_maxSteps) {
+        // 只丢弃整数步，不足一步的部分仍保留在累加器中，插值系数因而不会因丢弃而跳变。
+        float dropped = (due - m_maxSteps) * m_step;
+        m_accumulator -= dropped;
+        m_stats.CappedFrames++;
+        m_stats.DroppedSeconds += dropped;
+    } else {
+        steps = (int) due;
+    }
+    m_accumulator -= steps * m_step;
+    // 浮点误差可能使累加器略小于 0 或略大于一步。
+    if (m_accumulator < 0)
+        m_accumulator = 0;
+    else if (m_accumulator >= m_step)
+        m_accumulator = std::nextafter(m_step, 0.0f);
+    m_stats.Steps += steps;
+    return steps;
+}
+
+void FixedTimestep::Reset()
+{
+    m_accumulator = 0;
+    m_stats.Frames = 0;
+    m_stats.Steps = 0;
+    m_stats.CappedFrames = 0;
+    m_stats.DroppedSeconds = 0;
+}
@@ -0,0 +1,46 @@
+//
+//  FixedTimestep.hpp
+//  opengles2
+//
+//  固定步长的模拟时钟：累加显示链接给出的真实时间，每帧执行零或多个固定步长的模拟，并给出绘制时的插值系数。
+//
+/*
+ 显示链接的时间间隔随负载波动，直接以其推进模拟会使结果依赖于帧率；固定步长则使同样的输入总是得到同样的模拟结果，
+ 模拟频率也可以低于显示频率。Advance() 返回本帧应执行的步数，步数之外不足一步的时间留在累加器中，
+ Alpha() 即其占一步的比例，绘制时以此在最近两步的状态之间插值，画面因而仍随显示频率平滑变化（代价是落后至多一步）。
+ 单帧的步数至多为 MaxSteps：负载尖峰（或应用被挂起）之后若补足全部步数，模拟本身的耗时又会拉长下一帧，
+ 进而要求更多的步数（“死亡螺旋”）；超出上限的时间被直接丢弃，模拟在这种情况下变慢，而非使帧时间失控。
+ */
+
+#ifndef FixedTimestep_hpp
+#define FixedTimestep_hpp
+
+#include <stdint.h>
+
+struct FixedTimestepStats {
+    uint64_t Frames;
+    uint64_t Steps;
+    uint64_t CappedFrames;              // 步数达到上限、丢弃了部分时间的帧数
+    double DroppedSeconds;
+};
+
+class FixedTimestep {
+public:
+    explicit FixedTimestep(float stepSeconds = 1.0f / 60, int maxSteps = 4);
+    // 累加一帧的真实时间（秒），返回本帧应执行的固定步数，介于 0 与 MaxSteps() 之间。
+    int Advance(float timeStep);
+    float StepSeconds() const { return m_step; }
+    int MaxSteps() const { return m_maxSteps; }
+    // 累加器中剩余的时间占一步的比例，位于 [0, 1)，用于在上一步与当前步的状态之间插值。
+    float Alpha() const { return m_accumulator / m_step; }
+    const FixedTimestepStats& Stats() const { return m_stats; }
+    // 清空累加器与统计数据，例如从快照恢复之后。
+    void Reset();
+private:
+    float m_step;
+    int m_maxSteps;
+    float m_accumulator;
+    FixedTimestepStats m_stats;
+};
+
+#endif /* FixedTimestep_hpp */
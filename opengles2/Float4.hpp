@@ -0,0 +1,107 @@
+//
+//  Float4.hpp
+//  opengles2
+//
+//  4 路单精度浮点 SIMD 运算的薄封装：iOS 设备使用 NEON，模拟器与桌面平台使用 SSE，其余平台逐分量计算。
+//
+/*
+ 各函数均为文件内联的 static 函数，供需要批量处理数据的模块（遮挡剔除的光栅化、射线拾取）共享同一套写法。
+ 比较函数返回 Mask4，各分量全 1 表示条件成立；与 IEEE 754 一致，任一操作数为 NaN 时比较结果为假。
+ MaskBits4() 将 Mask4 压缩为 4 位整数（第 i 位对应第 i 个分量），用于判断是否有分量成立以及逐一处理成立的分量。
+ */
+
+#ifndef Float4_hpp
+#define Float4_hpp
+
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+typedef float32x4_t Float4;
+typedef uint32x4_t Mask4;
+static inline Float4 Splat4(float f) { return vdupq_n_f32(f); }
+static inline Float4 Load4(const float* p) { return vld1q_f32(p); }
+static inline void Store4(float* p, Float4 v) { vst1q_f32(p, v); }
+static inline Float4 Add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+static inline Float4 Sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+static inline Float4 Mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+static inline Float4 Min4(Float4 a, Float4 b) { return vminq_f32(a, b); }
+static inline Float4 Max4(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+static inline Mask4 GreaterEqual4(Float4 a, Float4 b) { return vcgeq_f32(a, b); }
+static inline Mask4 LessEqual4(Float4 a, Float4 b) { return vcleq_f32(a, b); }
+static inline Mask4 Less4(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+static inline Mask4 And4(Mask4 a, Mask4 b) { return vandq_u32(a, b); }
+static inline Mask4 Or4(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+static inline Float4 Select4(Mask4 m, Float4 a, Float4 b) { return vbslq_f32(m, a, b); }
+static inline int MaskBits4(Mask4 m)
+{
+    uint32_t v[4];
+    vst1q_u32(v, m);
+    return (v[0] & 1) | (v[1] & 2) | (v[2] & 4) | (v[3] & 8);
+}
+#if defined(__aarch64__)
+static inline Float4 Div4(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+static inline Float4 Sqrt4(Float4 a) { return vsqrtq_f32(a); }
+#else
+// ARMv7 的 NEON 没有除法与平方根指令，以倒数（平方根倒数）的估计值经两次牛顿迭代求得，相对误差约为 1e-6。
+static inline Float4 Div4(Float4 a, Float4 b)
+{
+    Float4 r = vrecpeq_f32(b);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    r = vmulq_f32(vrecpsq_f32(b, r), r);
+    return vmulq_f32(a, r);
+}
+static inline Float4 Sqrt4(Float4 a)
+{
+    Float4 r = vrsqrteq_f32(a);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+    return vbslq_f32(vcgtq_f32(a, vdupq_n_f32(0)), vmulq_f32(a, r), vdupq_n_f32(0));
+}
+#endif
+#elif defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+typedef __m128 Float4;
+typedef __m128 Mask4;
+static inline Float4 Splat4(float f) { return _mm_set1_ps(f); }
+static inline Float4 Load4(const float* p) { return _mm_loadu_ps(p); }
+static inline void Store4(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+static inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+static inline Float4 Sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+static inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+static inline Float4 Div4(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+static inline Float4 Sqrt4(Float4 a) { return _mm_sqrt_ps(a); }
+static inline Float4 Min4(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+static inline Float4 Max4(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+static inline Mask4 GreaterEqual4(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+static inline Mask4 LessEqual4(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+static inline Mask4 Less4(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+static inline Mask4 And4(Mask4 a, Mask4 b) { return _mm_and_ps(a, b); }
+static inline Mask4 Or4(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+static inline Float4 Select4(Mask4 m, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+static inline int MaskBits4(Mask4 m) { return _mm_movemask_ps(m); }
+#else
+struct Float4 { float v[4]; };
+struct Mask4 { bool v[4]; };
+static inline Float4 Splat4(float f) { Float4 r = {{ f, f, f, f }}; return r; }
+static inline Float4 Load4(const float* p) { Float4 r = {{ p[0], p[1], p[2], p[3] }}; return r; }
+static inline void Store4(float* p, Float4 v) { memcpy(p, v.v, sizeof(v.v)); }
+static inline Float4 Add4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+static inline Float4 Sub4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+static inline Float4 Mul4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+static inline Float4 Div4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+static inline Float4 Sqrt4(Float4 a) { for (int i = 0; i < 4; ++i) a.v[i] = std::sqrt(a.v[i]); return a; }
+static inline Float4 Min4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = std::min(a.v[i], b.v[i]); return a; }
+static inline Float4 Max4(Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) a.v[i] = std::max(a.v[i], b.v[i]); return a; }
+static inline Mask4 GreaterEqual4(Float4 a, Float4 b) { Mask4 m; for (int i = 0; i < 4; ++i) m.v[i] = a.v[i] >= b.v[i]; return m; }
+static inline Mask4 LessEqual4(Float4 a, Float4 b) { Mask4 m; for (int i = 0; i < 4; ++i) m.v[i] = a.v[i] <= b.v[i]; return m; }
+static inline Mask4 Less4(Float4 a, Float4 b) { Mask4 m; for (int i = 0; i < 4; ++i) m.v[i] = a.v[i] < b.v[i]; return m; }
+static inline Mask4 And4(Mask4 a, Mask4 b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] && b.v[i]; return a; }
+static inline Mask4 Or4(Mask4 a, Mask4 b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] || b.v[i]; return a; }
+static inline Float4 Select4(Mask4 m, Float4 a, Float4 b) { for (int i = 0; i < 4; ++i) if (!m.v[i]) a.v[i] = b.v[i]; return a; }
+static inline int MaskBits4(Mask4 m) { return m.v[0] | m.v[1] << 1 | m.v[2] << 2 | m.v[3] << 3; }
+#endif
+
+#endif /* Float4_hpp */
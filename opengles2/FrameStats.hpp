@@ -0,0 +1,136 @@
+//
+//  FrameStats.hpp
+//  opengles2
+//
+//  引擎每帧提交给 GL 的工作量统计：顶点、图元、绘制调用、状态切换、上传的字节数以及遮挡剔除与 LOD 省去的工作量。
+//
+/*
+ 计数由引擎在发出相应的 GL 调用处累加，而非事后估算，因此如实反映了 LOD、剔除、多摄像机与流式绘制等路径的实际提交量。
+ 状态切换按逻辑上的切换计数（着色器程序、顶点数据源、索引缓冲区、帧缓冲区与视口），一次切换可能对应多个 GL 调用。
+ Render() 结束时调用 EndFrame()，当前计数成为 LastFrame 并累加至 Total；两帧之间的上传（例如 LoadMesh()）计入下一帧。
+ 统计只在渲染线程上读写。
+ */
+
+#ifndef FrameStats_hpp
+#define FrameStats_hpp
+
+#include "PhaseTimer.hpp"
+#include "StreamingScene.hpp"
+#include "VertexStream.hpp"
+#include <stdint.h>
+
+struct VCCRenderCounters {
+    uint64_t Vertices;                  // 顶点着色器（或固定管线）处理的顶点数，索引绘制按索引数计
+    uint64_t Primitives;
+    uint64_t DrawCalls;
+    uint64_t StateChanges;
+    uint64_t StateChangesSaved;         // 渲染队列排序相对按加入顺序提交所节省的状态切换（参见 RenderQueue.hpp）
+    uint64_t OcclusionTested;           // 参与遮挡剔除的物体数
+    uint64_t Occluded;                  // 其中被遮挡而未绘制的物体数
+    uint64_t LodSwitches;               // 切换 LOD 级别的次数
+    uint64_t LodVerticesSaved;          // 相对于全部使用第 0 级节省的顶点数
+    uint64_t UniformBytes;              // ES 1.1 中为载入的矩阵
+    uint64_t BufferBytes;               // 经 glBufferData 上传以及经映射写入的顶点与索引数据
+};
+
+struct VCCFrameStats {
+    uint64_t Frames;
+    VCCRenderCounters LastFrame;
+    VCCRenderCounters Total;            // 包含 LastFrame
+    uint64_t MeshBytes;                 // 引擎在 CPU 内存中持有的网格数据（ES 1.1 中包括直接引用的文件映射）
+    uint64_t GLBytes;                   // GLResourceRegistry 估算的 GL 对象占用
+    VertexStreamStats Stream;           // 流式顶点缓冲区的累计统计，未使用时全部为 0
+    StreamingStats Scene;               // 流式场景的规模与生产者、消费者的累计统计，未使用时全部为 0
+    uint64_t SnapshotBytes;             // 最近一次初始化从快照（参见 EngineSnapshot.hpp）恢复的字节数，冷启动时为 0
+    PhaseTimer Initialization;          // 最近一次初始化各阶段的耗时
+};
+
+class FrameStatsRecorder {
+public:
+    FrameStatsRecorder() { Reset(); }
+    void Draw(uint64_t vertices, uint64_t primitives)
+    {
+        m_current.Vertices += vertices;
+        m_current.Primitives += primitives;
+        m_current.DrawCalls++;
+    }
+    void StateChange(uint64_t count = 1) { m_current.StateChanges += count; }
+    void StateChangesSaved(uint64_t count) { m_current.StateChangesSaved += count; }
+    void Cull(uint64_t tested, uint64_t occluded)
+    {
+        m_current.OcclusionTested += tested;
+        m_current.Occluded += occluded;
+    }
+    void Lod(uint64_t switches, uint64_t verticesSaved)
+    {
+        m_current.LodSwitches += switches;
+        m_current.LodVerticesSaved += verticesSaved;
+    }
+    void Uniform(uint64_t bytes) { m_current.UniformBytes += bytes; }
+    void Buffer(uint64_t bytes) { m_current.BufferBytes += bytes; }
+    // 结束一帧：当前计数成为 LastFrame 并累加至 Total，随后清零。
+    void EndFrame()
+    {
+        m_stats.Frames++;
+        m_stats.LastFrame = m_current;
+        m_stats.Total.Vertices += m_current.Vertices;
+        m_stats.Total.Primitives += m_current.Primitives;
+        m_stats.Total.DrawCalls += m_current.DrawCalls;
+        m_stats.Total.StateChanges += m_current.StateChanges;
+        m_stats.Total.StateChangesSaved += m_current.StateChangesSaved;
+        m_stats.Total.OcclusionTested += m_current.OcclusionTested;
+        m_stats.Total.Occluded += m_current.Occluded;
+        m_stats.Total.LodSwitches += m_current.LodSwitches;
+        m_stats.Total.LodVerticesSaved += m_current.LodVerticesSaved;
+        m_stats.Total.UniformBytes += m_current.UniformBytes;
+        m_stats.Total.BufferBytes += m_current.BufferBytes;
+        Clear(m_current);
+    }
+    // MeshBytes、GLBytes、Stream、Scene、SnapshotBytes 与 Initialization 由引擎在查询时填写。
+    const VCCFrameStats& Stats() const { return m_stats; }
+    void Reset()
+    {
+        m_stats.Frames = 0;
+        Clear(m_stats.LastFrame);
+        Clear(m_stats.Total);
+        m_stats.MeshBytes = 0;
+        m_stats.GLBytes = 0;
+        m_stats.Stream = VertexStreamStats();
+        m_stats.Scene = StreamingStats();
+        m_stats.SnapshotBytes = 0;
+        m_stats.Initialization.Restart();
+        Clear(m_current);
+    }
+private:
+    static void Clear(VCCRenderCounters& counters)
+    {
+        counters.Vertices = 0;
+        counters.Primitives = 0;
+        counters.DrawCalls = 0;
+        counters.StateChanges = 0;
+        counters.StateChangesSaved = 0;
+        counters.OcclusionTested = 0;
+        counters.Occluded = 0;
+        counters.LodSwitches = 0;
+        counters.LodVerticesSaved = 0;
+        counters.UniformBytes = 0;
+        counters.BufferBytes = 0;
+    }
+    VCCRenderCounters m_current;
+    VCCFrameStats m_stats;
+};
+
+// 由绘制模式与顶点（索引）数求图元数。GL 常量按数值给出，本头文件因而无需包含 GL 头文件。
+inline uint64_t PrimitiveCount(unsigned int mode, uint64_t count)
+{
+    switch (mode) {
+        case 0x0000: return count;                          // GL_POINTS
+        case 0x0001: return count / 2;                      // GL_LINES
+        case 0x0002: return count;                          // GL_LINE_LOOP
+        case 0x0003: return count > 1 ? count - 1 : 0;      // GL_LINE_STRIP
+        case 0x0004: return count / 3;                      // GL_TRIANGLES
+        default: return count > 2 ? count - 2 : 0;          // GL_TRIANGLE_STRIP、GL_TRIANGLE_FAN
+    }
+}
+
+#endif /* FrameStats_hpp */
@@ -0,0 +1,107 @@
+//
+//  GLResource.cpp
+//  opengles2
+//
+
+#include "GLResource.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+static const char* const CategoryNames[GLResourceCategoryCount] = {
+    "renderbuffers", "framebuffers", "textures", "buffers", "programs",
+};
+
+GLResourceRegistry::GLResourceRegistry(const char* owner, size_t budgetBytes)
+    : m_owner(owner), m_budget(budgetBytes), m_overBudget(false)
+{
+    for (int i = 0; i < GLResourceCategoryCount; ++i)
+        m_bytes[i] = 0;
+}
+
+GLResourceRegistry::~GLResourceRegistry()
+{
+    ReportLeaks();
+}
+
+void GLResourceRegistry::SetBudget(size_t budgetBytes)
+{
+    m_budget = budgetBytes;
+    m_overBudget = false;
+}
+
+bool GLResourceRegistry::Fits(size_t bytes, size_t replacedBytes) const
+{
+    return !m_budget || TotalBytes() - replacedBytes + bytes <= m_budget;
+}
+
+void GLResourceRegistry::Created(GLResourceCategory category, unsigned int name, const char* label)
+{
+    Entry entry = { label, 0 };
+    m_objects[std::make_pair((int) category, name)] = entry;
+}
+
+void GLResourceRegistry::Resized(GLResourceCategory category, unsigned int name, size_t bytes)
+{
+    ObjectMap::iterator i = m_objects.find(std::make_pair((int) category, name));
+    if (i == m_objects.end())
+        return;
+    m_bytes[category] += bytes - i->second.Bytes;
+    i->second.Bytes = bytes;
+
+    size_t total = TotalBytes();
+    if (m_budget && total > m_budget && !m_overBudget) {
+        std::cout << m_owner << " GL memory " << total / 1024 << " KB exceeds the budget of " << m_budget / 1024
+                  << " KB after resizing " << i->second.Label << std::endl;
+        Print();
+    }
+    m_overBudget = m_budget && total > m_budget;
+}
+
+void GLResourceRegistry::Destroyed(GLResourceCategory category, unsigned int name)
+{
+    ObjectMap::iterator i = m_objects.find(std::make_pair((int) category, name));
+    if (i == m_objects.end())
+        return;
+    m_bytes[category] -= i->second.Bytes;
+    m_objects.erase(i);
+    m_overBudget = m_budget && TotalBytes() > m_budget;
+}
+
+size_t GLResourceRegistry::TotalBytes() const
+{
+    size_t total = 0;
+    for (int i = 0; i < GLResourceCategoryCount; ++i)
+        total += m_bytes[i];
+    return total;
+}
+
+void GLResourceRegistry::Print() const
+{
+    size_t counts[GLResourceCategoryCount] = {};
+    for (ObjectMap::const_iterator i = m_objects.begin(); i != m_objects.end(); ++i)
+        counts[i->first.first]++;
+    // 输出后恢复 std::cout 原有的数字格式。
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << m_owner << " GL memory: " << std::fixed << std::setprecision(1) << TotalBytes() / 1024.0 << " KB (";
+    for (int i = 0; i < GLResourceCategoryCount; ++i)
+        std::cout << (i ? ", " : "") << counts[i] << " " << CategoryNames[i] << " " << m_bytes[i] / 1024.0 << " KB";
+    std::cout << ")";
+    if (m_budget)
+        std::cout << ", budget " << m_budget / 1024 << " KB";
+    std::cout << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+size_t GLResourceRegistry::ReportLeaks() const
+{
+    if (m_objects.empty())
+        return 0;
+    std::cout << m_owner << " leaked " << m_objects.size() << " GL objects (" << TotalBytes() / 1024 << " KB):" << std::endl;
+    for (ObjectMap::const_iterator i = m_objects.begin(); i != m_objects.end(); ++i)
+        std::cout << "  " << CategoryNames[i->first.first] << " " << i->first.second << " " << i->second.Label
+                  << " " << i->second.Bytes << " bytes" << std::endl;
+    return m_objects.size();
+}
@@ -0,0 +1,119 @@
+//
+//  GLResource.hpp
+//  opengles2
+//
+//  GL 对象的所有权（GLHandle）与显存占用的估算、预算及泄漏报告（GLResourceRegistry）。
+//
+/*
+ 引擎以 GLHandle 持有自己创建的每一个 GL 对象：句柄析构或重新创建时删除原有的对象，引擎销毁时全部 GL 对象随之释放，
+ 无需在析构函数中逐一调用 glDelete*。两个引擎分别使用 ES 1.1 与 ES 2.0 的函数，本文件因而不包含任何 GL 头文件，
+ 由引擎为每类对象提供 Traits：
+   static const GLResourceCategory Category;
+   static GLuint Generate();           创建对象，只以 Adopt() 接管的对象（例如着色器程序）可以不提供
+   static void Delete(GLuint name);
+ 句柄可隐式转换为 GLuint，绑定、比较等原有写法保持不变。句柄与 GL 上下文无关，析构时调用者须保证创建它的上下文为当前上下文。
+
+ 每个句柄都登记在引擎的 GLResourceRegistry 中，分配存储之后以 SetBytes() 记录估算的字节数（渲染缓冲区与纹理按尺寸与像素格式，
+ 缓冲区按 glBufferData 的大小，着色器程序按源码长度近似）。registry 可设置预算：Fits() 供调用者在分配之前检查，
+ 总量超出预算时输出一次警告。registry 析构时若仍有对象登记在册，即逐一输出这些泄漏的对象，
+ 因此它必须声明在所有句柄之前，以便最后析构。
+ */
+
+#ifndef GLResource_hpp
+#define GLResource_hpp
+
+#include <stddef.h>
+#include <map>
+#include <utility>
+
+enum GLResourceCategory {
+    GLResourceRenderbuffer,
+    GLResourceFramebuffer,
+    GLResourceTexture,
+    GLResourceBuffer,
+    GLResourceProgram,
+    GLResourceCategoryCount,
+};
+
+class GLResourceRegistry {
+public:
+    // owner 出现在报告中，须为字符串常量；budgetBytes 为 0 时不限制。
+    explicit GLResourceRegistry(const char* owner, size_t budgetBytes = 0);
+    ~GLResourceRegistry();
+    void SetBudget(size_t budgetBytes);
+    size_t Budget() const { return m_budget; }
+    // 以 replacedBytes 的存储换取 bytes 的存储之后是否仍在预算之内。
+    bool Fits(size_t bytes, size_t replacedBytes = 0) const;
+    void Created(GLResourceCategory category, unsigned int name, const char* label);
+    void Resized(GLResourceCategory category, unsigned int name, size_t bytes);
+    void Destroyed(GLResourceCategory category, unsigned int name);
+    size_t Bytes(GLResourceCategory category) const { return m_bytes[category]; }
+    size_t TotalBytes() const;
+    size_t ObjectCount() const { return m_objects.size(); }
+    // 输出一行各类对象的数目与字节数，用于超出预算时的报告；平时的总量经引擎的 GetFrameStats() 查询。
+    void Print() const;
+    // 输出仍未删除的对象并返回其数目。
+    size_t ReportLeaks() const;
+private:
+    GLResourceRegistry(const GLResourceRegistry&);
+    GLResourceRegistry& operator=(const GLResourceRegistry&);
+    struct Entry {
+        const char* Label;
+        size_t Bytes;
+    };
+    typedef std::map<std::pair<int, unsigned int>, Entry> ObjectMap;
+    const char* m_owner;
+    size_t m_budget;
+    bool m_overBudget;                  // 已就本次超出预算输出过警告
+    size_t m_bytes[GLResourceCategoryCount];
+    ObjectMap m_objects;
+};
+
+template <typename Traits>
+class GLHandle {
+public:
+    GLHandle() : m_name(0), m_bytes(0), m_registry(0) {}
+    ~GLHandle() { Reset(); }
+    // 删除原有的对象（如有）并创建新的对象，label 须为字符串常量。
+    void Create(GLResourceRegistry& registry, const char* label)
+    {
+        Reset();
+        Adopt(registry, Traits::Generate(), label);
+    }
+    // 接管以其他方式创建的对象。
+    void Adopt(GLResourceRegistry& registry, unsigned int name, const char* label)
+    {
+        Reset();
+        m_name = name;
+        m_registry = &registry;
+        registry.Created(Traits::Category, name, label);
+    }
+    // 记录对象当前占用的估算字节数，与上次相同时不做任何事，可在每帧上传数据时调用。
+    void SetBytes(size_t bytes)
+    {
+        if (m_name && bytes != m_bytes) {
+            m_bytes = bytes;
+            m_registry->Resized(Traits::Category, m_name, bytes);
+        }
+    }
+    size_t Bytes() const { return m_bytes; }
+    void Reset()
+    {
+        if (!m_name)
+            return;
+        Traits::Delete(m_name);
+        m_registry->Destroyed(Traits::Category, m_name);
+        m_name = 0;
+        m_bytes = 0;
+    }
+    unsigned int Name() const { return m_name; }
+    operator unsigned int() const { return m_name; }
+private:
+    GLHandle(const GLHandle&);
+    GLHandle& operator=(const GLHandle&);
+    unsigned int m_name;
+    size_t m_bytes;
+    GLResourceRegistry* m_registry;
+};
+
+#endif /* GLResource_hpp */
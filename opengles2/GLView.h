@@ -7,6 +7,9 @@
 //
 #import <UIKit/UIKit.h>
 #import "VCCRenderingEngine.hpp"
+#import "InputTrace.hpp"
+#import "EngineCommandQueue.hpp"
+#import "Tracing.hpp"
 #import <OpenGLES/EAGL.h>//eagl 头文件并不是 OpenGL 标准中的一部分，但需要通过它创建 OpenGL ES 上下文环境
 #import <QuartzCore/QuartzCore.h>
 
@@ -17,11 +20,31 @@
     EAGLContext* m_context; //该对象负责对当前的 OpenGL 上下文进行管理；EAGL 表示一类小型的、特定于 Apple 的 API，并通过 OpenGL 与 iPhone 操作系统进行链接。
     
     VCCRenderingEngine* m_renderingEngine;
+    InputTraceRecorder* m_inputRecorder;   // 仅在 RecordInputTrace 开启时创建
+    // 方向变化、尺寸变化与载入网格均投递至该队列，由 drawView 在每帧开始时统一交给引擎；初始化完成之前投递的命令留在队列中。
+    EngineCommandQueue* m_commands;
+    int m_viewWidth;                        // 最近一次交给引擎的视图尺寸
+    int m_viewHeight;
+    BOOL m_resizePending;                   // 尺寸变化因队列已满未能投递，由 drawView 重试
+    BOOL m_rotatePending;                   // 方向变化因队列已满未能投递，由 drawView 重试 m_pendingOrientation
+    VCCDeviceOrientation m_pendingOrientation;
     
     float m_timestamp;
+    
+    // Prepare() 在后台线程完成后置位 m_enginePrepared，随后由 drawView 在渲染线程上调用 Finalize() 并置位 m_engineReady。
+    // 两者均只在主线程上读写。
+    BOOL m_enginePrepared;
+    BOOL m_engineReady;
+    double m_initStart;
+    unsigned m_placeholderFrames;
 }
 
 //当通过 OpenGL 函数调用改变当前的 API 的状态时，用户需要再某一特定的上下文中执行这一过程。针对于运行与系统中的某一线程，任何时候都仅存在一个当前上下文。而 iOS 应用程序一般很少出现多上下文的情况。考虑到移动设备上的有限资源，通常不推荐采用多上下文环境。
 - (void) drawView: (CADisplayLink*) displayLink;
 - (void) didRotate: (NSNotification*) notification;
+- (void) didEnterBackground: (NSNotification*) notification;
+- (void) finishInitialization;
+- (void) postResize;
+- (void) postRotate: (VCCDeviceOrientation) orientation;
+- (void) didApplyCommand: (const EngineCommand&) command succeeded: (BOOL) succeeded;
 @end
@@ -15,6 +15,22 @@
 //#import "VCCRenderingEngine.hpp"
 
 const bool ForceES1 = false;
+// 将引擎接收的输入序列录制至应用程序 Documents 目录下的 input.vcctrace，供 Tools/ReplayTrace 离线回放。
+const bool RecordInputTrace = false;
+// 录制期间每隔该数量的帧保存一次，应用程序被终止时最多丢失这些帧。
+const uint32_t InputTraceSaveInterval = 600;
+// 将 Initialize() 的计算结果保存至 Caches 目录下的快照，再次启动时直接从中恢复；快照过时时引擎会自动重新生成。
+const bool UseEngineSnapshot = true;
+// 大于 1 时以 CameraGridColumns × CameraGridRows 个摄像机平铺屏幕，从不同角度显示同一场景（参见 Camera.hpp）。
+const int CameraGridColumns = 1;
+const int CameraGridRows = 1;
+
+//引擎执行一条命令之后的回调，在 drawView 中调用，因而位于渲染线程上。
+static void ApplyCommandCallback(const EngineCommand& command, bool succeeded, void* context)
+{
+    [(__bridge GLView*) context didApplyCommand:command succeeded:succeeded];
+}
+
 @implementation GLView
 
 //+ 前缀表明，这将是一个覆写类方法而非实例化方法。另外，覆写类型是 Objective-C 语言独有的特性，该特性一般不会出现于其他语言中。
@@ -67,7 +83,28 @@ const bool ForceES1 = false;
         //    glBindRenderbufferOES(GL_RENDERBUFFER_OES, renderbuffer);
         [m_context renderbufferStorage:GL_RENDERBUFFER_OES fromDrawable: eaglLayer];
         //引擎里封装下面的东西
-        m_renderingEngine->Initialize(CGRectGetWidth(frame), CGRectGetHeight(frame));
+        if (UseEngineSnapshot) {
+            NSString* caches = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+            NSString* name = api == kEAGLRenderingAPIOpenGLES1 ? @"engine1.vccsnapshot" : @"engine2.vccsnapshot";
+            m_renderingEngine->SetSnapshotPath([[caches stringByAppendingPathComponent:name] UTF8String]);
+        }
+        m_inputRecorder = RecordInputTrace ? new InputTraceRecorder(CGRectGetWidth(frame), CGRectGetHeight(frame)) : 0;
+        m_commands = new EngineCommandQueue();
+        m_viewWidth = CGRectGetWidth(frame);
+        m_viewHeight = CGRectGetHeight(frame);
+        //初始化中不需要 GL 上下文的部分（快照恢复或几何生成）在后台线程执行，期间 drawView 显示占位画面；
+        //完成后回到主线程，由下一次 drawView 调用 finishInitialization 完成 GL 资源的创建。
+        m_initStart = CACurrentMediaTime();
+        VCC_TRACE_THREAD_NAME("Main");
+        VCCRenderingEngine* engine = m_renderingEngine;
+        int width = CGRectGetWidth(frame);
+        int height = CGRectGetHeight(frame);
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            engine->Prepare(width, height);
+            dispatch_async(dispatch_get_main_queue(), ^{
+                m_enginePrepared = YES;
+            });
+        });
         //        glFramebufferRenderbufferOES(GL_FRAMEBUFFER_OES, GL_COLOR_ATTACHMENT0_OES, GL_RENDERBUFFER_OES, renderbuffer);
         //        glViewport(0, 0, CGRectGetWidth(frame), CGRectGetHeight(frame));
         [self drawView: nil];
@@ -78,6 +115,8 @@ const bool ForceES1 = false;
         [displayLink addToRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
         [[UIDevice currentDevice] beginGeneratingDeviceOrientationNotifications];
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didRotate:) name:UIDeviceOrientationDidChangeNotification object:nil];
+        if (UseEngineSnapshot || VCC_ENABLE_TRACING)
+            [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didEnterBackground:) name:UIApplicationDidEnterBackgroundNotification object:nil];
     }
     return self;
 }
@@ -87,12 +126,40 @@ const bool ForceES1 = false;
 //drawView 方法用于回应显示链接事件，且计算距最后一次调用所经历的时间，并将该值传递至渲染器的 UpdateAnimation 方法中，这将有助于渲染器实现动画的更新以及物理控制。
 //drawView 方法发布渲染命令，并将渲染缓冲区中的相关内容发送至屏幕中
 - (void) drawView:(CADisplayLink*) displayLink{
+    VCC_TRACE_SCOPE("Frame");
+    if (!m_engineReady) {
+        if (!m_enginePrepared) {
+            //初始化期间的时间不计入动画。
+            if (displayLink != nil)
+                m_timestamp = displayLink.timestamp;
+            m_renderingEngine->RenderPlaceholder();
+            m_placeholderFrames++;
+            [m_context presentRenderbuffer:GL_RENDERBUFFER_OES];
+            return;
+        }
+        [self finishInitialization];
+        if (displayLink != nil)
+            m_timestamp = displayLink.timestamp;
+    }
+    //其他线程投递的命令在每帧开始、更新动画之前执行，新的旋转动画因而从本帧开始。
+    if (m_resizePending)
+        [self postResize];
+    if (m_rotatePending && m_commands->PostRotate(m_pendingOrientation))
+        m_rotatePending = NO;
+    m_commands->Drain(*m_renderingEngine, ApplyCommandCallback, (__bridge void*) self);
     if (displayLink != nil) {
         float elapsedSeconds = displayLink.timestamp - m_timestamp;
         m_timestamp = displayLink.timestamp;
         m_renderingEngine->UpdateAnimation(elapsedSeconds);
+        if (m_inputRecorder)
+            m_inputRecorder->RecordUpdate(elapsedSeconds);
     }
     m_renderingEngine->Render();
+    if (m_inputRecorder) {
+        m_inputRecorder->RecordRender();
+        if (m_inputRecorder->FrameCount() % InputTraceSaveInterval == 0)
+            [self saveInputTrace];
+    }
 //    下面的放到render里
 //    glClearColor(1.0f, 0.5f, 0.5f, 1.0f);
 //    glClear(GL_COLOR_BUFFER_BIT);
@@ -100,11 +167,125 @@ const bool ForceES1 = false;
 }
 
 
-//didRotate 事件句柄则将特定于 iPhone 平台的 UIDeviceOrientation 发送至 DeviceOrientation 类型的结构中，并于随后将其传递至渲染引擎中
+//在渲染线程上完成初始化：创建 GL 资源并投递载入网格的命令，初始化期间投递的方向变化随后与之一同在 drawView 中执行。
+- (void) finishInitialization{
+    m_renderingEngine->Finalize();
+    if (CameraGridColumns * CameraGridRows > 1) {
+        std::vector<Camera> cameras;
+        TileCameras(CameraGridColumns, CameraGridRows, 7, mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10), cameras);
+        m_renderingEngine->SetCameras(&cameras[0], cameras.size());
+    }
+    //若应用程序包中附带了 Scene.vccmesh 网格文件，则以其替代程序化生成的椎体。
+    NSString* meshPath = [[NSBundle mainBundle] pathForResource:@"Scene" ofType:@"vccmesh"];
+    if (meshPath != nil && !m_commands->PostLoadMesh([meshPath UTF8String])) {
+        NSLog(@"Failed to queue %@", meshPath);
+    }
+    m_engineReady = YES;
+    NSLog(@"First frame after %.1f ms (%u placeholder frames)", (CACurrentMediaTime() - m_initStart) * 1000, m_placeholderFrames);
+}
+
+- (void) didApplyCommand:(const EngineCommand&)command succeeded:(BOOL)succeeded{
+    switch (command.Type) {
+        case EngineCommandRotate:
+            if (m_inputRecorder)
+                m_inputRecorder->RecordRotate(command.Orientation);
+            break;
+        case EngineCommandResize:
+            //引擎在 Resize() 返回时绑定了颜色渲染缓冲区，按图层的新尺寸重新分配其存储。
+            [m_context renderbufferStorage:GL_RENDERBUFFER_OES fromDrawable:(CAEAGLLayer*) self.layer];
+            if (m_inputRecorder)
+                m_inputRecorder->RecordResize(command.Width, command.Height);
+            break;
+        case EngineCommandLoadMesh:
+            //载入失败时引擎保留原有的网格，回放时无需重现。
+            if (!succeeded)
+                NSLog(@"Failed to load %s", command.Path);
+            else if (m_inputRecorder)
+                m_inputRecorder->RecordLoadMesh(command.Path);
+            break;
+    }
+}
+
+//didRotate 事件句柄则将特定于 iPhone 平台的 UIDeviceOrientation 发送至 DeviceOrientation 类型的结构中，并投递至命令队列，
+//由下一帧的 drawView 交给渲染引擎；这里从不等待渲染线程。
 - (void) didRotate:(NSNotification *)notification{
     UIDeviceOrientation orientation = [[UIDevice currentDevice] orientation];
-    m_renderingEngine->OnRotate((VCCDeviceOrientation) orientation);
-    [self drawView:nil];
+    [self postRotate:(VCCDeviceOrientation) orientation];
+}
+
+//投递方向变化；队列已满时记下该方向，由之后每一帧的 drawView 重试。重试期间到来的方向直接取代记下的方向而不另行投递，
+//最后一次方向变化因此总是最后交给引擎。
+- (void) postRotate:(VCCDeviceOrientation)orientation{
+    if (!m_rotatePending && m_commands->PostRotate(orientation))
+        return;
+    if (!m_rotatePending)
+        NSLog(@"Engine command queue is full, retrying orientation %d", (int) orientation);
+    m_pendingOrientation = orientation;
+    m_rotatePending = YES;
+}
+
+//视图尺寸变化时（例如分屏多任务）投递尺寸变化命令，颜色渲染缓冲区随引擎的其他存储一同在 drawView 中重新分配。
+- (void) layoutSubviews{
+    [super layoutSubviews];
+    [self postResize];
+}
+
+//投递视图的当前尺寸；队列已满时置位 m_resizePending，由之后每一帧的 drawView 重试，直至投递成功。
+- (void) postResize{
+    int width = CGRectGetWidth(self.bounds);
+    int height = CGRectGetHeight(self.bounds);
+    if (width == m_viewWidth && height == m_viewHeight) {
+        m_resizePending = NO;
+        return;
+    }
+    if (m_commands->PostResize(width, height)) {
+        m_viewWidth = width;
+        m_viewHeight = height;
+        m_resizePending = NO;
+    } else if (!m_resizePending) {
+        NSLog(@"Engine command queue is full, retrying resize to %dx%d", width, height);
+        m_resizePending = YES;
+    }
+}
+
+//触摸时在 CPU 上以射线拾取被触摸的物体，无需读回帧缓冲区而使 GPU 管线停顿。
+- (void) touchesBegan:(NSSet<UITouch*>*)touches withEvent:(UIEvent*)event{
+    if (!m_engineReady)
+        return;
+    CGPoint location = [[touches anyObject] locationInView:self];
+    int object;
+    float distance;
+    if (m_renderingEngine->Pick(location.x, location.y, object, distance))
+        NSLog(@"Picked object %d at distance %.3f", object, distance);
+}
+
+//进入后台时更新快照，下次启动时恢复当前的动画状态。
+//以 VCC_ENABLE_TRACING=1 编译时同时将时间线导出至 Documents 目录下的 timeline.json，可在 chrome://tracing 或 ui.perfetto.dev 中打开。
+- (void) didEnterBackground:(NSNotification *)notification{
+    //初始化尚未完成时引擎状态不完整，不覆盖已有的快照。
+    if (UseEngineSnapshot && m_engineReady && !m_renderingEngine->SaveSnapshot())
+        NSLog(@"Failed to save engine snapshot");
+    if (VCC_ENABLE_TRACING) {
+        NSString* documents = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) firstObject];
+        Tracing::WriteChromeTrace([[documents stringByAppendingPathComponent:@"timeline.json"] UTF8String]);
+    }
+}
+
+//引擎析构时删除其全部 GL 对象并报告遗漏的对象，须以创建这些对象的上下文为当前上下文。
+- (void) dealloc{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [EAGLContext setCurrentContext:m_context];
+    delete m_renderingEngine;
+    delete m_inputRecorder;
+    delete m_commands;
+    [EAGLContext setCurrentContext:nil];
+}
+
+- (void) saveInputTrace{
+    NSString* documents = [NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES) firstObject];
+    NSString* path = [documents stringByAppendingPathComponent:@"input.vcctrace"];
+    if (!m_inputRecorder->Save([path UTF8String]))
+        NSLog(@"Failed to save %@", path);
 }
 
 @end
@@ -0,0 +1,172 @@
+//
+//  InputTrace.cpp
+//  opengles2
+//
+
+#include "InputTrace.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+InputTraceRecorder::InputTraceRecorder(int width, int height) : m_width(width), m_height(height), m_eventCount(0), m_frameCount(0)
+{
+}
+
+void InputTraceRecorder::RecordUpdate(float timeStep)
+{
+    uint8_t bytes[1 + sizeof(float)];
+    bytes[0] = InputEventUpdate;
+    memcpy(bytes + 1, &timeStep, sizeof(float));
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(bytes));
+    m_eventCount++;
+}
+
+void InputTraceRecorder::RecordRotate(VCCDeviceOrientation orientation)
+{
+    m_data.push_back(InputEventRotate);
+    m_data.push_back((uint8_t) orientation);
+    m_eventCount++;
+}
+
+void InputTraceRecorder::RecordRender()
+{
+    m_data.push_back(InputEventRender);
+    m_eventCount++;
+    m_frameCount++;
+}
+
+void InputTraceRecorder::RecordResize(int width, int height)
+{
+    uint8_t bytes[1 + 2 * sizeof(int32_t)];
+    int32_t size[2] = { width, height };
+    bytes[0] = InputEventResize;
+    memcpy(bytes + 1, size, sizeof(size));
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(bytes));
+    m_eventCount++;
+}
+
+void InputTraceRecorder::RecordLoadMesh(const char* path)
+{
+    uint16_t length = (uint16_t) std::min<size_t>(strlen(path), UINT16_MAX);
+    uint8_t bytes[1 + sizeof(uint16_t)];
+    bytes[0] = InputEventLoadMesh;
+    memcpy(bytes + 1, &length, sizeof(length));
+    m_data.insert(m_data.end(), bytes, bytes + sizeof(bytes));
+    m_data.insert(m_data.end(), path, path + length);
+    m_eventCount++;
+}
+
+bool InputTraceRecorder::Save(const char* path) const
+{
+    InputTraceHeader header;
+    header.Magic = InputTraceMagic;
+    header.Version = InputTraceVersion;
+    header.Width = m_width;
+    header.Height = m_height;
+    header.EventCount = m_eventCount;
+    header.DataSize = (uint32_t) m_data.size();
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        std::cout << "Unable to create input trace " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && (m_data.empty() || fwrite(&m_data[0], 1, m_data.size(), file) == m_data.size());
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+        std::cout << "Failed writing input trace " << path << std::endl;
+    return ok;
+}
+
+static uint16_t StoredPathLength(const uint8_t* bytes)
+{
+    uint16_t length;
+    memcpy(&length, bytes, sizeof(length));
+    return length;
+}
+
+bool LoadInputTrace(const char* path, InputTrace& trace)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        std::cout << "Unable to open input trace " << path << std::endl;
+        return false;
+    }
+    InputTraceHeader header;
+    std::vector<uint8_t> data;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1
+           && header.Magic == InputTraceMagic && header.Version >= 1 && header.Version <= InputTraceVersion;
+    if (ok) {
+        data.resize(header.DataSize);
+        ok = data.empty() || fread(&data[0], 1, data.size(), file) == data.size();
+    }
+    fclose(file);
+    if (!ok) {
+        std::cout << "Invalid input trace " << path << std::endl;
+        return false;
+    }
+
+    trace.Width = header.Width;
+    trace.Height = header.Height;
+    trace.Events.clear();
+    trace.Events.reserve(header.EventCount);
+    size_t offset = 0;
+    while (offset < data.size()) {
+        InputEvent event;
+        event.Type = (InputEventType) data[offset++];
+        event.TimeStep = 0;
+        event.Orientation = VCCDeviceOrientationUnknown;
+        event.Width = 0;
+        event.Height = 0;
+        if (event.Type == InputEventUpdate && offset + sizeof(float) <= data.size()) {
+            memcpy(&event.TimeStep, &data[offset], sizeof(float));
+            offset += sizeof(float);
+        } else if (event.Type == InputEventRotate && offset < data.size() && data[offset] <= VCCDeviceOrientationFaceDown) {
+            event.Orientation = (VCCDeviceOrientation) data[offset++];
+        } else if (event.Type == InputEventResize && offset + 2 * sizeof(int32_t) <= data.size()) {
+            int32_t size[2];
+            memcpy(size, &data[offset], sizeof(size));
+            offset += sizeof(size);
+            event.Width = size[0];
+            event.Height = size[1];
+        } else if (event.Type == InputEventLoadMesh && offset + sizeof(uint16_t) <= data.size()
+                   && offset + sizeof(uint16_t) + StoredPathLength(&data[offset]) <= data.size()) {
+            uint16_t length = StoredPathLength(&data[offset]);
+            offset += sizeof(uint16_t);
+            event.Path.assign((const char*) &data[offset], length);
+            offset += length;
+        } else if (event.Type != InputEventRender) {
+            std::cout << "Corrupt event at offset " << offset - 1 << " in input trace " << path << std::endl;
+            return false;
+        }
+        trace.Events.push_back(event);
+    }
+    if (trace.Events.size() != header.EventCount) {
+        std::cout << "Input trace " << path << " is truncated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ApplyInputEvent(VCCRenderingEngine* engine, const InputEvent& event)
+{
+    switch (event.Type) {
+        case InputEventUpdate:
+            engine->UpdateAnimation(event.TimeStep);
+            break;
+        case InputEventRotate:
+            engine->OnRotate(event.Orientation);
+            break;
+        case InputEventRender:
+            engine->Render();
+            break;
+        case InputEventResize:
+            engine->Resize(event.Width, event.Height);
+            break;
+        case InputEventLoadMesh:
+            engine->LoadMesh(event.Path.c_str());
+            break;
+    }
+}
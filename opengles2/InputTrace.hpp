@@ -0,0 +1,87 @@
+//
+//  InputTrace.hpp
+//  opengles2
+//
+//  记录并回放 GLView 交给渲染引擎的输入序列（.vcctrace）。
+//
+/*
+ GLView 对引擎的输入包括：显示链接触发的 UpdateAnimation(timeStep)、随后的 Render()，以及经命令队列交给引擎的
+ OnRotate(orientation)、Resize(width, height) 与 LoadMesh(path)。InputTraceRecorder 按调用顺序将其逐条追加为紧凑的二进制事件：
+   InputEventUpdate     1 字节类型 + 4 字节浮点时间步长
+   InputEventRotate     1 字节类型 + 1 字节设备方向
+   InputEventRender     1 字节类型
+   InputEventResize     1 字节类型 + 4 字节宽度 + 4 字节高度
+   InputEventLoadMesh   1 字节类型 + 2 字节路径长度 + 路径（不含结尾的 0）
+ 每秒 60 帧时约为 360 字节/秒。只记录成功载入的网格：载入失败时引擎保留原有的网格，回放时无需重现。
+ 路径为设备上的绝对路径，离线回放时通常须以其他路径替代（参见 Tools/ReplayTrace.cpp 的 --mesh）。
+ 版本 1 的文件不含尺寸变化与载入网格事件，仍可读取。文件由 InputTraceHeader 与其后的事件流组成，采用本机字节序（小端）。
+ 回放时依次对任意 VCCRenderingEngine 调用 ApplyInputEvent()，即可以真实用户的旋转与帧间隔重现引擎的行为，参见 Tools/ReplayTrace.cpp。
+ */
+
+#ifndef InputTrace_hpp
+#define InputTrace_hpp
+
+#include "VCCRenderingEngine.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+static const uint32_t InputTraceMagic = 0x54434356; // "VCCT"
+static const uint32_t InputTraceVersion = 2;
+
+enum InputEventType {
+    InputEventUpdate = 1,
+    InputEventRotate,
+    InputEventRender,
+    InputEventResize,
+    InputEventLoadMesh,
+};
+
+struct InputTraceHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t Width;             // 传给 Initialize() 的尺寸
+    uint32_t Height;
+    uint32_t EventCount;
+    uint32_t DataSize;          // 其后事件流的字节数
+};
+
+struct InputEvent {
+    InputEventType Type;
+    float TimeStep;
+    VCCDeviceOrientation Orientation;
+    int Width;                  // InputEventResize
+    int Height;
+    std::string Path;           // InputEventLoadMesh
+};
+
+class InputTraceRecorder {
+public:
+    InputTraceRecorder(int width, int height);
+    void RecordUpdate(float timeStep);
+    void RecordRotate(VCCDeviceOrientation orientation);
+    void RecordRender();
+    void RecordResize(int width, int height);
+    void RecordLoadMesh(const char* path);
+    uint32_t EventCount() const { return m_eventCount; }
+    uint32_t FrameCount() const { return m_frameCount; }
+    bool Save(const char* path) const;
+private:
+    int m_width;
+    int m_height;
+    uint32_t m_eventCount;
+    uint32_t m_frameCount;      // Render 事件的数目
+    std::vector<uint8_t> m_data;
+};
+
+struct InputTrace {
+    int Width;
+    int Height;
+    std::vector<InputEvent> Events;
+};
+
+// 读取并校验整个事件流，格式错误时返回 false。
+bool LoadInputTrace(const char* path, InputTrace& trace);
+void ApplyInputEvent(VCCRenderingEngine* engine, const InputEvent& event);
+
+#endif /* InputTrace_hpp */
@@ -0,0 +1,180 @@
+//
+//  JobSystem.cpp
+//  opengles2
+//
+
+#include "JobSystem.hpp"
+#include "Tracing.hpp"
+#include <algorithm>
+#include <string>
+
+struct Job {
+    JobFunction Function;
+    JobCounter* Counter;
+};
+
+JobSystem::JobSystem(unsigned threadCount) : m_queued(0), m_stopping(false)
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threadCount; ++i)
+        m_queues.push_back(new WorkQueue);
+    m_threadIds.push_back(std::this_thread::get_id());
+    for (unsigned i = 1; i < threadCount; ++i)
+        m_threads.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+    for (size_t i = 0; i < m_threads.size(); ++i)
+        m_threadIds.push_back(m_threads[i].get_id());
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_threads.size(); ++i)
+        m_threads[i].join();
+    for (size_t i = 0; i < m_queues.size(); ++i)
+        delete m_queues[i];
+}
+
+// 线程数很少，线性查找即可，从而无需依赖线程局部存储。
+unsigned JobSystem::CurrentWorker() const
+{
+    std::thread::id id = std::this_thread::get_id();
+    for (size_t i = 1; i < m_threadIds.size(); ++i)
+        if (m_threadIds[i] == id)
+            return (unsigned) i;
+    return 0;
+}
+
+void JobSystem::Run(const JobFunction& function, JobCounter* counter, JobCounter* dependency)
+{
+    Job* job = new Job;
+    job->Function = function;
+    job->Counter = counter;
+    if (counter)
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (dependency) {
+        // 与 Execute() 中计数器归零的过程互斥，保证任务要么被挂起后由其释放，要么在此直接提交。
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        if (dependency->m_pending.load(std::memory_order_acquire) != 0) {
+            dependency->m_waiting.push_back(job);
+            return;
+        }
+    }
+    Enqueue(job);
+}
+
+void JobSystem::Enqueue(Job* job)
+{
+    WorkQueue* queue = m_queues[CurrentWorker()];
+    {
+        std::lock_guard<std::mutex> lock(queue->Mutex);
+        queue->Jobs.push_back(job);
+    }
+    m_queued.fetch_add(1);
+    // 短暂持有休眠锁，避免工作线程在检查条件与进入等待之间错过通知。
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wake.notify_one();
+}
+
+Job* JobSystem::Pop(unsigned worker)
+{
+    WorkQueue* queue = m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue->Mutex);
+    if (queue->Jobs.empty())
+        return 0;
+    Job* job = queue->Jobs.back();
+    queue->Jobs.pop_back();
+    m_queued.fetch_sub(1);
+    return job;
+}
+
+Job* JobSystem::Steal(unsigned thief)
+{
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        WorkQueue* queue = m_queues[(thief + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue->Mutex);
+        if (queue->Jobs.empty())
+            continue;
+        Job* job = queue->Jobs.front();
+        queue->Jobs.pop_front();
+        m_queued.fetch_sub(1);
+        return job;
+    }
+    return 0;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->Function();
+    JobCounter* counter = job->Counter;
+    delete job;
+    if (!counter)
+        return;
+
+    std::vector<Job*> released;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            released.swap(counter->m_waiting);
+    }
+    for (size_t i = 0; i < released.size(); ++i)
+        Enqueue(released[i]);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    unsigned worker = CurrentWorker();
+    while (!counter.IsDone()) {
+        Job* job = Pop(worker);
+        if (!job)
+            job = Steal(worker);
+        if (job)
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+    // 确保最后一个任务已释放计数器的锁，此后调用者即可销毁计数器。
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+void JobSystem::WorkerMain(unsigned worker)
+{
+    VCC_TRACE_THREAD_NAME(("JobSystem worker " + std::to_string(worker)).c_str());
+    for (;;) {
+        Job* job = Pop(worker);
+        if (!job)
+            job = Steal(worker);
+        if (job) {
+            Execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+        if (m_stopping && m_queued.load() == 0)
+            return;
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+    grain = std::max<size_t>(1, grain);
+    if (count <= grain || m_queues.size() == 1) {
+        if (count)
+            body(0, count);
+        return;
+    }
+    // 最后一个区间由调用线程直接执行。
+    JobCounter counter;
+    size_t last = (count - 1) / grain * grain;
+    for (size_t begin = 0; begin < last; begin += grain) {
+        size_t end = begin + grain;
+        Run([&body, begin, end]() { body(begin, end); }, &counter);
+    }
+    body(last, count);
+    Wait(counter);
+}
@@ -0,0 +1,78 @@
+//
+//  JobSystem.hpp
+//  opengles2
+//
+//  由渲染引擎持有的任务调度器：每个工作线程拥有一个双端队列，空闲时从其他线程的队列中窃取任务。
+//
+/*
+ 任务以 JobCounter 计数器追踪完成情况：Run() 提交任务时计数器加 1，任务执行完毕后减 1，计数器归零即表示该组任务全部完成。
+ 计数器由调用者持有（通常位于栈上或作为成员变量），其生命周期必须覆盖对应的全部任务。
+ 依赖关系同样以计数器表达：Run(job, counter, dependency) 提交的任务在 dependency 归零之前不会进入任何队列。
+ Wait() 在等待期间执行其他任务而非阻塞，因此任务内部也可以提交并等待子任务；ParallelFor() 即建立在 Run() 与 Wait() 之上。
+ 工作线程从自身队列的尾部取出任务（后进先出，缓存较热），窃取时则从其他队列的头部取出（先进先出，通常是较大的任务）。
+ 构造 JobSystem 的线程即为 0 号工作线程，只在 Wait() 中参与执行任务；threadCount 为包括该线程在内的线程总数，0 表示与 CPU 核心数相同。
+ 其他线程（例如在后台执行 Prepare() 的初始化线程）调用 Run() 与 Wait() 时同样被视为 0 号工作线程；各队列均由互斥量保护，这样做是安全的。
+ */
+
+#ifndef JobSystem_hpp
+#define JobSystem_hpp
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef std::function<void()> JobFunction;
+
+struct Job;
+
+class JobCounter {
+public:
+    JobCounter() : m_pending(0) {}
+    bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+private:
+    friend class JobSystem;
+    JobCounter(const JobCounter&);
+    JobCounter& operator=(const JobCounter&);
+    std::atomic<int> m_pending;
+    std::mutex m_mutex;
+    std::vector<Job*> m_waiting;    // 依赖于该计数器、尚未提交至队列的任务
+};
+
+class JobSystem {
+public:
+    explicit JobSystem(unsigned threadCount = 0);
+    ~JobSystem();
+    unsigned ThreadCount() const { return (unsigned) m_queues.size(); }
+    void Run(const JobFunction& function, JobCounter* counter = 0, JobCounter* dependency = 0);
+    // 等待 counter 归零，其间执行队列中的其他任务。
+    void Wait(JobCounter& counter);
+    // 将 [0, count) 划分为长度不超过 grain 的区间并行执行 body(begin, end)，全部完成后返回。
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+private:
+    struct WorkQueue {
+        std::mutex Mutex;
+        std::deque<Job*> Jobs;
+    };
+    JobSystem(const JobSystem&);
+    JobSystem& operator=(const JobSystem&);
+    void Enqueue(Job* job);
+    Job* Pop(unsigned worker);
+    Job* Steal(unsigned thief);
+    void Execute(Job* job);
+    void WorkerMain(unsigned worker);
+    unsigned CurrentWorker() const;
+    std::vector<WorkQueue*> m_queues;
+    std::vector<std::thread> m_threads;
+    std::vector<std::thread::id> m_threadIds;     // 下标即工作线程编号
+    std::atomic<int> m_queued;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    bool m_stopping;
+};
+
+#endif /* JobSystem_hpp */
@@ -0,0 +1,47 @@
+//
+//  LevelOfDetail.cpp
+//  opengles2
+//
+
+#include "LevelOfDetail.hpp"
+#include <cfloat>
+#include <cmath>
+
+float ProjectedRadius(const vec3& center, float radius, const mat4& modelview, const mat4& projection, int viewportHeight)
+{
+    // 行向量约定下，视图坐标的 z 分量由 Modelview 的第三列给出，观察方向为 -Z。
+    const mat4& m = modelview;
+    float distance = -(center.x * m.x.z + center.y * m.y.z + center.z * m.z.z + m.w.z);
+    if (distance <= radius)
+        return FLT_MAX;
+    // projection.y.y 即 2 * near / (top - bottom)，将视图空间的尺寸换算至 NDC，再乘以半个视口高度换算至像素。
+    return radius * projection.y.y / distance * viewportHeight / 2;
+}
+
+LodSelector::LodSelector(const int* slices, int levelCount, float maxError, float hysteresis) : m_hysteresis(hysteresis)
+{
+    // 第 0 级没有上限，任何尺寸的物体都可使用。
+    for (int level = 0; level < levelCount; ++level) {
+        float deviation = 1 - std::cos(Pi / slices[level]);
+        m_thresholds.push_back(level == 0 ? FLT_MAX : maxError / deviation);
+    }
+}
+
+int LodSelector::IdealLevel(float projectedRadius) const
+{
+    int level = 0;
+    while (level + 1 < LevelCount() && projectedRadius <= m_thresholds[level + 1])
+        level++;
+    return level;
+}
+
+int LodSelector::Select(float projectedRadius, int currentLevel) const
+{
+    if (currentLevel < 0 || currentLevel >= LevelCount())
+        return IdealLevel(projectedRadius);
+    float upper = currentLevel == 0 ? FLT_MAX : m_thresholds[currentLevel] * (1 + m_hysteresis);
+    float lower = currentLevel + 1 < LevelCount() ? m_thresholds[currentLevel + 1] * (1 - m_hysteresis) : 0;
+    if (projectedRadius <= upper && projectedRadius >= lower)
+        return currentLevel;
+    return IdealLevel(projectedRadius);
+}
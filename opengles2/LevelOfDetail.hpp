@@ -0,0 +1,46 @@
+//
+//  LevelOfDetail.hpp
+//  opengles2
+//
+//  依据屏幕空间尺寸选择椎体的细节层次（LOD）。
+//
+/*
+ LOD 链由若干片段数递减的椎体与底盘组成（LodSlices），第 0 级即为 ConeSlices 的完整网格。
+ 以 n 边形近似半径为 r 像素的圆周时，最大偏差为 r * (1 - cos(π / n)) 像素；
+ LodSelector 据此为每一级求出允许的最大屏幕半径，使偏差不超过 maxError 像素，并选择满足该条件的最粗糙的一级。
+ 为避免物体尺寸在阈值附近变化时反复切换（popping），当前级别在 [下一级阈值 * (1 - hysteresis), 本级阈值 * (1 + hysteresis)]
+ 的范围内保持不变，超出该范围时才切换至理想级别。
+ 屏幕尺寸以包围球的投影半径度量，由 ProjectedRadius() 根据 Modelview 与投影矩阵求出。
+ */
+
+#ifndef LevelOfDetail_hpp
+#define LevelOfDetail_hpp
+
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include <stdint.h>
+#include <vector>
+
+static const int LodLevelCount = 4;
+static const int LodSlices[LodLevelCount] = { ConeSlices, 20, 10, 6 };
+
+// 各级别的选择结果由引擎计入 VCCRenderCounters 的 LodSwitches 与 LodVerticesSaved（参见 FrameStats.hpp）。
+
+// 包围球在视口中的投影半径（像素）。包围球与近平面相交或位于观察者身后时返回一个极大值，即选择最精细的级别。
+float ProjectedRadius(const vec3& center, float radius, const mat4& modelview, const mat4& projection, int viewportHeight);
+
+class LodSelector {
+public:
+    LodSelector(const int* slices = LodSlices, int levelCount = LodLevelCount, float maxError = 0.5f, float hysteresis = 0.15f);
+    // 根据投影半径与当前级别返回本帧应使用的级别。
+    int Select(float projectedRadius, int currentLevel) const;
+    int LevelCount() const { return (int) m_thresholds.size(); }
+    // 第 level 级所允许的最大投影半径。
+    float Threshold(int level) const { return m_thresholds[level]; }
+private:
+    int IdealLevel(float projectedRadius) const;
+    std::vector<float> m_thresholds;
+    float m_hysteresis;
+};
+
+#endif /* LevelOfDetail_hpp */
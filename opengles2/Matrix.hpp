@@ -13,8 +13,8 @@ struct Matrix2 {
         x.x = m[0]; x.y = m[1];
         y.x = m[2]; y.y = m[3];
     }
-    vec2 x;
-    vec2 y;
+    Vector2<T> x;
+    Vector2<T> y;
 };
 
 template <typename T>
@@ -43,9 +43,9 @@ struct Matrix3 {
     {
         return &x.x;
     }
-    vec3 x;
-    vec3 y;
-    vec3 z;
+    Vector3<T> x;
+    Vector3<T> y;
+    Vector3<T> z;
 };
 
 template <typename T>
@@ -71,6 +71,9 @@ struct Matrix4 {
         z.x = m[8];  z.y = m[9];  z.z = m[10]; z.w = m[11];
         w.x = m[12]; w.y = m[13]; w.z = m[14]; w.w = m[15];
     }
+    // 不同分量类型之间的显式转换，例如以 double 组合远离原点的变换、减去摄像机位置后转换为 float 提交。
+    template <typename U>
+    explicit Matrix4(const Matrix4<U>& m) : x(m.x), y(m.y), z(m.z), w(m.w) {}
     Matrix4 operator * (const Matrix4& b) const
     {
         Matrix4 m;
@@ -142,20 +145,22 @@ struct Matrix4 {
     }
     static Matrix4<T> Rotate(T degrees)
     {
-        T radians = degrees * 3.14159f / 180.0f;
-        T s = std::sin(radians);
-        T c = std::cos(radians);
+        VCC_SCALAR_MATH;
+        T radians = degrees * ScalarPi<T>() / 180;
+        T s = sin(radians);
+        T c = cos(radians);
         
         Matrix4 m = Identity();
         m.x.x =  c; m.x.y = s;
         m.y.x = -s; m.y.y = c;
         return m;
     }
-    static Matrix4<T> Rotate(T degrees, const vec3& axis)
+    static Matrix4<T> Rotate(T degrees, const Vector3<T>& axis)
     {
-        T radians = degrees * 3.14159f / 180.0f;
-        T s = std::sin(radians);
-        T c = std::cos(radians);
+        VCC_SCALAR_MATH;
+        T radians = degrees * ScalarPi<T>() / 180;
+        T s = sin(radians);
+        T c = cos(radians);
         
         Matrix4 m = Identity();
         m.x.x = c + (1 - c) * axis.x * axis.x;
@@ -184,12 +189,16 @@ struct Matrix4 {
         m.w.x = 0; m.w.y = 0; m.w.z = f; m.w.w = 1;
         return m;
     }
-    vec4 x;
-    vec4 y;
-    vec4 z;
-    vec4 w;
+    Vector4<T> x;
+    Vector4<T> y;
+    Vector4<T> z;
+    Vector4<T> w;
 };
 
 typedef Matrix2<float> mat2;
 typedef Matrix3<float> mat3;
 typedef Matrix4<float> mat4;
+
+typedef Matrix2<double> dmat2;
+typedef Matrix3<double> dmat3;
+typedef Matrix4<double> dmat4;
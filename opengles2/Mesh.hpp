@@ -0,0 +1,123 @@
+//
+//  Mesh.hpp
+//  opengles2
+//
+//  椎体与底盘的顶点格式以及程序化生成函数，供两个渲染引擎以及离线工具共享。
+//
+
+#ifndef Mesh_hpp
+#define Mesh_hpp
+
+#include "Vector.hpp"
+#include <stddef.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct Vertex{
+    vec3 Position;
+    vec4 Color;
+    vec2 TexCoord;              // 位于 [0, 1]，使用纹理图集时由 RemapTexCoords() 换算至所在区域（参见 Texture.hpp）
+};
+
+// 针对圆和椎体，定义相关常量。
+static const float ConeRadius = 0.5f;
+static const float ConeHeight = 1.866f;
+static const int ConeSlices = 40;
+
+// 圆周点的角度由其编号直接求得（以双精度计算），而非逐点累加 dtheta：累加的舍入误差随片段数增长，
+// 片段数达到 10^5 以上时圆周已无法闭合。各顶点因此互不依赖，可按任意区间划分并行生成（参见 Tessellation.hpp），
+// 且结果与一次生成全部顶点逐位相同。
+static const double TessellationTwoPi = 8 * std::atan(1.0);
+
+// 生成底盘的第 [begin, end) 个顶点：第 0 个为中心点，其后为圆周点。纹理坐标为底盘平面在 [0, 1]² 上的投影。
+inline void GenerateDiskVertices(Vertex* disk, size_t begin, size_t end, float radius, float height, int slices)
+{
+    for (size_t i = begin; i < end; ++i) {
+        disk[i].Color = vec4(0.75, 0.75, 0.75, 1);
+        if (i == 0) {
+            disk[i].Position = vec3(0, 1 - height, 0);
+            disk[i].TexCoord = vec2(0.5f, 0.5f);
+            continue;
+        }
+        double theta = TessellationTwoPi * (i - 1) / slices;
+        double cosine = std::cos(theta), sine = std::sin(theta);
+        disk[i].Position = vec3((float) (radius * cosine), 1 - height, (float) (radius * sine));
+        disk[i].TexCoord = vec2((float) (0.5 + 0.5 * cosine), (float) (0.5 + 0.5 * sine));
+    }
+}
+
+// 生成椎体的第 [begin, end) 个顶点：偶数编号为顶点，奇数编号为圆周点，每对顶点共享同一角度与颜色。
+// 纹理坐标 s 沿圆周由 0 增至 1（首尾两对顶点位置相同而 s 不同，纹理因此无需重复寻址），t 在圆周处为 0、顶点处为 1。
+inline void GenerateConeVertices(Vertex* cone, size_t begin, size_t end, float radius, float height, int slices)
+{
+    for (size_t i = begin; i < end; ++i) {
+        double theta = TessellationTwoPi * (i / 2) / slices;
+        double sine = std::sin(theta);
+
+        // Grayscale gradient
+        // 为了简化光照模拟计算，这里采用了灰度梯度值，其中，颜色值使用了固定值，且不会随对象位置的变化而变化，
+        // 该技术有时也称作烘焙光照。
+        float brightness = (float) std::abs(sine);
+        cone[i].Color = vec4(brightness, brightness, brightness, 1);
+        float s = (float) (i / 2) / slices;
+        if (i % 2 == 0) {
+            cone[i].Position = vec3(0, 1, 0);
+            cone[i].TexCoord = vec2(s, 1);
+        } else {
+            cone[i].Position = vec3((float) (radius * std::cos(theta)), 1 - height, (float) (radius * sine));
+            cone[i].TexCoord = vec2(s, 0);
+        }
+    }
+}
+
+// 底盘采用 GL_TRIANGLE_FAN 拓扑关系，共 slices + 2 个顶点。
+inline void GenerateDisk(std::vector<Vertex>& disk, float radius, float height, int slices)
+{
+    disk.resize(slices + 2);
+    GenerateDiskVertices(&disk[0], 0, disk.size(), radius, height, slices);
+}
+
+// 椎体采用 GL_TRIANGLE_STRIP 三角带拓扑关系，共 (slices + 1) * 2 个顶点。
+inline void GenerateCone(std::vector<Vertex>& cone, float radius, float height, int slices)
+{
+    cone.resize((slices + 1) * 2);
+    GenerateConeVertices(&cone[0], 0, cone.size(), radius, height, slices);
+}
+
+// 将 GenerateCone() 生成的 count 个顶点形变后写入 out：顶点上下起伏，圆周点沿圆周形成 3 个波峰的行波，
+// 位移均不超过 amplitude。out 可以是映射的缓冲区，只写不读。
+inline void MorphConeVertices(const Vertex* cone, size_t count, float amplitude, float phase, Vertex* out)
+{
+    size_t slices = count / 2 - 1;
+    float apex = amplitude * std::sin(phase);
+    for (size_t i = 0; i < count; ++i) {
+        Vertex v = cone[i];
+        if (i % 2 == 0)
+            v.Position.y += apex;
+        else
+            v.Position.y += amplitude * (float) std::sin(phase + 3 * TessellationTwoPi * (i / 2) / slices);
+        out[i] = v;
+    }
+}
+
+// 计算一组顶点的轴对齐包围盒。
+inline void ComputeBounds(const Vertex* vertices, size_t count, vec3& boundsMin, vec3& boundsMax)
+{
+    if (count == 0) {
+        boundsMin = boundsMax = vec3(0, 0, 0);
+        return;
+    }
+    boundsMin = boundsMax = vertices[0].Position;
+    for (size_t i = 1; i < count; ++i) {
+        const vec3& p = vertices[i].Position;
+        boundsMin.x = std::min(boundsMin.x, p.x);
+        boundsMin.y = std::min(boundsMin.y, p.y);
+        boundsMin.z = std::min(boundsMin.z, p.z);
+        boundsMax.x = std::max(boundsMax.x, p.x);
+        boundsMax.y = std::max(boundsMax.y, p.y);
+        boundsMax.z = std::max(boundsMax.z, p.z);
+    }
+}
+
+#endif /* Mesh_hpp */
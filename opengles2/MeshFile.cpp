@@ -0,0 +1,262 @@
+//
+//  MeshFile.cpp
+//  opengles2
+//
+
+#include "MeshFile.hpp"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+const MeshFileAttribute* VertexLayout(uint32_t* attributeCount)
+{
+    static const MeshFileAttribute layout[] = {
+        { MeshAttributePosition, MeshComponentFloat, 3, 0, offsetof(Vertex, Position) },
+        { MeshAttributeColor, MeshComponentFloat, 4, 0, offsetof(Vertex, Color) },
+        { MeshAttributeTexCoord, MeshComponentFloat, 2, 0, offsetof(Vertex, TexCoord) },
+    };
+    *attributeCount = sizeof(layout) / sizeof(layout[0]);
+    return layout;
+}
+
+const MeshFileAttribute* QuantizedVertexLayout(uint32_t* attributeCount)
+{
+    static const MeshFileAttribute layout[] = {
+        { MeshAttributePosition, MeshComponentShort, 3, 1, offsetof(QuantizedVertex, Position) },
+        { MeshAttributeColor, MeshComponentFloat, 4, 0, offsetof(QuantizedVertex, Color) },
+        { MeshAttributeTexCoord, MeshComponentFloat, 2, 0, offsetof(QuantizedVertex, TexCoord) },
+    };
+    *attributeCount = sizeof(layout) / sizeof(layout[0]);
+    return layout;
+}
+
+mat4 MeshFileDequantizationMatrix(const MeshFileHeader& header, const MeshFileAttribute& position, bool normalized)
+{
+    if (position.Type == MeshComponentFloat)
+        return mat4::Identity();
+    PositionQuantization q;
+    q.Scale = vec3(header.PositionScale[0], header.PositionScale[1], header.PositionScale[2]);
+    q.Offset = vec3(header.PositionOffset[0], header.PositionOffset[1], header.PositionOffset[2]);
+    return DequantizationMatrix(q, normalized && position.Normalized);
+}
+
+size_t MeshComponentSize(uint32_t type)
+{
+    switch (type) {
+        case MeshComponentFloat:
+            return 4;
+        case MeshComponentShort:
+            return 2;
+        case MeshComponentUnsignedByte:
+            return 1;
+    }
+    return 0;
+}
+
+static bool WritePadding(FILE* file, uint64_t from, uint64_t to)
+{
+    static const unsigned char zeros[MeshFileAlignment] = {};
+    return from == to || fwrite(zeros, 1, to - from, file) == to - from;
+}
+
+bool WriteMeshFile(const char* path, const MeshFileSource& source)
+{
+    MeshFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.Magic = MeshFileMagic;
+    header.Version = MeshFileVersion;
+    header.AttributeCount = source.AttributeCount;
+    header.SubmeshCount = source.SubmeshCount;
+    header.VertexStride = source.VertexStride;
+    header.VertexCount = source.VertexCount;
+    header.IndexSize = source.Indices ? source.IndexSize : 0;
+    header.IndexCount = source.Indices ? source.IndexCount : 0;
+    header.BoundsMin[0] = source.BoundsMin.x;
+    header.BoundsMin[1] = source.BoundsMin.y;
+    header.BoundsMin[2] = source.BoundsMin.z;
+    header.BoundsMax[0] = source.BoundsMax.x;
+    header.BoundsMax[1] = source.BoundsMax.y;
+    header.BoundsMax[2] = source.BoundsMax.z;
+    PositionQuantization identity = { vec3(1, 1, 1), vec3(0, 0, 0) };
+    const PositionQuantization& q = source.Quantization ? *source.Quantization : identity;
+    header.PositionScale[0] = q.Scale.x;
+    header.PositionScale[1] = q.Scale.y;
+    header.PositionScale[2] = q.Scale.z;
+    header.PositionOffset[0] = q.Offset.x;
+    header.PositionOffset[1] = q.Offset.y;
+    header.PositionOffset[2] = q.Offset.z;
+
+    uint64_t tableEnd = sizeof(header)
+                      + uint64_t(source.AttributeCount) * sizeof(MeshFileAttribute)
+                      + uint64_t(source.SubmeshCount) * sizeof(MeshFileSubmesh);
+    uint64_t vertexBytes = uint64_t(source.VertexStride) * source.VertexCount;
+    uint64_t indexBytes = uint64_t(header.IndexSize) * header.IndexCount;
+    header.VertexOffset = AlignUp(tableEnd, MeshFileAlignment);
+    header.IndexOffset = indexBytes ? AlignUp(header.VertexOffset + vertexBytes, MeshFileAlignment) : 0;
+    header.FileSize = indexBytes ? header.IndexOffset + indexBytes : header.VertexOffset + vertexBytes;
+
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        std::cout << "Unable to create mesh file " << path << std::endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(source.Attributes, sizeof(MeshFileAttribute), source.AttributeCount, file) == source.AttributeCount;
+    ok = ok && fwrite(source.Submeshes, sizeof(MeshFileSubmesh), source.SubmeshCount, file) == source.SubmeshCount;
+    ok = ok && WritePadding(file, tableEnd, header.VertexOffset);
+    ok = ok && fwrite(source.Vertices, 1, vertexBytes, file) == vertexBytes;
+    if (indexBytes) {
+        ok = ok && WritePadding(file, header.VertexOffset + vertexBytes, header.IndexOffset);
+        ok = ok && fwrite(source.Indices, 1, indexBytes, file) == indexBytes;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok)
+        std::cout << "Failed writing mesh file " << path << std::endl;
+    return ok;
+}
+
+MappedMesh::MappedMesh() : m_data(0), m_size(0)
+{
+}
+
+MappedMesh::~MappedMesh()
+{
+    Close();
+}
+
+bool MappedMesh::Open(const char* path)
+{
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Unable to open mesh file " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(MeshFileHeader)) {
+        std::cout << "Mesh file " << path << " is truncated" << std::endl;
+        close(fd);
+        return false;
+    }
+
+    // 映射建立后即可关闭文件描述符；页面在首次访问时才由内核按需载入。
+    void* data = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        std::cout << "Unable to map mesh file " << path << std::endl;
+        return false;
+    }
+    m_data = (const unsigned char*) data;
+    m_size = info.st_size;
+
+    if (!Validate(path)) {
+        Close();
+        return false;
+    }
+    // 顶点数据随后会被整体顺序读取（上传或绘制），提示内核提前预读。
+    madvise((void*) m_data, m_size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedMesh::Close()
+{
+    if (m_data)
+        munmap((void*) m_data, m_size);
+    m_data = 0;
+    m_size = 0;
+}
+
+bool MappedMesh::Validate(const char* path) const
+{
+    const MeshFileHeader& header = Header();
+    if (header.Magic != MeshFileMagic || header.Version != MeshFileVersion) {
+        std::cout << "Mesh file " << path << " has an unsupported format or version" << std::endl;
+        return false;
+    }
+
+    uint64_t tableEnd = sizeof(MeshFileHeader)
+                      + uint64_t(header.AttributeCount) * sizeof(MeshFileAttribute)
+                      + uint64_t(header.SubmeshCount) * sizeof(MeshFileSubmesh);
+    // 偏移量来自文件，先确认其不超过文件大小，再将剩余字节数与数据大小比较，避免偏移量与大小相加时回绕（与 EngineSnapshot 相同）。
+    uint64_t vertexBytes = uint64_t(header.VertexStride) * header.VertexCount;
+    uint64_t indexBytes = uint64_t(header.IndexSize) * header.IndexCount;
+    bool layoutOk = header.FileSize == m_size
+                 && header.VertexOffset % MeshFileAlignment == 0
+                 && header.IndexOffset % MeshFileAlignment == 0
+                 && header.VertexStride > 0
+                 && header.VertexOffset >= tableEnd
+                 && header.VertexOffset <= m_size && vertexBytes <= m_size - header.VertexOffset
+                 && (header.IndexSize == 0 || header.IndexSize == 2 || header.IndexSize == 4)
+                 && (header.IndexSize == 0 || (header.IndexOffset >= header.VertexOffset + vertexBytes
+                                               && header.IndexOffset <= m_size && indexBytes <= m_size - header.IndexOffset));
+    if (!layoutOk) {
+        std::cout << "Mesh file " << path << " is corrupt" << std::endl;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.AttributeCount; ++i) {
+        const MeshFileAttribute& attribute = Attributes()[i];
+        size_t componentSize = MeshComponentSize(attribute.Type);
+        if (componentSize == 0 || attribute.Components == 0 || attribute.Components > 4 ||
+            attribute.Offset + componentSize * attribute.Components > header.VertexStride) {
+            std::cout << "Mesh file " << path << " has an invalid vertex layout" << std::endl;
+            return false;
+        }
+    }
+
+    uint32_t elementCount = header.IndexSize ? header.IndexCount : header.VertexCount;
+    for (uint32_t i = 0; i < header.SubmeshCount; ++i) {
+        const MeshFileSubmesh& submesh = Submeshes()[i];
+        if (submesh.Topology > MeshTopologyTriangleFan ||
+            uint64_t(submesh.First) + submesh.Count > elementCount) {
+            std::cout << "Mesh file " << path << " has an invalid submesh" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+const MeshFileHeader& MappedMesh::Header() const
+{
+    return *(const MeshFileHeader*) m_data;
+}
+
+const MeshFileAttribute* MappedMesh::Attributes() const
+{
+    return (const MeshFileAttribute*) (m_data + sizeof(MeshFileHeader));
+}
+
+const MeshFileSubmesh* MappedMesh::Submeshes() const
+{
+    return (const MeshFileSubmesh*) (Attributes() + Header().AttributeCount);
+}
+
+const void* MappedMesh::Vertices() const
+{
+    return m_data + Header().VertexOffset;
+}
+
+const void* MappedMesh::Indices() const
+{
+    return Header().IndexSize ? m_data + Header().IndexOffset : 0;
+}
+
+const MeshFileAttribute* MappedMesh::FindAttribute(MeshAttributeSemantic semantic) const
+{
+    for (uint32_t i = 0; i < Header().AttributeCount; ++i) {
+        if (Attributes()[i].Semantic == (uint32_t) semantic)
+            return &Attributes()[i];
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+//
+//  MeshFile.hpp
+//  opengles2
+//
+//  二进制网格文件格式（.vccmesh）。
+//
+/*
+ 文件布局如下，各数据块的起始位置均按 MeshFileAlignment 字节对齐：
+   MeshFileHeader
+   MeshFileAttribute[AttributeCount]   顶点布局描述
+   MeshFileSubmesh[SubmeshCount]       绘制区间及其拓扑关系
+   顶点数据                             VertexCount * VertexStride 字节
+   索引数据（可选）                      IndexCount * IndexSize 字节
+ 顶点与索引数据的存储格式与 GPU 所需的格式完全一致，且采用本机字节序（小端）。
+ 因此，MappedMesh 通过 mmap 映射文件后，可直接将映射指针交给 glBufferData 或 gl*Pointer，载入过程中无需任何解析或拷贝。
+ */
+
+#ifndef MeshFile_hpp
+#define MeshFile_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include "Mesh.hpp"
+#include "Quantization.hpp"
+
+static const uint32_t MeshFileMagic = 0x4D434356; // "VCCM"
+// 版本 2 新增 PositionScale/PositionOffset，用于 16 位量化的位置坐标（参见 Quantization.hpp）。
+static const uint32_t MeshFileVersion = 2;
+static const uint32_t MeshFileAlignment = 16;
+
+enum MeshAttributeSemantic {
+    MeshAttributePosition,
+    MeshAttributeColor,
+    MeshAttributeTexCoord,
+};
+
+enum MeshComponentType {
+    MeshComponentFloat,
+    MeshComponentShort,
+    MeshComponentUnsignedByte,
+};
+
+enum MeshTopology {
+    MeshTopologyTriangles,
+    MeshTopologyTriangleStrip,
+    MeshTopologyTriangleFan,
+};
+
+struct MeshFileHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t AttributeCount;
+    uint32_t SubmeshCount;
+    uint32_t VertexStride;
+    uint32_t VertexCount;
+    uint32_t IndexSize;         // 0 表示非索引网格，否则为 2 或 4
+    uint32_t IndexCount;
+    uint64_t VertexOffset;
+    uint64_t IndexOffset;
+    uint64_t FileSize;
+    float BoundsMin[3];
+    float BoundsMax[3];
+    float PositionScale[3];     // 位置未量化时为 (1, 1, 1)
+    float PositionOffset[3];    // 位置未量化时为 (0, 0, 0)
+};
+
+struct MeshFileAttribute {
+    uint32_t Semantic;          // MeshAttributeSemantic
+    uint32_t Type;              // MeshComponentType
+    uint32_t Components;
+    uint32_t Normalized;
+    uint32_t Offset;            // 相对于顶点起始位置的字节偏移
+};
+
+// 对于索引网格，First/Count 指向索引数组；否则指向顶点数组。
+struct MeshFileSubmesh {
+    uint32_t Topology;          // MeshTopology
+    uint32_t First;
+    uint32_t Count;
+    uint32_t Reserved;
+};
+
+// 写入网格文件时所需的全部输入，指针仅在 WriteMeshFile 调用期间被访问。
+struct MeshFileSource {
+    const void* Vertices;
+    uint32_t VertexStride;
+    uint32_t VertexCount;
+    const MeshFileAttribute* Attributes;
+    uint32_t AttributeCount;
+    const void* Indices;
+    uint32_t IndexSize;
+    uint32_t IndexCount;
+    const MeshFileSubmesh* Submeshes;
+    uint32_t SubmeshCount;
+    vec3 BoundsMin;
+    vec3 BoundsMax;
+    const PositionQuantization* Quantization;   // 位置以浮点数存储时为空
+};
+
+// 描述 Mesh.hpp 中 Vertex 结构的布局。
+const MeshFileAttribute* VertexLayout(uint32_t* attributeCount);
+// 描述 Quantization.hpp 中 QuantizedVertex 结构的布局。
+const MeshFileAttribute* QuantizedVertexLayout(uint32_t* attributeCount);
+
+// 返回文件中位置量化参数所对应的反量化矩阵，位置以浮点数存储时为单位矩阵。
+// normalized 为 false 表示渲染器不对整数坐标做规格化处理（ES 1.1）。
+mat4 MeshFileDequantizationMatrix(const MeshFileHeader& header, const MeshFileAttribute& position, bool normalized = true);
+
+size_t MeshComponentSize(uint32_t type);
+
+bool WriteMeshFile(const char* path, const MeshFileSource& source);
+
+// 以只读方式映射一个网格文件，并在返回前校验头部以及各数据块的边界。
+// 析构时自动解除映射，因此经由 Vertices()/Indices() 获得的指针仅在对象存续期间有效。
+class MappedMesh {
+public:
+    MappedMesh();
+    ~MappedMesh();
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return m_data != 0; }
+    // 交换两者的映射，用于先在局部对象中打开并校验，成功后再替换当前网格。
+    void Swap(MappedMesh& other)
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+    const MeshFileHeader& Header() const;
+    const MeshFileAttribute* Attributes() const;
+    const MeshFileSubmesh* Submeshes() const;
+    const void* Vertices() const;
+    const void* Indices() const;
+    const MeshFileAttribute* FindAttribute(MeshAttributeSemantic semantic) const;
+private:
+    MappedMesh(const MappedMesh&);
+    MappedMesh& operator=(const MappedMesh&);
+    bool Validate(const char* path) const;
+    const unsigned char* m_data;
+    size_t m_size;
+};
+
+#endif /* MeshFile_hpp */
@@ -0,0 +1,263 @@
+//
+//  OcclusionCuller.cpp
+//  opengles2
+//
+
+#include "OcclusionCuller.hpp"
+#include "Float4.hpp"
+#include "Tracing.hpp"
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+// 每次处理一行中相邻的 4 个像素（参见 Float4.hpp），LaneOffsets 为各分量相对于第一个像素的偏移。
+static const float LaneOffsets[4] = { 0, 1, 2, 3 };
+// w 分量不大于该值的顶点位于近裁剪面附近或观察者身后。
+static const float MinClipW = 1e-5f;
+
+OcclusionCuller::OcclusionCuller(int width, int height, int tileSize)
+    : m_width(width), m_height(height), m_tileSize(tileSize)
+{
+    m_tilesX = width / tileSize;
+    m_tilesY = height / tileSize;
+    m_tileLevels = 0;
+    while ((1 << (m_tileLevels + 1)) <= tileSize)
+        m_tileLevels++;
+
+    // 各级尺寸向上取整：尺寸为奇数时最后一行（列）单独构成上一级的纹素，使每个纹素覆盖下一级中的全部对应纹素。
+    int w = width, h = height;
+    m_levels.push_back(std::vector<float>(w * h, 1.0f));
+    while (w > 1 || h > 1) {
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        m_levels.push_back(std::vector<float>(w * h, 1.0f));
+    }
+    m_bins.resize(m_tilesX * m_tilesY);
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void OcclusionCuller::BeginFrame(const mat4& projection)
+{
+    m_projection = projection;
+    std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+    m_triangles.clear();
+    for (size_t i = 0; i < m_bins.size(); ++i)
+        m_bins[i].clear();
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void OcclusionCuller::AddOccluder(const vec3* positions, size_t count, const mat4& modelview)
+{
+    mat4 m = modelview * m_projection;
+    for (size_t i = 0; i + 2 < count; i += 3) {
+        float x[3], y[3], z[3];
+        bool clipped = false;
+        for (int k = 0; k < 3; ++k) {
+            const vec3& p = positions[i + k];
+            float cx = p.x * m.x.x + p.y * m.y.x + p.z * m.z.x + m.w.x;
+            float cy = p.x * m.x.y + p.y * m.y.y + p.z * m.z.y + m.w.y;
+            float cz = p.x * m.x.z + p.y * m.y.z + p.z * m.z.z + m.w.z;
+            float cw = p.x * m.x.w + p.y * m.y.w + p.z * m.z.w + m.w.w;
+            // 不做近裁剪面的裁剪，直接舍弃该三角形：遮挡体少一些只会降低剔除率，而不会错误地剔除物体。
+            if (cw <= MinClipW) {
+                clipped = true;
+                break;
+            }
+            x[k] = (cx / cw * 0.5f + 0.5f) * m_width;
+            y[k] = (cy / cw * 0.5f + 0.5f) * m_height;
+            z[k] = cz / cw * 0.5f + 0.5f;
+        }
+        if (clipped)
+            continue;
+
+        // 统一为逆时针顺序，使三角形内部的边函数值均为非负数。
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (std::fabs(area) < 1e-6f)
+            continue;
+        if (area < 0) {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(z[1], z[2]);
+            area = -area;
+        }
+
+        Triangle t;
+        t.MinX = std::max(0, (int) std::ceil(std::min(x[0], std::min(x[1], x[2])) - 0.5f));
+        t.MinY = std::max(0, (int) std::ceil(std::min(y[0], std::min(y[1], y[2])) - 0.5f));
+        t.MaxX = std::min(m_width - 1, (int) std::floor(std::max(x[0], std::max(x[1], x[2])) - 0.5f));
+        t.MaxY = std::min(m_height - 1, (int) std::floor(std::max(y[0], std::max(y[1], y[2])) - 0.5f));
+        if (t.MinX > t.MaxX || t.MinY > t.MaxY)
+            continue;
+
+        for (int k = 0; k < 3; ++k) {
+            int n = (k + 1) % 3;
+            t.EdgeA[k] = y[k] - y[n];
+            t.EdgeB[k] = x[n] - x[k];
+            t.EdgeC[k] = x[k] * y[n] - y[k] * x[n];
+        }
+        t.DepthX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+        t.DepthY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+        t.Depth0 = z[0] - t.DepthX * x[0] - t.DepthY * y[0];
+
+        uint32_t index = (uint32_t) m_triangles.size();
+        m_triangles.push_back(t);
+        for (int ty = t.MinY / m_tileSize; ty <= t.MaxY / m_tileSize; ++ty)
+            for (int tx = t.MinX / m_tileSize; tx <= t.MaxX / m_tileSize; ++tx)
+                m_bins[ty * m_tilesX + tx].push_back(index);
+    }
+    m_stats.OccluderTriangles = (uint32_t) m_triangles.size();
+}
+
+void OcclusionCuller::RasterizeOccluders(JobSystem* jobs)
+{
+    VCC_TRACE_SCOPE("RasterizeOccluders");
+    // 各图块只写入自身范围内的深度与金字塔纹素，互不重叠，因此无需任何同步。
+    size_t tileCount = m_tilesX * m_tilesY;
+    std::function<void(size_t, size_t)> rasterize = [this](size_t begin, size_t end) {
+        for (size_t tile = begin; tile < end; ++tile) {
+            RasterizeTile((int) tile);
+            BuildTilePyramid((int) tile);
+        }
+    };
+    if (jobs)
+        jobs->ParallelFor(tileCount, 1, rasterize);
+    else
+        rasterize(0, tileCount);
+
+    BuildUpperPyramid();
+}
+
+void OcclusionCuller::RasterizeTile(int tile)
+{
+    const std::vector<uint32_t>& bin = m_bins[tile];
+    if (bin.empty())
+        return;
+
+    int tileX = (tile % m_tilesX) * m_tileSize;
+    int tileY = (tile / m_tilesX) * m_tileSize;
+    float* depth = &m_levels[0][0];
+    const Float4 lanes = Load4(LaneOffsets);
+    const Float4 zero = Splat4(0);
+
+    for (size_t i = 0; i < bin.size(); ++i) {
+        const Triangle& t = m_triangles[bin[i]];
+        // 起点按 4 像素对齐；图块宽度为 4 的整数倍，因此每组像素都不会越出图块。
+        int x0 = std::max(t.MinX, tileX) & ~3;
+        int x1 = std::min(t.MaxX, tileX + m_tileSize - 1);
+        int y0 = std::max(t.MinY, tileY);
+        int y1 = std::min(t.MaxY, tileY + m_tileSize - 1);
+
+        Float4 a0 = Splat4(t.EdgeA[0]), a1 = Splat4(t.EdgeA[1]), a2 = Splat4(t.EdgeA[2]);
+        Float4 depthX = Splat4(t.DepthX);
+        for (int y = y0; y <= y1; ++y) {
+            float py = y + 0.5f;
+            Float4 row0 = Splat4(t.EdgeB[0] * py + t.EdgeC[0]);
+            Float4 row1 = Splat4(t.EdgeB[1] * py + t.EdgeC[1]);
+            Float4 row2 = Splat4(t.EdgeB[2] * py + t.EdgeC[2]);
+            Float4 rowDepth = Splat4(t.DepthY * py + t.Depth0);
+            float* line = depth + y * m_width;
+            for (int x = x0; x <= x1; x += 4) {
+                Float4 px = Add4(Splat4(x + 0.5f), lanes);
+                Mask4 inside = And4(GreaterEqual4(Add4(Mul4(a0, px), row0), zero),
+                               And4(GreaterEqual4(Add4(Mul4(a1, px), row1), zero),
+                                    GreaterEqual4(Add4(Mul4(a2, px), row2), zero)));
+                Float4 z = Add4(Mul4(depthX, px), rowDepth);
+                Float4 current = Load4(line + x);
+                Store4(line + x, Select4(inside, Min4(current, z), current));
+            }
+        }
+    }
+}
+
+// 金字塔的上一级纹素取下一级 2x2 纹素中的最大深度；下一级尺寸为奇数时，最后一个纹素只覆盖其最后一行（列）。
+static void ReduceLevel(const float* source, int sourceWidth, int sourceHeight, float* target, int targetWidth,
+                        int x0, int y0, int x1, int y1)
+{
+    for (int y = y0; y < y1; ++y) {
+        int sy0 = std::min(2 * y, sourceHeight - 1);
+        int sy1 = std::min(2 * y + 1, sourceHeight - 1);
+        for (int x = x0; x < x1; ++x) {
+            int sx0 = std::min(2 * x, sourceWidth - 1);
+            int sx1 = std::min(2 * x + 1, sourceWidth - 1);
+            float a = std::max(source[sy0 * sourceWidth + sx0], source[sy0 * sourceWidth + sx1]);
+            float b = std::max(source[sy1 * sourceWidth + sx0], source[sy1 * sourceWidth + sx1]);
+            target[y * targetWidth + x] = std::max(a, b);
+        }
+    }
+}
+
+void OcclusionCuller::BuildTilePyramid(int tile)
+{
+    int x0 = (tile % m_tilesX) * m_tileSize;
+    int y0 = (tile / m_tilesX) * m_tileSize;
+    int size = m_tileSize;
+    int width = m_width, height = m_height;
+    for (int level = 1; level <= m_tileLevels; ++level) {
+        x0 /= 2;
+        y0 /= 2;
+        size /= 2;
+        ReduceLevel(&m_levels[level - 1][0], width, height, &m_levels[level][0], width / 2,
+                    x0, y0, x0 + size, y0 + size);
+        width /= 2;
+        height /= 2;
+    }
+}
+
+void OcclusionCuller::BuildUpperPyramid()
+{
+    int width = m_width >> m_tileLevels;
+    int height = m_height >> m_tileLevels;
+    for (size_t level = m_tileLevels + 1; level < m_levels.size(); ++level) {
+        int targetWidth = (width + 1) / 2;
+        int targetHeight = (height + 1) / 2;
+        ReduceLevel(&m_levels[level - 1][0], width, height, &m_levels[level][0], targetWidth,
+                    0, 0, targetWidth, targetHeight);
+        width = targetWidth;
+        height = targetHeight;
+    }
+}
+
+bool OcclusionCuller::IsVisible(const vec3& boundsMin, const vec3& boundsMax, const mat4& modelview)
+{
+    m_stats.Tested++;
+    mat4 m = modelview * m_projection;
+    float minX = m_width, minY = m_height, maxX = 0, maxY = 0, minZ = 1;
+    for (int i = 0; i < 8; ++i) {
+        vec3 p(i & 1 ? boundsMax.x : boundsMin.x, i & 2 ? boundsMax.y : boundsMin.y, i & 4 ? boundsMax.z : boundsMin.z);
+        float cx = p.x * m.x.x + p.y * m.y.x + p.z * m.z.x + m.w.x;
+        float cy = p.x * m.x.y + p.y * m.y.y + p.z * m.z.y + m.w.y;
+        float cz = p.x * m.x.z + p.y * m.y.z + p.z * m.z.z + m.w.z;
+        float cw = p.x * m.x.w + p.y * m.y.w + p.z * m.z.w + m.w.w;
+        // 包围盒与近裁剪面相交，无法可靠地投影。
+        if (cw <= MinClipW)
+            return true;
+        float sx = (cx / cw * 0.5f + 0.5f) * m_width;
+        float sy = (cy / cw * 0.5f + 0.5f) * m_height;
+        minX = std::min(minX, sx);
+        maxX = std::max(maxX, sx);
+        minY = std::min(minY, sy);
+        maxY = std::max(maxY, sy);
+        minZ = std::min(minZ, cz / cw * 0.5f + 0.5f);
+    }
+
+    // 完全位于屏幕之外的物体交由视锥剔除处理，这里不计为被遮挡。
+    if (maxX <= 0 || maxY <= 0 || minX >= m_width || minY >= m_height)
+        return true;
+    int x0 = std::max(0, (int) minX), x1 = std::min(m_width - 1, (int) maxX);
+    int y0 = std::max(0, (int) minY), y1 = std::min(m_height - 1, (int) maxY);
+
+    // 选择使屏幕矩形至多覆盖 2x2 个纹素的级别。
+    int level = 0;
+    while (level + 1 < (int) m_levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        level++;
+    int levelWidth = (m_width + (1 << level) - 1) >> level;
+    int levelHeight = (m_height + (1 << level) - 1) >> level;
+    const float* depth = &m_levels[level][0];
+    for (int y = y0 >> level; y <= std::min(y1 >> level, levelHeight - 1); ++y)
+        for (int x = x0 >> level; x <= std::min(x1 >> level, levelWidth - 1); ++x)
+            if (minZ <= depth[y * levelWidth + x])
+                return true;
+
+    m_stats.Occluded++;
+    return false;
+}
@@ -0,0 +1,71 @@
+//
+//  OcclusionCuller.hpp
+//  opengles2
+//
+//  基于 CPU 软件光栅化与层级深度（Hierarchical-Z）的遮挡剔除。
+//
+/*
+ 每一帧的使用流程如下：
+   BeginFrame()        清空低分辨率深度缓冲区
+   AddOccluder()       加入遮挡体代理网格（三角形列表，例如内接于椎体的低精度椎体），完成三角形设置并将其分配至所覆盖的图块
+   RasterizeOccluders() 以 JobSystem 在多个线程上并行光栅化各图块，每个图块随后各自构建其范围内的深度金字塔
+   IsVisible()         将被遮挡体的包围盒投影至屏幕，与深度金字塔中覆盖该区域的若干纹素比较
+ 深度缓冲区存储 NDC 深度（0 为近裁剪面，1 为远裁剪面），金字塔的每一级存储下一级 2x2 纹素中的最大值（最远深度），
+ 因此包围盒最近点的深度大于所覆盖纹素的深度时，该物体必然被完全遮挡。
+ 遮挡体代理必须位于真实网格之内，被遮挡体的包围盒必须包含真实网格，剔除才是保守的。
+ 光栅化按像素中心采样，每次以 SIMD（NEON/SSE，其余平台为标量实现）处理一行中的 4 个像素。
+ */
+
+#ifndef OcclusionCuller_hpp
+#define OcclusionCuller_hpp
+
+#include "Matrix.hpp"
+#include "JobSystem.hpp"
+#include <stdint.h>
+#include <vector>
+
+struct OcclusionStats {
+    uint32_t OccluderTriangles;
+    uint32_t Tested;
+    uint32_t Occluded;
+};
+
+class OcclusionCuller {
+public:
+    // width 与 height 必须为 tileSize 的整数倍，tileSize 必须为 2 的幂且不小于 4。
+    OcclusionCuller(int width = 64, int height = 96, int tileSize = 16);
+    void BeginFrame(const mat4& projection);
+    // positions 为三角形列表，其坐标经 modelview 与投影矩阵变换至裁剪空间。
+    void AddOccluder(const vec3* positions, size_t count, const mat4& modelview);
+    // jobs 为空时在调用线程上依次光栅化全部图块。
+    void RasterizeOccluders(JobSystem* jobs = 0);
+    // 包围盒与深度金字塔比较；物体可能可见时返回 true。
+    bool IsVisible(const vec3& boundsMin, const vec3& boundsMax, const mat4& modelview);
+    const OcclusionStats& Stats() const { return m_stats; }
+    int Width() const { return m_width; }
+    int Height() const { return m_height; }
+    // 返回指定级别的深度金字塔，第 0 级即为深度缓冲区。
+    const float* Level(int level) const { return &m_levels[level][0]; }
+private:
+    struct Triangle {
+        float EdgeA[3], EdgeB[3], EdgeC[3];     // 三条边的边函数 A*x + B*y + C
+        float DepthX, DepthY, Depth0;           // 深度平面 z = DepthX*x + DepthY*y + Depth0
+        int MinX, MinY, MaxX, MaxY;             // 所覆盖像素中心的范围
+    };
+    void RasterizeTile(int tile);
+    void BuildTilePyramid(int tile);
+    void BuildUpperPyramid();
+    int m_width;
+    int m_height;
+    int m_tileSize;
+    int m_tilesX;
+    int m_tilesY;
+    int m_tileLevels;
+    mat4 m_projection;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<float> > m_levels;
+    std::vector<std::vector<uint32_t> > m_bins;     // 每个图块所覆盖的三角形索引
+    OcclusionStats m_stats;
+};
+
+#endif /* OcclusionCuller_hpp */
@@ -0,0 +1,69 @@
+//
+//  PhaseTimer.hpp
+//  opengles2
+//
+//  记录初始化等一次性流程中各阶段的耗时。
+//
+
+#ifndef PhaseTimer_hpp
+#define PhaseTimer_hpp
+
+#include <stddef.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+class PhaseTimer {
+public:
+    PhaseTimer() : m_last(Now()) {}
+    // 清除已记录的阶段，并从此刻开始计时。
+    void Restart()
+    {
+        m_phases.clear();
+        m_last = Now();
+    }
+    // 结束当前阶段并以 name 记录其耗时，下一阶段随即开始。name 须为字符串常量。
+    void Mark(const char* name)
+    {
+        double now = Now();
+        Phase phase = { name, now - m_last };
+        m_phases.push_back(phase);
+        m_last = now;
+    }
+    size_t PhaseCount() const { return m_phases.size(); }
+    const char* PhaseName(size_t i) const { return m_phases[i].Name; }
+    double PhaseSeconds(size_t i) const { return m_phases[i].Seconds; }
+    double TotalSeconds() const
+    {
+        double total = 0;
+        for (size_t i = 0; i < m_phases.size(); ++i)
+            total += m_phases[i].Seconds;
+        return total;
+    }
+    // 以毫秒为单位向 out 输出一行：label: total ms (phase ms, ...)，随后恢复 out 原有的数字格式。
+    void Print(std::ostream& out, const char* label) const
+    {
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << label << ": " << std::fixed << std::setprecision(3) << TotalSeconds() * 1000 << " ms (";
+        for (size_t i = 0; i < m_phases.size(); ++i)
+            out << (i ? ", " : "") << m_phases[i].Name << " " << m_phases[i].Seconds * 1000;
+        out << ")" << std::endl;
+        out.flags(flags);
+        out.precision(precision);
+    }
+private:
+    struct Phase {
+        const char* Name;
+        double Seconds;
+    };
+    static double Now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    std::vector<Phase> m_phases;
+    double m_last;
+};
+
+#endif /* PhaseTimer_hpp */
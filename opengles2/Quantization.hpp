@@ -0,0 +1,115 @@
+//
+//  Quantization.hpp
+//  opengles2
+//
+//  顶点位置的 16 位量化编码。
+//
+/*
+ 位置坐标以网格包围盒为基准归一化至 [-1, 1]，再以规格化的 GL_SHORT 存储，位置数据由 12 字节降至 8 字节（含 2 字节填充）。
+ 反量化 p = Offset + Scale * q 是一个仿射变换，因而可以预先乘入 Modelview 矩阵，顶点着色器无需任何额外计算。
+ OpenGL ES 2.0 规范将规格化的有符号整数 c 转换为 (2c + 1) / (2^16 - 1)，量化与误差统计均按照该规则进行。
+ ES 1.1 的 glVertexPointer 并不对 GL_SHORT 做规格化处理，此时可令 DequantizationMatrix 的 normalized 参数为 false。
+ */
+
+#ifndef Quantization_hpp
+#define Quantization_hpp
+
+#include "Mesh.hpp"
+#include "Matrix.hpp"
+#include <stdint.h>
+
+struct QuantizedVertex{
+    int16_t Position[4];        // 第 4 个分量仅用于对齐
+    vec4 Color;
+    vec2 TexCoord;
+};
+
+struct PositionQuantization{
+    vec3 Scale;
+    vec3 Offset;
+};
+
+struct QuantizationErrorReport{
+    size_t VertexCount;
+    float MaxError;             // 最大欧氏距离误差，单位与模型坐标相同
+    float RmsError;
+};
+
+inline PositionQuantization ComputePositionQuantization(const vec3& boundsMin, const vec3& boundsMax)
+{
+    PositionQuantization q;
+    q.Offset = (boundsMin + boundsMax) / 2;
+    q.Scale = (boundsMax - boundsMin) / 2;
+    // 退化轴（例如平面网格）上的坐标恒等于 Offset，任意非零比例均可。
+    if (q.Scale.x == 0) q.Scale.x = 1;
+    if (q.Scale.y == 0) q.Scale.y = 1;
+    if (q.Scale.z == 0) q.Scale.z = 1;
+    return q;
+}
+
+inline int16_t QuantizeComponent(float value, float scale, float offset)
+{
+    float normalized = (value - offset) / scale;
+    float c = std::floor((normalized * 65535 - 1) / 2 + 0.5f);
+    return (int16_t) std::max(-32768.0f, std::min(32767.0f, c));
+}
+
+inline float DequantizeComponent(int16_t c, float scale, float offset)
+{
+    return offset + scale * (2.0f * c + 1) / 65535;
+}
+
+inline void QuantizePositions(const Vertex* source, size_t count, const PositionQuantization& q, QuantizedVertex* destination)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const vec3& p = source[i].Position;
+        destination[i].Position[0] = QuantizeComponent(p.x, q.Scale.x, q.Offset.x);
+        destination[i].Position[1] = QuantizeComponent(p.y, q.Scale.y, q.Offset.y);
+        destination[i].Position[2] = QuantizeComponent(p.z, q.Scale.z, q.Offset.z);
+        destination[i].Position[3] = 0;
+        destination[i].Color = source[i].Color;
+        destination[i].TexCoord = source[i].TexCoord;
+    }
+}
+
+// 返回将量化坐标还原为模型坐标的矩阵，使用时将其置于 Modelview 的最左侧：Dequantization * Rotation * Translation。
+inline mat4 DequantizationMatrix(const PositionQuantization& q, bool normalized = true)
+{
+    // 规格化时 GPU 已将 c 转换为 (2c + 1) / 65535；否则 c 被直接当作浮点数使用，需要将该转换一并乘入矩阵。
+    vec3 scale = q.Scale;
+    vec3 offset = q.Offset;
+    if (!normalized) {
+        scale = q.Scale * (2.0f / 65535);
+        offset = q.Offset + q.Scale / 65535;
+    }
+    mat4 m;
+    m.x.x = scale.x;
+    m.y.y = scale.y;
+    m.z.z = scale.z;
+    m.w.x = offset.x;
+    m.w.y = offset.y;
+    m.w.z = offset.z;
+    return m;
+}
+
+inline QuantizationErrorReport MeasureQuantizationError(const Vertex* reference, const QuantizedVertex* quantized,
+                                                        size_t count, const PositionQuantization& q)
+{
+    QuantizationErrorReport report;
+    report.VertexCount = count;
+    report.MaxError = 0;
+    double sumSquared = 0;
+    for (size_t i = 0; i < count; ++i) {
+        vec3 p(DequantizeComponent(quantized[i].Position[0], q.Scale.x, q.Offset.x),
+               DequantizeComponent(quantized[i].Position[1], q.Scale.y, q.Offset.y),
+               DequantizeComponent(quantized[i].Position[2], q.Scale.z, q.Offset.z));
+        vec3 d = p - reference[i].Position;
+        float squared = d.Dot(d);
+        report.MaxError = std::max(report.MaxError, std::sqrt(squared));
+        sumSquared += squared;
+    }
+    report.RmsError = count ? (float) std::sqrt(sumSquared / count) : 0;
+    return report;
+}
+
+#endif /* Quantization_hpp */
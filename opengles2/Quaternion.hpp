@@ -1,8 +1,12 @@
 #pragma once
 #include "Matrix.hpp"
 
+// 四元数的 +、- 与 Scaled() 同样返回表达式，参见 VectorExpression.hpp。
 template <typename T>
-struct QuaternionT {
+struct QuaternionT : VectorExpression<QuaternionT<T> > {
+    typedef QuaternionT Value;
+    typedef T Scalar;
+    typedef const QuaternionT& Operand;
     T x;
     T y;
     T z;
@@ -10,15 +14,26 @@ struct QuaternionT {
     
     QuaternionT();
     QuaternionT(T x, T y, T z, T w);
+    template <typename E>
+    VCC_VECTOR_INLINE QuaternionT(const VectorExpression<E>& e)
+    {
+        const E& q = e.Self();
+        x = q[0];
+        y = q[1];
+        z = q[2];
+        w = q[3];
+    }
+    VCC_VECTOR_INLINE T operator[](int i) const
+    {
+        return (&x)[i];
+    }
     
     QuaternionT<T> Slerp(T mu, const QuaternionT<T>& q) const;
+    QuaternionT<T> Nlerp(T mu, const QuaternionT<T>& q) const;
     QuaternionT<T> Rotated(const QuaternionT<T>& b) const;
-    QuaternionT<T> Scaled(T scale) const;
     T Dot(const QuaternionT<T>& q) const;
     Matrix3<T> ToMatrix() const;
     Vector4<T> ToVector() const;
-    QuaternionT<T> operator-(const QuaternionT<T>& q) const;
-    QuaternionT<T> operator+(const QuaternionT<T>& q) const;
     bool operator==(const QuaternionT<T>& q) const;
     bool operator!=(const QuaternionT<T>& q) const;
     
@@ -26,7 +41,7 @@ struct QuaternionT {
     void Rotate(const QuaternionT<T>& q);
     
     static QuaternionT<T> CreateFromVectors(const Vector3<T>& v0, const Vector3<T>& v1);
-    static QuaternionT<T> CreateFromAxisAngle(const Vector3<T>& axis, float radians);
+    static QuaternionT<T> CreateFromAxisAngle(const Vector3<T>& axis, T radians);
 };
 
 template <typename T>
@@ -43,11 +58,12 @@ inline QuaternionT<T>::QuaternionT(T x, T y, T z, T w) : x(x), y(y), z(z), w(w)
 template <typename T>
 inline QuaternionT<T> QuaternionT<T>::Slerp(T t, const QuaternionT<T>& v1) const
 {
-    const T epsilon = 0.0005f;
+    VCC_SCALAR_MATH;
+    const T epsilon = T(0.0005);
     T dot = Dot(v1);
     
     if (dot > 1 - epsilon) {
-        QuaternionT<T> result = v1 + (*this - v1).Scaled(t);
+        QuaternionT<T> result = *this + (v1 - *this).Scaled(t);
         result.Normalize();
         return result;
     }
@@ -58,17 +74,27 @@ inline QuaternionT<T> QuaternionT<T>::Slerp(T t, const QuaternionT<T>& v1) const
     if (dot > 1)
         dot = 1;
     
-    T theta0 = std::acos(dot);
+    T theta0 = acos(dot);
     T theta = theta0 * t;
     
-    QuaternionT<T> v2 = (v1 - Scaled(dot));
+    QuaternionT<T> v2 = (v1 - this->Scaled(dot));
     v2.Normalize();
     
-    QuaternionT<T> q = Scaled(std::cos(theta)) + v2.Scaled(std::sin(theta));
+    QuaternionT<T> q = this->Scaled(cos(theta)) + v2.Scaled(sin(theta));
     q.Normalize();
     return q;
 }
 
+// 归一化线性插值：沿较短的弧线性插值后归一化。角速度不及 Slerp 均匀，但无需三角函数，顶点着色器中的插值与之相同。
+template <typename T>
+inline QuaternionT<T> QuaternionT<T>::Nlerp(T mu, const QuaternionT<T>& q) const
+{
+    QuaternionT<T> end = Dot(q) < 0 ? QuaternionT<T>(-q) : q;
+    QuaternionT<T> result = *this + (end - *this).Scaled(mu);
+    result.Normalize();
+    return result;
+}
+
 template <typename T>
 inline QuaternionT<T> QuaternionT<T>::Rotated(const QuaternionT<T>& b) const
 {
@@ -81,12 +107,6 @@ inline QuaternionT<T> QuaternionT<T>::Rotated(const QuaternionT<T>& b) const
     return q;
 }
 
-template <typename T>
-inline QuaternionT<T> QuaternionT<T>::Scaled(T s) const
-{
-    return QuaternionT<T>(x * s, y * s, z * s, w * s);
-}
-
 template <typename T>
 inline T QuaternionT<T>::Dot(const QuaternionT<T>& q) const
 {
@@ -118,18 +138,6 @@ inline Vector4<T> QuaternionT<T>::ToVector() const
     return Vector4<T>(x, y, z, w);
 }
 
-template <typename T>
-QuaternionT<T> QuaternionT<T>::operator-(const QuaternionT<T>& q) const
-{
-    return QuaternionT<T>(x - q.x, y - q.y, z - q.z, w - q.w);
-}
-
-template <typename T>
-QuaternionT<T> QuaternionT<T>::operator+(const QuaternionT<T>& q) const
-{
-    return QuaternionT<T>(x + q.x, y + q.y, z + q.z, w + q.w);
-}
-
 template <typename T>
 bool QuaternionT<T>::operator==(const QuaternionT<T>& q) const
 {
@@ -148,26 +156,28 @@ template <typename T>
 inline QuaternionT<T> QuaternionT<T>::CreateFromVectors(const Vector3<T>& v0, const Vector3<T>& v1)
 {
     if (v0 == -v1)
-        return QuaternionT<T>::CreateFromAxisAngle(vec3(1, 0, 0), Pi);
+        return QuaternionT<T>::CreateFromAxisAngle(Vector3<T>(1, 0, 0), ScalarPi<T>());
     
+    VCC_SCALAR_MATH;
     Vector3<T> c = v0.Cross(v1);
     T d = v0.Dot(v1);
-    T s = std::sqrt((1 + d) * 2);
+    T s = sqrt((1 + d) * 2);
 
     QuaternionT<T> q;
     q.x = c.x / s;
     q.y = c.y / s;
     q.z = c.z / s;
-    q.w = s / 2.0f;
+    q.w = s / 2;
     return q;
 }
 
 template <typename T>
-inline QuaternionT<T>  QuaternionT<T>::CreateFromAxisAngle(const Vector3<T>& axis, float radians)
+inline QuaternionT<T>  QuaternionT<T>::CreateFromAxisAngle(const Vector3<T>& axis, T radians)
 {
+    VCC_SCALAR_MATH;
     QuaternionT<T> q;
-    q.w = std::cos(radians / 2);
-    q.x = q.y = q.z = std::sin(radians / 2);
+    q.w = cos(radians / 2);
+    q.x = q.y = q.z = sin(radians / 2);
     q.x *= axis.x;
     q.y *= axis.y;
     q.z *= axis.z;
@@ -177,7 +187,8 @@ inline QuaternionT<T>  QuaternionT<T>::CreateFromAxisAngle(const Vector3<T>& axi
 template <typename T>
 inline void QuaternionT<T>::Normalize()
 {
-    *this = Scaled(1 / std::sqrt(Dot(*this)));
+    VCC_SCALAR_MATH;
+    *this = this->Scaled(1 / sqrt(Dot(*this)));
 }
 
 template <typename T>
@@ -196,3 +207,4 @@ inline void QuaternionT<T>::Rotate(const QuaternionT<T>& q2)
 }
 
 typedef QuaternionT<float> Quaternion;
+typedef QuaternionT<double> DoubleQuaternion;
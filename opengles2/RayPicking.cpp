@@ -0,0 +1,351 @@
+//
+//  RayPicking.cpp
+//  opengles2
+//
+
+#include "RayPicking.hpp"
+#include "Float4.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// 一组 4 个分量中有效分量的位掩码，下标为有效分量的数目。
+static const int LaneMasks[5] = { 0, 1, 3, 7, 15 };
+// 射线方向的分量为 0 时以该值代替，使包围盒的求交不出现 0 * inf。
+static const float MinDirection = 1e-20f;
+// 实例包围盒相对于其尺寸的放大比例。
+static const float BoundsMargin = 1e-3f;
+
+PickRay UnprojectScreenPoint(float x, float y, int width, int height, const mat4& modelview, const mat4& projection)
+{
+    // 规格化设备坐标，y 轴向上。
+    float nx = 2 * x / width - 1;
+    float ny = 1 - 2 * y / height;
+    // Frustum 矩阵将观察坐标 (xe, ye, -1) 投影至 ((a * xe - c), (b * ye - d))，反解即得射线在观察坐标系中的方向。
+    vec3 eyeDirection((nx + projection.z.x) / projection.x.x, (ny + projection.z.y) / projection.y.y, -1);
+
+    // 观察坐标 = 模型坐标 * A + T（行向量），因而模型坐标 = (观察坐标 - T) * A^-1，A^-1 由伴随矩阵求得。
+    const mat4& m = modelview;
+    float c00 = m.y.y * m.z.z - m.y.z * m.z.y;
+    float c01 = m.y.z * m.z.x - m.y.x * m.z.z;
+    float c02 = m.y.x * m.z.y - m.y.y * m.z.x;
+    float inverseDeterminant = 1 / (m.x.x * c00 + m.x.y * c01 + m.x.z * c02);
+    mat3 inverse;
+    inverse.x.x = c00 * inverseDeterminant;
+    inverse.y.x = c01 * inverseDeterminant;
+    inverse.z.x = c02 * inverseDeterminant;
+    inverse.x.y = (m.x.z * m.z.y - m.x.y * m.z.z) * inverseDeterminant;
+    inverse.y.y = (m.x.x * m.z.z - m.x.z * m.z.x) * inverseDeterminant;
+    inverse.z.y = (m.x.y * m.z.x - m.x.x * m.z.y) * inverseDeterminant;
+    inverse.x.z = (m.x.y * m.y.z - m.x.z * m.y.y) * inverseDeterminant;
+    inverse.y.z = (m.x.z * m.y.x - m.x.x * m.y.z) * inverseDeterminant;
+    inverse.z.z = (m.x.x * m.y.y - m.x.y * m.y.x) * inverseDeterminant;
+
+    vec3 origin(-m.w.x, -m.w.y, -m.w.z);
+    PickRay ray;
+    ray.Origin = vec3(origin.x * inverse.x.x + origin.y * inverse.y.x + origin.z * inverse.z.x,
+                      origin.x * inverse.x.y + origin.y * inverse.y.y + origin.z * inverse.z.y,
+                      origin.x * inverse.x.z + origin.y * inverse.y.z + origin.z * inverse.z.z);
+    const vec3& e = eyeDirection;
+    ray.Direction = vec3(e.x * inverse.x.x + e.y * inverse.y.x + e.z * inverse.z.x,
+                         e.x * inverse.x.y + e.y * inverse.y.y + e.z * inverse.z.y,
+                         e.x * inverse.x.z + e.y * inverse.y.z + e.z * inverse.z.z).Normalized();
+    return ray;
+}
+
+// 在实例的单位坐标系中求交：射线的起点先沿射线移至距实例中心最近的一点（参数 start），再换算为 o = (起点 - Position) / Scale，
+// d = Direction / Scale，交点参数即为 start 加上方程的根。实例远小于其与观察者的距离时，直接以原点求解的二次方程的系数很大，
+// 判别式相消后几乎只剩舍入误差，掠过边缘的射线是否命中将取决于运算顺序。
+// 椎体侧面满足 x^2 + z^2 = k * (y - 1)^2，k = (radius / height)^2，代入 o + t * d 得 a * t^2 + 2 * b * t + c = 0；
+// 两个根以 q = -(b + sign(b) * sqrt(b^2 - a * c)) 分别求得 q / a 与 c / q，避免 b^2 远大于 a * c 时的相消误差。
+// a 为 0（射线与侧面的母线平行）时前者为无穷大，后者即为唯一的根。y 不在 [1 - height, 1] 内的根位于上方的另一半锥面或底盘之下。
+bool IntersectConeInstance(const PickRay& ray, const PickInstance& instance, float radius, float height, float& distance)
+{
+    float inverseScale = 1 / instance.Scale;
+    vec3 p(instance.Position.x - ray.Origin.x, instance.Position.y - ray.Origin.y, instance.Position.z - ray.Origin.z);
+    float start = p.x * ray.Direction.x + p.y * ray.Direction.y + p.z * ray.Direction.z;
+    vec3 o((start * ray.Direction.x - p.x) * inverseScale, (start * ray.Direction.y - p.y) * inverseScale,
+           (start * ray.Direction.z - p.z) * inverseScale);
+    vec3 d(ray.Direction.x * inverseScale, ray.Direction.y * inverseScale, ray.Direction.z * inverseScale);
+    float k = radius * radius / (height * height);
+    float bottom = 1 - height;
+    float oy = o.y - 1;
+    float a = d.x * d.x + d.z * d.z - k * (d.y * d.y);
+    float b = o.x * d.x + o.z * d.z - k * (oy * d.y);
+    float c = o.x * o.x + o.z * o.z - k * (oy * oy);
+    float discriminant = b * b - a * c;
+
+    float best = FLT_MAX;
+    if (discriminant >= 0) {
+        float s = std::sqrt(discriminant);
+        float q = -(b + (b >= 0 ? s : -s));
+        float roots[2] = { q / a, c / q };
+        for (int i = 0; i < 2; ++i) {
+            float t = start + roots[i];
+            float y = o.y + roots[i] * d.y;
+            if (t >= 0 && t < best && y >= bottom && y <= 1)
+                best = t;
+        }
+    }
+    float root = (bottom - o.y) / d.y;
+    float t = start + root;
+    float x = o.x + root * d.x;
+    float z = o.z + root * d.z;
+    if (t >= 0 && t < best && x * x + z * z <= radius * radius)
+        best = t;
+    if (best == FLT_MAX)
+        return false;
+    distance = best;
+    return true;
+}
+
+void RayPicker::BoundsArray::Resize(size_t count)
+{
+    Count = count;
+    size_t padded = (count + 3) & ~(size_t) 3;
+    std::vector<float>* arrays[] = { &MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ };
+    for (int i = 0; i < 6; ++i)
+        arrays[i]->assign(padded, 0);
+}
+
+void RayPicker::BoundsArray::Set(size_t i, const vec3& boundsMin, const vec3& boundsMax)
+{
+    MinX[i] = boundsMin.x; MinY[i] = boundsMin.y; MinZ[i] = boundsMin.z;
+    MaxX[i] = boundsMax.x; MaxY[i] = boundsMax.y; MaxZ[i] = boundsMax.z;
+}
+
+void RayPicker::BoundsArray::Merge(size_t i, const vec3& boundsMin, const vec3& boundsMax)
+{
+    MinX[i] = std::min(MinX[i], boundsMin.x); MinY[i] = std::min(MinY[i], boundsMin.y); MinZ[i] = std::min(MinZ[i], boundsMin.z);
+    MaxX[i] = std::max(MaxX[i], boundsMax.x); MaxY[i] = std::max(MaxY[i], boundsMax.y); MaxZ[i] = std::max(MaxZ[i], boundsMax.z);
+}
+
+RayPicker::RayPicker(float radius, float height) : m_radius(radius), m_height(height), m_count(0)
+{
+    m_clusters.Resize(0);
+    m_groups.Resize(0);
+}
+
+// 将 10 位整数的各位间隔两位展开，三个坐标交错即为 30 位的 Morton 码。
+static uint32_t SpreadBits(uint32_t v)
+{
+    v &= 0x3ff;
+    v = (v | v << 16) & 0x030000ff;
+    v = (v | v << 8) & 0x0300f00f;
+    v = (v | v << 4) & 0x030c30c3;
+    v = (v | v << 2) & 0x09249249;
+    return v;
+}
+
+void RayPicker::SetInstances(const PickInstance* instances, size_t count)
+{
+    m_count = count;
+    // 包围盒略微放大，使掠过边缘的射线不会因包围盒求交的舍入误差而被错误地排除。
+    float margin = std::max(m_radius, m_height) * BoundsMargin;
+    vec3 localMin(-m_radius - margin, 1 - m_height - margin, -m_radius - margin);
+    vec3 localMax(m_radius + margin, 1 + margin, m_radius + margin);
+
+    // 相邻的实例在空间上也相邻，各簇与各组的包围盒因而紧凑。
+    vec3 centerMin(FLT_MAX, FLT_MAX, FLT_MAX);
+    vec3 centerMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    for (size_t i = 0; i < count; ++i) {
+        const vec3& p = instances[i].Position;
+        centerMin = vec3(std::min(centerMin.x, p.x), std::min(centerMin.y, p.y), std::min(centerMin.z, p.z));
+        centerMax = vec3(std::max(centerMax.x, p.x), std::max(centerMax.y, p.y), std::max(centerMax.z, p.z));
+    }
+    vec3 extent(std::max(centerMax.x - centerMin.x, 1e-6f), std::max(centerMax.y - centerMin.y, 1e-6f),
+                std::max(centerMax.z - centerMin.z, 1e-6f));
+    std::vector<std::pair<uint32_t, uint32_t> > order(count);
+    for (size_t i = 0; i < count; ++i) {
+        const vec3& p = instances[i].Position;
+        uint32_t x = (uint32_t) ((p.x - centerMin.x) / extent.x * 1023);
+        uint32_t y = (uint32_t) ((p.y - centerMin.y) / extent.y * 1023);
+        uint32_t z = (uint32_t) ((p.z - centerMin.z) / extent.z * 1023);
+        order[i] = std::make_pair(SpreadBits(x) | SpreadBits(y) << 1 | SpreadBits(z) << 2, (uint32_t) i);
+    }
+    std::sort(order.begin(), order.end());
+
+    size_t padded = (count + 3) & ~(size_t) 3;
+    m_x.assign(padded, 0);
+    m_y.assign(padded, 0);
+    m_z.assign(padded, 0);
+    m_inverseScale.assign(padded, 0);
+    m_ids.assign(padded, -1);
+    size_t clusterCount = (count + PickClusterSize - 1) / PickClusterSize;
+    m_clusters.Resize(clusterCount);
+    m_groups.Resize((clusterCount + PickGroupSize - 1) / PickGroupSize);
+    for (size_t i = 0; i < count; ++i) {
+        const PickInstance& instance = instances[order[i].second];
+        m_x[i] = instance.Position.x;
+        m_y[i] = instance.Position.y;
+        m_z[i] = instance.Position.z;
+        m_inverseScale[i] = 1 / instance.Scale;
+        m_ids[i] = instance.Id;
+
+        vec3 boundsMin(instance.Position.x + localMin.x * instance.Scale, instance.Position.y + localMin.y * instance.Scale,
+                       instance.Position.z + localMin.z * instance.Scale);
+        vec3 boundsMax(instance.Position.x + localMax.x * instance.Scale, instance.Position.y + localMax.y * instance.Scale,
+                       instance.Position.z + localMax.z * instance.Scale);
+        size_t cluster = i / PickClusterSize;
+        size_t group = cluster / PickGroupSize;
+        if (i % PickClusterSize == 0)
+            m_clusters.Set(cluster, boundsMin, boundsMax);
+        else
+            m_clusters.Merge(cluster, boundsMin, boundsMax);
+        if (i % (PickClusterSize * PickGroupSize) == 0)
+            m_groups.Set(group, boundsMin, boundsMax);
+        else
+            m_groups.Merge(group, boundsMin, boundsMax);
+    }
+}
+
+// 一条射线的各分量，复制至 4 个分量中。
+struct PickRayLanes {
+    Float4 OriginX, OriginY, OriginZ;
+    Float4 DirectionX, DirectionY, DirectionZ;
+    Float4 InverseX, InverseY, InverseZ;
+};
+
+static float SafeDirection(float d)
+{
+    return std::fabs(d) >= MinDirection ? d : (d < 0 ? -MinDirection : MinDirection);
+}
+
+// 射线与第 i 至 i + 3 个包围盒的求交（slab 方法），返回进入距离小于 best 的包围盒的位掩码。
+static int IntersectBounds4(const float* minX, const float* minY, const float* minZ, const float* maxX, const float* maxY,
+                            const float* maxZ, const PickRayLanes& ray, Float4 best)
+{
+    Float4 x0 = Mul4(Sub4(Load4(minX), ray.OriginX), ray.InverseX);
+    Float4 x1 = Mul4(Sub4(Load4(maxX), ray.OriginX), ray.InverseX);
+    Float4 y0 = Mul4(Sub4(Load4(minY), ray.OriginY), ray.InverseY);
+    Float4 y1 = Mul4(Sub4(Load4(maxY), ray.OriginY), ray.InverseY);
+    Float4 z0 = Mul4(Sub4(Load4(minZ), ray.OriginZ), ray.InverseZ);
+    Float4 z1 = Mul4(Sub4(Load4(maxZ), ray.OriginZ), ray.InverseZ);
+    Float4 enter = Max4(Max4(Min4(x0, x1), Min4(y0, y1)), Min4(z0, z1));
+    Float4 exit = Min4(Min4(Max4(x0, x1), Max4(y0, y1)), Max4(z0, z1));
+    Mask4 hit = And4(And4(LessEqual4(enter, exit), GreaterEqual4(exit, Splat4(0))), Less4(enter, best));
+    return MaskBits4(hit);
+}
+
+void RayPicker::Pick(const PickRay* rays, size_t count, PickHit* hits, float maxDistance, PickStats* stats) const
+{
+    const Float4 zero = Splat4(0);
+    const Float4 one = Splat4(1);
+    const Float4 k = Splat4(m_radius * m_radius / (m_height * m_height));
+    const Float4 bottom = Splat4(1 - m_height);
+    const Float4 radiusSquared = Splat4(m_radius * m_radius);
+    PickStats local = {};
+
+    for (size_t r = 0; r < count; ++r) {
+        const PickRay& source = rays[r];
+        PickRayLanes ray;
+        ray.OriginX = Splat4(source.Origin.x);
+        ray.OriginY = Splat4(source.Origin.y);
+        ray.OriginZ = Splat4(source.Origin.z);
+        ray.DirectionX = Splat4(source.Direction.x);
+        ray.DirectionY = Splat4(source.Direction.y);
+        ray.DirectionZ = Splat4(source.Direction.z);
+        ray.InverseX = Splat4(1 / SafeDirection(source.Direction.x));
+        ray.InverseY = Splat4(1 / SafeDirection(source.Direction.y));
+        ray.InverseZ = Splat4(1 / SafeDirection(source.Direction.z));
+        float best = maxDistance;
+        int32_t bestId = -1;
+
+        for (size_t g = 0; g < m_groups.Count; g += 4) {
+            int groupBits = IntersectBounds4(&m_groups.MinX[g], &m_groups.MinY[g], &m_groups.MinZ[g], &m_groups.MaxX[g],
+                                             &m_groups.MaxY[g], &m_groups.MaxZ[g], ray, Splat4(best));
+            groupBits &= LaneMasks[std::min<size_t>(4, m_groups.Count - g)];
+            local.BoundsTested += std::min<size_t>(4, m_groups.Count - g);
+            for (int groupLane = 0; groupLane < 4; ++groupLane) {
+                if (!(groupBits & 1 << groupLane))
+                    continue;
+                size_t firstCluster = (g + groupLane) * PickGroupSize;
+                size_t endCluster = std::min(firstCluster + PickGroupSize, m_clusters.Count);
+                for (size_t cluster = firstCluster; cluster < endCluster; cluster += 4) {
+                    int clusterBits = IntersectBounds4(&m_clusters.MinX[cluster], &m_clusters.MinY[cluster], &m_clusters.MinZ[cluster],
+                                                       &m_clusters.MaxX[cluster], &m_clusters.MaxY[cluster], &m_clusters.MaxZ[cluster], ray,
+                                                       Splat4(best));
+                    clusterBits &= LaneMasks[std::min<size_t>(4, endCluster - cluster)];
+                    local.BoundsTested += std::min<size_t>(4, endCluster - cluster);
+                    for (int clusterLane = 0; clusterLane < 4; ++clusterLane) {
+                        if (!(clusterBits & 1 << clusterLane))
+                            continue;
+                        size_t first = (cluster + clusterLane) * PickClusterSize;
+                        size_t end = std::min(first + PickClusterSize, m_count);
+                        for (size_t i = first; i < end; i += 4) {
+                            // 与 IntersectConeInstance() 相同的计算，每次处理 4 个实例。NaN 与无穷大在下面的比较中自然被排除。
+                            Float4 inverseScale = Load4(&m_inverseScale[i]);
+                            Float4 px = Sub4(Load4(&m_x[i]), ray.OriginX);
+                            Float4 py = Sub4(Load4(&m_y[i]), ray.OriginY);
+                            Float4 pz = Sub4(Load4(&m_z[i]), ray.OriginZ);
+                            Float4 start = Add4(Add4(Mul4(px, ray.DirectionX), Mul4(py, ray.DirectionY)), Mul4(pz, ray.DirectionZ));
+                            Float4 ox = Mul4(Sub4(Mul4(start, ray.DirectionX), px), inverseScale);
+                            Float4 oy = Mul4(Sub4(Mul4(start, ray.DirectionY), py), inverseScale);
+                            Float4 oz = Mul4(Sub4(Mul4(start, ray.DirectionZ), pz), inverseScale);
+                            Float4 dx = Mul4(ray.DirectionX, inverseScale);
+                            Float4 dy = Mul4(ray.DirectionY, inverseScale);
+                            Float4 dz = Mul4(ray.DirectionZ, inverseScale);
+                            Float4 apexY = Sub4(oy, one);
+                            Float4 a = Sub4(Add4(Mul4(dx, dx), Mul4(dz, dz)), Mul4(k, Mul4(dy, dy)));
+                            Float4 b = Sub4(Add4(Mul4(ox, dx), Mul4(oz, dz)), Mul4(k, Mul4(apexY, dy)));
+                            Float4 c = Sub4(Add4(Mul4(ox, ox), Mul4(oz, oz)), Mul4(k, Mul4(apexY, apexY)));
+                            Float4 discriminant = Sub4(Mul4(b, b), Mul4(a, c));
+                            Float4 s = Sqrt4(Max4(discriminant, zero));
+                            Float4 q = Sub4(zero, Add4(b, Select4(GreaterEqual4(b, zero), s, Sub4(zero, s))));
+                            Mask4 real = GreaterEqual4(discriminant, zero);
+
+                            Float4 bestLanes = Splat4(best);
+                            Float4 nearest = bestLanes;
+                            Float4 roots[2] = { Div4(q, a), Div4(c, q) };
+                            for (int n = 0; n < 2; ++n) {
+                                Float4 t = Add4(start, roots[n]);
+                                Float4 y = Add4(oy, Mul4(roots[n], dy));
+                                Mask4 valid = And4(And4(real, GreaterEqual4(t, zero)), Less4(t, nearest));
+                                valid = And4(valid, And4(GreaterEqual4(y, bottom), LessEqual4(y, one)));
+                                nearest = Select4(valid, t, nearest);
+                            }
+                            Float4 root = Div4(Sub4(bottom, oy), dy);
+                            Float4 t = Add4(start, root);
+                            Float4 x = Add4(ox, Mul4(root, dx));
+                            Float4 z = Add4(oz, Mul4(root, dz));
+                            Mask4 onDisk = And4(And4(GreaterEqual4(t, zero), Less4(t, nearest)),
+                                                LessEqual4(Add4(Mul4(x, x), Mul4(z, z)), radiusSquared));
+                            nearest = Select4(onDisk, t, nearest);
+
+                            size_t lanes = std::min<size_t>(4, end - i);
+                            local.InstancesTested += lanes;
+                            int hitBits = MaskBits4(Less4(nearest, bestLanes)) & LaneMasks[lanes];
+                            if (!hitBits)
+                                continue;
+                            float distances[4];
+                            Store4(distances, nearest);
+                            for (int lane = 0; lane < 4; ++lane) {
+                                if ((hitBits & 1 << lane) && distances[lane] < best) {
+                                    best = distances[lane];
+                                    bestId = m_ids[i + lane];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        hits[r].Instance = bestId;
+        hits[r].Distance = best;
+        local.Hits += bestId >= 0;
+    }
+    if (stats) {
+        local.Rays = count;
+        stats->Rays += local.Rays;
+        stats->Hits += local.Hits;
+        stats->BoundsTested += local.BoundsTested;
+        stats->InstancesTested += local.InstancesTested;
+    }
+}
+
+PickHit RayPicker::Pick(const PickRay& ray, float maxDistance) const
+{
+    PickHit hit;
+    Pick(&ray, 1, &hit, maxDistance);
+    return hit;
+}
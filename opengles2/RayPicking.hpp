@@ -0,0 +1,91 @@
+//
+//  RayPicking.hpp
+//  opengles2
+//
+//  在 CPU 上以射线拾取椎体实例：将触摸点反投影为射线，与解析形式的椎体侧面及底盘求交，返回最近的实例。
+//
+/*
+ 以 glReadPixels 读回颜色或深度的拾取方式须等待 GPU 完成当前帧，会使管线停顿；椎体与底盘均有解析形式，在 CPU 上求交更快。
+ 实例即 Mesh.hpp 中的单位椎体经缩放与平移（与 StreamingScene 相同：p * Scale + Position），椎体的顶点位于 y = 1，
+ 底盘位于 y = 1 - height。射线与椎体侧面的交点由二次方程求得，与底盘的交点则为与平面 y = 1 - height 的交点。
+
+ RayPicker 批量处理射线：实例按包围盒中心的 Morton 码排序，以 SoA 存储，每次以 SIMD 计算一条射线与 4 个实例的交点（参见 Float4.hpp）。
+ 预先求交的包围盒分为两级：每 PickClusterSize 个相邻实例构成一个簇，每 PickGroupSize 个簇构成一组；
+ 射线先与各组的包围盒求交（同样每次 4 个），再进入相交的组逐一测试其中的簇，最后才计算簇内实例的交点。
+ 当前最近交点之后的包围盒不再测试，因此大多数射线只需计算极少数实例。
+ 距离为模型坐标系中沿射线的长度；Modelview 为刚体变换时即为观察坐标系中的距离。
+ */
+
+#ifndef RayPicking_hpp
+#define RayPicking_hpp
+
+#include "Matrix.hpp"
+#include "Mesh.hpp"
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// 每个簇包含的实例数与每组包含的簇数，前者须为 4 的倍数。
+static const size_t PickClusterSize = 16;
+static const size_t PickGroupSize = 16;
+
+struct PickRay {
+    vec3 Origin;
+    vec3 Direction;                     // 单位向量
+};
+
+struct PickInstance {
+    vec3 Position;
+    float Scale;                        // 须大于 0
+    int32_t Id;
+};
+
+struct PickHit {
+    int32_t Instance;                   // 命中实例的 Id，未命中时为 -1
+    float Distance;
+};
+
+struct PickStats {
+    uint64_t Rays;
+    uint64_t Hits;
+    uint64_t BoundsTested;              // 射线与组、簇包围盒的求交次数
+    uint64_t InstancesTested;           // 射线与实例的求交次数
+};
+
+// 将屏幕坐标（原点位于左上角、y 轴向下，与 UIKit 的触摸坐标一致）反投影为模型坐标系中的射线。
+// projection 须由 mat4::Frustum 构造，射线因而由观察者所在的原点出发；modelview 须可逆，且不含投影。
+PickRay UnprojectScreenPoint(float x, float y, int width, int height, const mat4& modelview, const mat4& projection);
+
+// 逐一计算单条射线与单个实例的交点，作为 RayPicker 的参照实现。命中时返回 true 并写入不小于 0 的最近距离。
+bool IntersectConeInstance(const PickRay& ray, const PickInstance& instance, float radius, float height, float& distance);
+
+class RayPicker {
+public:
+    explicit RayPicker(float radius = ConeRadius, float height = ConeHeight);
+    // 复制实例并重建包围盒，实例移动后须重新调用。
+    void SetInstances(const PickInstance* instances, size_t count);
+    size_t InstanceCount() const { return m_count; }
+    // 对每条射线求距离在 [0, maxDistance) 内的最近交点，stats 不为 0 时累加统计数据。
+    void Pick(const PickRay* rays, size_t count, PickHit* hits, float maxDistance = FLT_MAX, PickStats* stats = 0) const;
+    PickHit Pick(const PickRay& ray, float maxDistance = FLT_MAX) const;
+private:
+    // 包围盒以 SoA 存储，长度补齐为 4 的倍数。
+    struct BoundsArray {
+        std::vector<float> MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+        size_t Count;
+        void Resize(size_t count);
+        void Set(size_t i, const vec3& boundsMin, const vec3& boundsMax);
+        void Merge(size_t i, const vec3& boundsMin, const vec3& boundsMax);
+    };
+    float m_radius;
+    float m_height;
+    size_t m_count;
+    // 按 Morton 码排序后的实例，长度补齐为 4 的倍数，补齐部分的 InverseScale 为 0。
+    std::vector<float> m_x, m_y, m_z, m_inverseScale;
+    std::vector<int32_t> m_ids;
+    BoundsArray m_clusters;
+    BoundsArray m_groups;
+};
+
+#endif /* RayPicking_hpp */
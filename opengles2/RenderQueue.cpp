@@ -0,0 +1,135 @@
+//
+//  RenderQueue.cpp
+//  opengles2
+//
+
+#include "RenderQueue.hpp"
+#include <string.h>
+#include <algorithm>
+
+static const int SequenceBits = 19;
+static const int DepthBits = 24;
+static const int SourceBits = 12;
+static const int ProgramBits = 8;
+static const uint64_t SequenceMask = (uint64_t(1) << SequenceBits) - 1;
+static const uint32_t MaxDepth = (1u << DepthBits) - 1;
+
+void RadixSort64(uint64_t* keys, uint64_t* scratch, size_t count)
+{
+    uint64_t* source = keys;
+    uint64_t* destination = scratch;
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t histogram[256];
+        memset(histogram, 0, sizeof(histogram));
+        for (size_t i = 0; i < count; ++i)
+            histogram[(source[i] >> shift) & 0xff]++;
+        // 该字节在所有键上取值相同，本趟不会改变顺序。
+        if (count == 0 || histogram[(source[0] >> shift) & 0xff] == count)
+            continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit) {
+            size_t n = histogram[digit];
+            histogram[digit] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; ++i)
+            destination[histogram[(source[i] >> shift) & 0xff]++] = source[i];
+        std::swap(source, destination);
+    }
+    if (source != keys)
+        memcpy(keys, source, count * sizeof(uint64_t));
+}
+
+RenderQueue::RenderQueue() : m_nearDepth(0), m_farDepth(1)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void RenderQueue::SetDepthRange(float nearDepth, float farDepth)
+{
+    m_nearDepth = nearDepth;
+    m_farDepth = farDepth;
+}
+
+void RenderQueue::Clear()
+{
+    m_items.clear();
+    m_keys.clear();
+    m_order.clear();
+}
+
+bool RenderQueue::Push(const DrawItem& item)
+{
+    if (m_items.size() >= MaxItems)
+        return false;
+    m_keys.push_back(MakeSortKey(item, (uint32_t) m_items.size()));
+    m_items.push_back(item);
+    return true;
+}
+
+uint64_t RenderQueue::MakeSortKey(const DrawItem& item, uint32_t sequence) const
+{
+    // 视图空间沿 -Z 方向观察；行向量约定下，中心点的视图坐标 z 分量由 Modelview 的第三列给出。
+    const mat4& m = item.Modelview;
+    vec3 center = (item.BoundsMin + item.BoundsMax) / 2;
+    float viewZ = center.x * m.x.z + center.y * m.y.z + center.z * m.z.z + m.w.z;
+    if (item.UseQuaternion) {
+        vec3 p(center.x * m.x.x + center.y * m.y.x + center.z * m.z.x + m.w.x,
+               center.x * m.x.y + center.y * m.y.y + center.z * m.z.y + m.w.y, viewZ);
+        viewZ = item.Transform.Apply(p).z;
+    }
+    float t = (-viewZ - m_nearDepth) / (m_farDepth - m_nearDepth);
+    t = std::max(0.0f, std::min(1.0f, t));
+    uint64_t depth = (uint64_t) (t * MaxDepth);
+    uint64_t program = item.Program & ((1u << ProgramBits) - 1);
+    uint64_t source = item.VertexSource & ((1u << SourceBits) - 1);
+
+    uint64_t key;
+    if (item.Translucent) {
+        key = uint64_t(1) << 63;
+        key |= (MaxDepth - depth) << (SequenceBits + SourceBits + ProgramBits);
+        key |= program << (SequenceBits + SourceBits);
+        key |= source << SequenceBits;
+    } else {
+        key = program << (SequenceBits + DepthBits + SourceBits);
+        key |= source << (SequenceBits + DepthBits);
+        key |= depth << SequenceBits;
+    }
+    return key | sequence;
+}
+
+static uint32_t CountStateChanges(const std::vector<DrawItem>& items, const uint32_t* order)
+{
+    uint32_t changes = 0;
+    for (size_t i = 0; i < items.size(); ++i) {
+        const DrawItem& item = items[order ? order[i] : i];
+        if (i == 0) {
+            changes += 2;
+            continue;
+        }
+        const DrawItem& previous = items[order ? order[i - 1] : i - 1];
+        if (item.Program != previous.Program)
+            changes++;
+        if (item.VertexSource != previous.VertexSource)
+            changes++;
+    }
+    return changes;
+}
+
+void RenderQueue::Sort()
+{
+    m_scratch.resize(m_keys.size());
+    if (!m_keys.empty())
+        RadixSort64(&m_keys[0], &m_scratch[0], m_keys.size());
+
+    m_order.resize(m_keys.size());
+    for (size_t i = 0; i < m_keys.size(); ++i)
+        m_order[i] = (uint32_t) (m_keys[i] & SequenceMask);
+
+    m_stats.Items = (uint32_t) m_items.size();
+    m_stats.UnsortedStateChanges = CountStateChanges(m_items, 0);
+    m_stats.StateChanges = m_order.empty() ? 0 : CountStateChanges(m_items, &m_order[0]);
+    if (m_stats.UnsortedStateChanges > m_stats.StateChanges)
+        m_stats.TotalStateChangesSaved += m_stats.UnsortedStateChanges - m_stats.StateChanges;
+}
@@ -0,0 +1,113 @@
+//
+//  RenderQueue.hpp
+//  opengles2
+//
+//  按 64 位排序键组织绘制命令的渲染队列。
+//
+/*
+ 每一帧，渲染器将全部绘制命令（DrawItem）加入队列，由 Sort() 以基数排序（O(n)）按排序键排列后再依次提交。
+ 排序键自高位至低位的布局如下：
+   不透明物体：  [63] 0 | [62..55] 着色器程序 | [54..43] 顶点源 | [42..19] 视图深度（由近至远） | [18..0] 加入顺序
+   半透明物体：  [63] 1 | [62..39] 反转的视图深度（由远至近） | [38..31] 着色器程序 | [30..19] 顶点源 | [18..0] 加入顺序
+ 因此不透明物体按状态聚集，状态相同时由近至远绘制以充分利用 early-Z；半透明物体则在全部不透明物体之后由远至近绘制。
+ 着色器程序与顶点源仅取标识符的低位参与排序，标识符冲突只会影响排序质量，并不影响绘制的正确性。
+ 最低位的加入顺序既保证了排序的稳定性，也使排序后无需额外的索引数组；每帧最多容纳 MaxItems 个绘制命令。
+ */
+
+#ifndef RenderQueue_hpp
+#define RenderQueue_hpp
+
+#include "Quaternion.hpp"
+#include <stdint.h>
+#include <vector>
+
+struct DrawAttribute {
+    bool Enabled;
+    uint32_t Type;              // GL_FLOAT、GL_SHORT 等
+    uint32_t Components;
+    bool Normalized;
+    const void* Pointer;        // 客户端数组指针，或 VertexBuffer 内的字节偏移
+};
+
+// 以四元数表示的旋转与随后的平移，由顶点着色器展开（参见 Shaders/Quaternion.vert），每个物体只需上传 7 个浮点数，
+// CPU 上也无需构建矩阵。Blend 不为 0 时着色器在 Rotation 与 RotationEnd 之间做归一化线性插值（nlerp），动画插值也交给 GPU。
+// 成员的布局即着色器中的 vec4 Transform[3]，前两项（不插值时）或全部三项以一次 glUniform4fv 上传。
+struct QuaternionTransform {
+    Quaternion Rotation;
+    vec3 Translation;
+    float Blend;
+    Quaternion RotationEnd;
+    Quaternion BlendedRotation() const { return Blend ? Rotation.Nlerp(Blend, RotationEnd) : Rotation; }
+    // 与顶点着色器相同的变换。
+    vec3 Apply(const vec3& p) const
+    {
+        Quaternion q = BlendedRotation();
+        vec3 u(q.x, q.y, q.z);
+        vec3 t = u.Cross(p) * 2;
+        return p + t * q.w + u.Cross(t) + Translation;
+    }
+    // 等价的变换矩阵，供遮挡剔除等仍需矩阵的 CPU 代码使用。
+    mat4 ToMatrix() const
+    {
+        return mat4(BlendedRotation().ToMatrix()) * mat4::Translate(Translation.x, Translation.y, Translation.z);
+    }
+};
+
+struct DrawItem {
+    uint32_t Program;
+    uint32_t VertexSource;      // 标识一组顶点数据（缓冲区或客户端数组），用于排序与状态缓存
+    uint32_t VertexBuffer;      // 0 表示客户端顶点数组
+    uint32_t Stride;
+    DrawAttribute Position;
+    DrawAttribute Color;
+    DrawAttribute TexCoord;
+    uint32_t Mode;              // GL_TRIANGLES、GL_TRIANGLE_STRIP 等
+    uint32_t First;
+    uint32_t Count;
+    uint32_t IndexBuffer;       // 0 表示非索引绘制
+    uint32_t IndexType;
+    mat4 Modelview;             // UseQuaternion 为 true 时只包含旋转之前的变换（例如反量化矩阵）
+    bool UseQuaternion;
+    QuaternionTransform Transform;
+    vec3 BoundsMin;             // 与顶点坐标处于同一坐标系的包围盒，其中心用于计算视图深度，
+    vec3 BoundsMax;             // 也用于遮挡剔除
+    bool Translucent;
+};
+
+struct RenderQueueStats {
+    uint32_t Items;
+    uint32_t StateChanges;              // 排序后提交所需的状态切换次数（程序或顶点源变化）
+    uint32_t UnsortedStateChanges;      // 按加入顺序提交时所需的状态切换次数
+    uint64_t TotalStateChangesSaved;    // 自创建以来累计节省的状态切换次数
+};
+
+class RenderQueue {
+public:
+    static const uint32_t MaxItems = 1 << 19;
+    RenderQueue();
+    // 设置视图深度的量化范围，通常与投影矩阵的近、远裁剪面一致。
+    void SetDepthRange(float nearDepth, float farDepth);
+    void Clear();
+    // 超出 MaxItems 的绘制命令将被丢弃并返回 false。
+    bool Push(const DrawItem& item);
+    void Sort();
+    size_t Size() const { return m_order.size(); }
+    // 按排序后的顺序访问绘制命令，仅在 Sort() 之后有效。
+    const DrawItem& operator[](size_t i) const { return m_items[m_order[i]]; }
+    const RenderQueueStats& Stats() const { return m_stats; }
+private:
+    uint64_t MakeSortKey(const DrawItem& item, uint32_t sequence) const;
+    float m_nearDepth;
+    float m_farDepth;
+    std::vector<DrawItem> m_items;
+    std::vector<uint64_t> m_keys;
+    std::vector<uint64_t> m_scratch;
+    std::vector<uint32_t> m_order;
+    RenderQueueStats m_stats;
+};
+
+// 对 keys 做最低位优先的基数排序（每趟 8 位），scratch 为等长的临时存储。
+// 所有键在某一字节上取值相同时跳过该趟，因此高位多为零的键只需很少的趟数。
+void RadixSort64(uint64_t* keys, uint64_t* scratch, size_t count);
+
+#endif /* RenderQueue_hpp */
@@ -0,0 +1,11 @@
+const char* BlitFragmentShader = STRINGIFY(
+
+varying mediump vec2 TexCoord;
+uniform sampler2D Scene;
+uniform mediump vec2 TexCoordMax;
+
+void main(void)
+{
+    gl_FragColor = texture2D(Scene, min(TexCoord, TexCoordMax));
+}
+);
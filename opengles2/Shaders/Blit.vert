@@ -0,0 +1,12 @@
+const char* BlitVertexShader = STRINGIFY(
+
+attribute vec2 Position;
+varying vec2 TexCoord;
+uniform vec2 TexCoordScale;
+
+void main(void)
+{
+    TexCoord = (Position * 0.5 + 0.5) * TexCoordScale;
+    gl_Position = vec4(Position, 0.0, 1.0);
+}
+);
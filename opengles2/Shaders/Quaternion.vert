@@ -0,0 +1,23 @@
+const char* QuaternionVertexShader = STRINGIFY(
+
+attribute vec4 Position;
+attribute vec4 SourceColor;
+attribute vec2 SourceTexCoord;
+varying vec4 DestinationColor;
+varying vec2 TexCoord;
+uniform mat4 Projection;
+uniform mat4 Dequantization;
+uniform vec4 Transform[3];
+
+void main(void)
+{
+    vec4 rotation = Transform[0];
+    vec4 end = dot(rotation, Transform[2]) < 0.0 ? -Transform[2] : Transform[2];
+    vec4 q = normalize(mix(rotation, end, Transform[1].w));
+    vec3 p = (Dequantization * Position).xyz;
+    vec3 t = 2.0 * cross(q.xyz, p);
+    DestinationColor = SourceColor;
+    TexCoord = SourceTexCoord;
+    gl_Position = Projection * vec4(p + q.w * t + cross(q.xyz, t) + Transform[1].xyz, 1.0);
+}
+);
@@ -2,13 +2,16 @@ const char* SimpleVertexShader = STRINGIFY(
 
 attribute vec4 Position;
 attribute vec4 SourceColor;
+attribute vec2 SourceTexCoord;
 varying vec4 DestinationColor;
+varying vec2 TexCoord;
 uniform mat4 Projection;
 uniform mat4 Modelview;
 
 void main(void)
 {
     DestinationColor = SourceColor;
+    TexCoord = SourceTexCoord;
     gl_Position = Projection * Modelview * Position;
 }
 );
@@ -0,0 +1,11 @@
+const char* TexturedFragmentShader = STRINGIFY(
+
+varying lowp vec4 DestinationColor;
+varying mediump vec2 TexCoord;
+uniform sampler2D Texture;
+
+void main(void)
+{
+    gl_FragColor = DestinationColor * texture2D(Texture, TexCoord);
+}
+);
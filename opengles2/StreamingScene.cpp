@@ -0,0 +1,245 @@
+//
+//  StreamingScene.cpp
+//  opengles2
+//
+
+#include "StreamingScene.hpp"
+#include "Tracing.hpp"
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+StreamingScene::StreamingScene(int slices, uint32_t instancesPerChunk, unsigned poolSize)
+    : m_pool(std::max(1u, poolSize)), m_pass(0), m_passProduced(true), m_stopping(false)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_layout.InstanceCount = 0;
+    m_layout.Columns = 1;
+    m_layout.Rows = 0;
+    m_layout.Spacing = 1;
+    m_layout.InstanceScale = 1;
+    m_passLayout = m_layout;
+
+    // 实例模板：椎体三角形带的 (slices + 1) * 2 个顶点，其后为底盘三角扇的 slices + 2 个顶点。
+    std::vector<Vertex> cone, disk;
+    GenerateCone(cone, ConeRadius, ConeHeight, slices);
+    GenerateDisk(disk, ConeRadius, ConeHeight, slices);
+    m_template = cone;
+    m_template.insert(m_template.end(), disk.begin(), disk.end());
+
+    // 16 位索引限制了每个数据块的顶点数。
+    uint32_t vertices = (uint32_t) m_template.size();
+    m_instancesPerChunk = std::max(1u, std::min(instancesPerChunk, 65536u / vertices));
+
+    // 三角形带与三角扇展开为三角形列表，三角形带中奇数编号的三角形交换前两个顶点以保持一致的环绕方向。
+    std::vector<uint16_t> pattern;
+    for (uint32_t k = 0; k + 2 < cone.size(); ++k) {
+        pattern.push_back((uint16_t) (k % 2 ? k + 1 : k));
+        pattern.push_back((uint16_t) (k % 2 ? k : k + 1));
+        pattern.push_back((uint16_t) (k + 2));
+    }
+    uint16_t center = (uint16_t) cone.size();
+    for (int j = 0; j < slices; ++j) {
+        pattern.push_back(center);
+        pattern.push_back((uint16_t) (center + 1 + j));
+        pattern.push_back((uint16_t) (center + 2 + j));
+    }
+    m_indicesPerInstance = (uint32_t) pattern.size();
+    m_indices.reserve(m_indicesPerInstance * m_instancesPerChunk);
+    for (uint32_t i = 0; i < m_instancesPerChunk; ++i)
+        for (size_t k = 0; k < pattern.size(); ++k)
+            m_indices.push_back((uint16_t) (pattern[k] + i * vertices));
+}
+
+StreamingScene::~StreamingScene()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_producerWake.notify_one();
+    if (m_producer.joinable())
+        m_producer.join();
+}
+
+void StreamingScene::SetGrid(uint32_t columns, uint32_t rows, float spacing, float instanceScale)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layout.PointFile.reset();
+    m_layout.Columns = std::max(1u, columns);
+    m_layout.Rows = rows;
+    m_layout.Spacing = spacing;
+    m_layout.InstanceScale = instanceScale;
+    m_layout.InstanceCount = (uint64_t) columns * rows;
+}
+
+bool StreamingScene::SetPointFile(const char* path, float instanceScale)
+{
+    // 在锁外打开并测量文件；生产者只会读取它在某一遍开始时复制的文件，因此这里的 fseek() 不会干扰正在进行的一遍。
+    FILE* file = fopen(path, "rb");
+    long size = 0;
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_layout.PointFile.reset();
+    m_layout.InstanceCount = 0;
+    if (!file) {
+        std::cout << "Unable to open point file " << path << std::endl;
+        return false;
+    }
+    m_layout.PointFile.reset(file, fclose);
+    m_layout.InstanceCount = size > 0 ? (uint64_t) size / sizeof(vec3) : 0;
+    m_layout.InstanceScale = instanceScale;
+    return true;
+}
+
+uint64_t StreamingScene::InstanceCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_layout.InstanceCount;
+}
+
+void StreamingScene::BeginPass()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 缓冲池与生产者线程在第一遍开始时才创建，未使用流式场景的引擎不必为此付出启动时间与内存。
+    if (!m_producer.joinable()) {
+        m_points.resize(m_instancesPerChunk);
+        for (size_t i = 0; i < m_pool.size(); ++i) {
+            m_pool[i].Vertices.resize(m_instancesPerChunk * m_template.size());
+            m_pool[i].FirstInstance = 0;
+            m_pool[i].InstanceCount = 0;
+            m_free.push_back(&m_pool[i]);
+        }
+        m_producer = std::thread(&StreamingScene::ProducerMain, this);
+    }
+    m_free.insert(m_free.end(), m_ready.begin(), m_ready.end());
+    m_ready.clear();
+    m_pass++;
+    m_passProduced = false;
+    m_stats.Passes++;
+    m_producerWake.notify_one();
+}
+
+const SceneChunk* StreamingScene::NextChunk()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_ready.empty() && !m_passProduced) {
+        m_stats.ConsumerStalls++;
+        m_consumerWake.wait(lock, [this]() { return !m_ready.empty() || m_passProduced; });
+    }
+    if (m_ready.empty())
+        return 0;
+    SceneChunk* chunk = m_ready.front();
+    m_ready.pop_front();
+    return chunk;
+}
+
+void StreamingScene::ReleaseChunk(const SceneChunk* chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_free.push_back(const_cast<SceneChunk*>(chunk));
+    }
+    m_producerWake.notify_one();
+}
+
+size_t StreamingScene::PoolBytes() const
+{
+    return m_pool.size() * m_instancesPerChunk * m_template.size() * sizeof(Vertex);
+}
+
+StreamingStats StreamingScene::Stats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    StreamingStats stats = m_stats;
+    stats.SceneInstances = m_layout.InstanceCount;
+    stats.PoolBytes = PoolBytes();
+    return stats;
+}
+
+// 生产者线程：等待新的一遍，随后逐块生成，直到全部实例生成完毕或者又开始了新的一遍。
+// 填充顶点时不持有锁，消费者因此可以同时提交其他数据块；填充只读取本遍的布局副本 m_passLayout。
+void StreamingScene::ProducerMain()
+{
+    VCC_TRACE_THREAD_NAME("StreamingScene producer");
+    std::unique_lock<std::mutex> lock(m_mutex);
+    uint64_t pass = 0;
+    while (!m_stopping) {
+        if (pass == m_pass) {
+            m_producerWake.wait(lock);
+            continue;
+        }
+        pass = m_pass;
+        m_passLayout = m_layout;
+        const uint64_t instanceCount = m_passLayout.InstanceCount;
+        if (m_passLayout.PointFile)
+            fseek(m_passLayout.PointFile.get(), 0, SEEK_SET);
+        uint64_t next = 0;
+        while (next < instanceCount && pass == m_pass && !m_stopping) {
+            if (m_free.empty()) {
+                m_stats.ProducerStalls++;
+                m_producerWake.wait(lock, [this, pass]() { return !m_free.empty() || pass != m_pass || m_stopping; });
+                continue;
+            }
+            SceneChunk* chunk = m_free.front();
+            m_free.pop_front();
+            chunk->FirstInstance = next;
+            chunk->InstanceCount = (uint32_t) std::min<uint64_t>(m_instancesPerChunk, instanceCount - next);
+            next += chunk->InstanceCount;
+
+            lock.unlock();
+            FillChunk(*chunk);
+            lock.lock();
+
+            // 填充期间开始了新的一遍，该数据块作废。
+            if (pass != m_pass) {
+                m_free.push_back(chunk);
+                break;
+            }
+            m_ready.push_back(chunk);
+            m_stats.Chunks++;
+            m_stats.Instances += chunk->InstanceCount;
+            m_consumerWake.notify_one();
+        }
+        if (pass == m_pass) {
+            m_passProduced = true;
+            m_consumerWake.notify_one();
+        }
+    }
+}
+
+void StreamingScene::FillChunk(SceneChunk& chunk)
+{
+    VCC_TRACE_SCOPE("FillChunk");
+    const Layout& layout = m_passLayout;
+    FILE* pointFile = layout.PointFile.get();
+    // 点文件在生成期间被截断时，缺少的点位于原点。
+    if (pointFile) {
+        size_t read = fread(&m_points[0], sizeof(vec3), chunk.InstanceCount, pointFile);
+        for (size_t i = read; i < chunk.InstanceCount; ++i)
+            m_points[i] = vec3(0, 0, 0);
+    }
+
+    Vertex* out = &chunk.Vertices[0];
+    float halfColumns = (layout.Columns - 1) * 0.5f;
+    float halfRows = layout.Rows ? (layout.Rows - 1) * 0.5f : 0;
+    for (uint32_t i = 0; i < chunk.InstanceCount; ++i) {
+        vec3 position;
+        if (pointFile) {
+            position = m_points[i];
+        } else {
+            uint64_t index = chunk.FirstInstance + i;
+            float column = (float) (index % layout.Columns);
+            float row = (float) (index / layout.Columns);
+            position = vec3((column - halfColumns) * layout.Spacing, 0, (row - halfRows) * layout.Spacing);
+        }
+        for (size_t v = 0; v < m_template.size(); ++v, ++out) {
+            out->Position = m_template[v].Position * layout.InstanceScale + position;
+            out->Color = m_template[v].Color;
+            out->TexCoord = m_template[v].TexCoord;
+        }
+    }
+}
@@ -0,0 +1,109 @@
+//
+//  StreamingScene.hpp
+//  opengles2
+//
+//  以固定大小的数据块流式生成由大量椎体实例构成的程序化场景。
+//
+/*
+ 场景由位于网格上或来自点文件的椎体实例组成，实例总数可达千万级以上，不可能像 Initialize() 中的单个椎体那样一次性生成全部顶点。
+ StreamingScene 将实例按 instancesPerChunk 个一组划分为数据块，每个数据块的顶点写入缓冲池中的一个缓冲区：
+   生产者线程  从空闲队列取出缓冲区，生成该组实例的顶点后放入就绪队列；
+   消费者      （渲染线程）从就绪队列取出数据块提交绘制，随后将缓冲区归还至空闲队列。
+ 缓冲池的大小固定为 poolSize 个数据块，生产者领先消费者至多 poolSize 块，两者因此相互重叠，内存占用则与场景规模无关。
+ 每个实例由椎体与底盘组成，按三角形列表索引；各数据块内的索引模式完全相同，故索引只需生成一次（Indices()），
+ 块内顶点数不超过 65536，可使用 16 位索引。
+ 点文件（.vccpoints）即连续存储的小端 float 三元组 x y z，不含文件头；生产者每次只读取一个数据块所需的点。
+ 每一遍（pass）以 BeginPass() 开始，NextChunk() 返回 0 时结束；缓冲池与生产者线程在第一次调用 BeginPass() 时才会创建。
+ SetGrid() 与 SetPointFile() 可在任意时刻调用：生产者在每一遍开始时复制当时的场景布局，新的布局自下一遍起生效，
+ 被替换的点文件在生产者不再使用之后才会关闭。
+ */
+
+#ifndef StreamingScene_hpp
+#define StreamingScene_hpp
+
+#include "Mesh.hpp"
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 流式实例采用的片段数，远低于单个椎体的 ConeSlices。
+static const int StreamingSlices = 8;
+
+struct SceneChunk {
+    std::vector<Vertex> Vertices;       // 容量在第一遍开始时一次性分配，此后不再增长
+    uint64_t FirstInstance;
+    uint32_t InstanceCount;
+};
+
+struct StreamingStats {
+    uint64_t Passes;
+    uint64_t Chunks;                    // 累计生成的数据块数
+    uint64_t Instances;                 // 累计生成的实例数
+    uint64_t ProducerStalls;            // 生产者因缓冲池耗尽而等待的次数
+    uint64_t ConsumerStalls;            // 消费者因数据块尚未生成而等待的次数
+    uint64_t SceneInstances;            // 最近一次设置的场景布局中的实例数
+    uint64_t PoolBytes;                 // 缓冲池占用的字节数（PoolBytes()）
+};
+
+class StreamingScene {
+public:
+    StreamingScene(int slices = StreamingSlices, uint32_t instancesPerChunk = 2048, unsigned poolSize = 4);
+    ~StreamingScene();
+    // 以 spacing 为间距在 XZ 平面上居中排列 columns * rows 个实例，instanceScale 为实例相对于单位椎体的缩放。
+    void SetGrid(uint32_t columns, uint32_t rows, float spacing, float instanceScale);
+    // 实例位置取自点文件；无法打开文件时返回 false。
+    bool SetPointFile(const char* path, float instanceScale);
+    // 开始新的一遍生成；上一遍尚未取完的数据块将被丢弃。
+    void BeginPass();
+    // 按实例顺序返回下一个数据块，必要时等待生产者；本遍结束时返回 0。
+    const SceneChunk* NextChunk();
+    void ReleaseChunk(const SceneChunk* chunk);
+    // 最近一次设置的场景布局中的实例数。
+    uint64_t InstanceCount() const;
+    uint32_t VerticesPerInstance() const { return (uint32_t) m_template.size(); }
+    uint32_t IndicesPerInstance() const { return m_indicesPerInstance; }
+    // 一个满数据块的索引，不足一块时只使用前 InstanceCount * IndicesPerInstance() 个。
+    const std::vector<uint16_t>& Indices() const { return m_indices; }
+    // 缓冲池占用的字节数，与场景规模无关。
+    size_t PoolBytes() const;
+    StreamingStats Stats() const;
+private:
+    StreamingScene(const StreamingScene&);
+    StreamingScene& operator=(const StreamingScene&);
+    struct Layout {
+        std::shared_ptr<FILE> PointFile;    // 为空时按网格排列；生产者的副本共享所有权，替换后不会在读取途中关闭
+        uint64_t InstanceCount;
+        uint32_t Columns;
+        uint32_t Rows;
+        float Spacing;
+        float InstanceScale;
+    };
+    void ProducerMain();
+    void FillChunk(SceneChunk& chunk);
+    std::vector<Vertex> m_template;     // 单位椎体与底盘的顶点
+    std::vector<uint16_t> m_indices;
+    uint32_t m_indicesPerInstance;
+    uint32_t m_instancesPerChunk;
+    Layout m_layout;                    // 由 SetGrid()、SetPointFile() 修改，受 m_mutex 保护
+    Layout m_passLayout;                // 生产者在每一遍开始时复制的布局，只由生产者线程访问
+    std::vector<vec3> m_points;         // 生产者读取点文件的暂存区，长度为一个数据块
+
+    std::vector<SceneChunk> m_pool;
+    std::deque<SceneChunk*> m_free;
+    std::deque<SceneChunk*> m_ready;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_producerWake;
+    std::condition_variable m_consumerWake;
+    std::thread m_producer;
+    uint64_t m_pass;                    // 已请求的遍数，生产者据此发现新的一遍
+    bool m_passProduced;                // 当前一遍的全部数据块均已生成
+    bool m_stopping;
+    StreamingStats m_stats;
+};
+
+#endif /* StreamingScene_hpp */
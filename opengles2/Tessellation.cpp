@@ -0,0 +1,27 @@
+//
+//  Tessellation.cpp
+//  opengles2
+//
+
+#include "Tessellation.hpp"
+#include "Tracing.hpp"
+
+void TessellateCone(JobSystem& jobs, std::vector<Vertex>& cone, float radius, float height, int slices)
+{
+    cone.resize(((size_t) slices + 1) * 2);
+    Vertex* vertices = &cone[0];
+    jobs.ParallelFor(cone.size(), TessellationGrain, [=](size_t begin, size_t end) {
+        VCC_TRACE_SCOPE("TessellateCone");
+        GenerateConeVertices(vertices, begin, end, radius, height, slices);
+    });
+}
+
+void TessellateDisk(JobSystem& jobs, std::vector<Vertex>& disk, float radius, float height, int slices)
+{
+    disk.resize((size_t) slices + 2);
+    Vertex* vertices = &disk[0];
+    jobs.ParallelFor(disk.size(), TessellationGrain, [=](size_t begin, size_t end) {
+        VCC_TRACE_SCOPE("TessellateDisk");
+        GenerateDiskVertices(vertices, begin, end, radius, height, slices);
+    });
+}
@@ -0,0 +1,28 @@
+//
+//  Tessellation.hpp
+//  opengles2
+//
+//  借助 JobSystem 在全部核心上并行生成高细分度的椎体与底盘。
+//
+/*
+ 检视模式下片段数可达 10^5–10^7，单线程生成成为重建网格的瓶颈。各顶点均由其编号直接求得（参见 Mesh.hpp 中的
+ GenerateConeVertices() 与 GenerateDiskVertices()），因此先一次性分配存储，再将顶点区间划分为长度为 TessellationGrain
+ 的任务写入各自的区间即可，输出与 GenerateCone()/GenerateDisk() 逐位相同。
+ 容器的容量足够时不会重新分配，参数变化后反复重建同一网格不产生额外的内存分配。
+ 顶点数不超过 TessellationGrain 时直接在调用线程上生成，低细分度的网格没有调度开销。
+ */
+
+#ifndef Tessellation_hpp
+#define Tessellation_hpp
+
+#include "JobSystem.hpp"
+#include "Mesh.hpp"
+#include <vector>
+
+// 每个任务生成的顶点数。
+static const size_t TessellationGrain = 16384;
+
+void TessellateCone(JobSystem& jobs, std::vector<Vertex>& cone, float radius, float height, int slices);
+void TessellateDisk(JobSystem& jobs, std::vector<Vertex>& disk, float radius, float height, int slices);
+
+#endif /* Tessellation_hpp */
@@ -0,0 +1,354 @@
+//
+//  Texture.cpp
+//  opengles2
+//
+
+#include "Texture.hpp"
+#include "Float4.hpp"
+#include "JobSystem.hpp"
+#include "Tracing.hpp"
+
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+
+bool LoadRawImage(const char* path, int width, int height, TextureImage& image)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        std::cout << "Unable to open image " << path << std::endl;
+        return false;
+    }
+    size_t bytes = size_t(width) * height * 4;
+    image.Width = width;
+    image.Height = height;
+    image.Pixels.resize(bytes);
+    // 多出的字节同样说明尺寸与文件不符。
+    bool complete = width > 0 && height > 0 && fread(&image.Pixels[0], 1, bytes, file) == bytes && fgetc(file) == EOF;
+    fclose(file);
+    if (!complete) {
+        std::cout << "Image " << path << " is not a " << width << "x" << height << " RGBA file" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int MipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1) {
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        levels++;
+    }
+    return levels;
+}
+
+size_t MipChainBytes(const std::vector<TextureImage>& levels)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < levels.size(); ++i)
+        bytes += levels[i].Pixels.size();
+    return bytes;
+}
+
+// 每个像素 4 个浮点数（RGBA，[0, 1]），mipmap 链的中间结果。
+struct FloatImage {
+    int Width;
+    int Height;
+    std::vector<float> Pixels;
+};
+
+static const int MaxKernelTaps = 12;
+
+// 缩小一半时目标像素 d 由源像素 2d + First 至 2d + First + Count - 1 加权求得，越界的源像素取最近的边缘像素。
+struct MipKernel {
+    int First;
+    int Count;
+    float Weights[MaxKernelTaps];
+};
+
+static double BesselI0(double x)
+{
+    // 第一类零阶修正贝塞尔函数的级数展开，各项迅速收敛。
+    double sum = 1, term = 1;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+static double Sinc(double x)
+{
+    static const double Pi = 4 * std::atan(1.0);
+    return x == 0 ? 1 : std::sin(Pi * x) / (Pi * x);
+}
+
+static MipKernel MakeKernel(MipFilter filter)
+{
+    MipKernel kernel;
+    if (filter == MipFilterBox) {
+        kernel.First = 0;
+        kernel.Count = 2;
+        kernel.Weights[0] = kernel.Weights[1] = 0.5f;
+        return kernel;
+    }
+    // 以目标像素为单位，源像素 2d + k 的中心与目标像素中心相距 (k - 0.5) / 2；窗口半宽 3、alpha = 4。
+    static const double Width = 3, Alpha = 4;
+    kernel.First = -5;
+    kernel.Count = MaxKernelTaps;
+    double weights[MaxKernelTaps], sum = 0;
+    for (int i = 0; i < kernel.Count; ++i) {
+        double t = (kernel.First + i - 0.5) / 2;
+        double r = t / Width;
+        double window = r * r < 1 ? BesselI0(Alpha * std::sqrt(1 - r * r)) / BesselI0(Alpha) : 0;
+        weights[i] = Sinc(t) * window;
+        sum += weights[i];
+    }
+    for (int i = 0; i < kernel.Count; ++i)
+        kernel.Weights[i] = (float) (weights[i] / sum);
+    return kernel;
+}
+
+static inline int Clamp(int value, int limit)
+{
+    return value < 0 ? 0 : (value >= limit ? limit - 1 : value);
+}
+
+// 源像素：第 1 级直接由 8 位的第 0 级生成（读取时换算为 [0, 1]，与先整体换算结果相同），以免复制一份 16 字节每像素的第 0 级。
+static inline Float4 LoadPixel(const float* p)
+{
+    return Load4(p);
+}
+
+static inline Float4 LoadPixel(const uint8_t* p)
+{
+    float v[4] = { float(p[0]), float(p[1]), float(p[2]), float(p[3]) };
+    return Mul4(Load4(v), Splat4(1.0f / 255));
+}
+
+// 生成 destination 的第 [begin, end) 行，source 为 sourceWidth × sourceHeight 的 RGBA 像素。尺寸为 1 的方向不再缩小，只复制。
+template <typename T>
+static void DownsampleRows(const T* source, int sourceWidth, int sourceHeight, FloatImage& destination, const MipKernel& kernel,
+                           size_t begin, size_t end)
+{
+    bool halveX = destination.Width < sourceWidth;
+    bool halveY = destination.Height < sourceHeight;
+    if (kernel.Count == 2 && halveX && halveY) {
+        // 盒式滤波的两个方向同时缩小时直接求 2×2 平均，省去中间行的读写；加法的次序与一般路径相同，结果逐位一致。
+        Float4 half = Splat4(0.5f);
+        for (size_t y = begin; y < end; ++y) {
+            const T* top = source + 2 * y * sourceWidth * 4;
+            const T* bottom = top + sourceWidth * 4;
+            float* out = &destination.Pixels[y * destination.Width * 4];
+            for (int x = 0; x < destination.Width; ++x) {
+                Float4 left = Add4(Mul4(half, LoadPixel(top + x * 8)), Mul4(half, LoadPixel(bottom + x * 8)));
+                Float4 right = Add4(Mul4(half, LoadPixel(top + x * 8 + 4)), Mul4(half, LoadPixel(bottom + x * 8 + 4)));
+                Store4(out + x * 4, Add4(Mul4(half, left), Mul4(half, right)));
+            }
+        }
+        return;
+    }
+    std::vector<float> row(sourceWidth * 4);
+    for (size_t y = begin; y < end; ++y) {
+        // 纵向：按抽头逐行累加，每次遍历一整行，访问保持连续。
+        if (halveY) {
+            std::fill(row.begin(), row.end(), 0.0f);
+            for (int k = 0; k < kernel.Count; ++k) {
+                const T* in = source + size_t(Clamp(int(2 * y) + kernel.First + k, sourceHeight)) * sourceWidth * 4;
+                Float4 weight = Splat4(kernel.Weights[k]);
+                for (int x = 0; x < sourceWidth; ++x)
+                    Store4(&row[x * 4], Add4(Load4(&row[x * 4]), Mul4(weight, LoadPixel(in + x * 4))));
+            }
+        } else {
+            const T* in = source + y * sourceWidth * 4;
+            for (int x = 0; x < sourceWidth; ++x)
+                Store4(&row[x * 4], LoadPixel(in + x * 4));
+        }
+
+        // 横向。
+        float* out = &destination.Pixels[y * destination.Width * 4];
+        for (int x = 0; x < destination.Width; ++x) {
+            if (!halveX) {
+                Store4(out + x * 4, Load4(&row[x * 4]));
+                continue;
+            }
+            Float4 sum = Splat4(0);
+            for (int k = 0; k < kernel.Count; ++k)
+                sum = Add4(sum, Mul4(Splat4(kernel.Weights[k]), Load4(&row[Clamp(2 * x + kernel.First + k, sourceWidth) * 4])));
+            Store4(out + x * 4, sum);
+        }
+    }
+}
+
+// 将浮点像素 [begin, end) 量化为 RGBA8，超出 [0, 1] 的部分（Kaiser 滤波的过冲）被截断。
+static void QuantizePixels(const float* source, uint8_t* destination, size_t begin, size_t end)
+{
+    Float4 scale = Splat4(255), half = Splat4(0.5f), zero = Splat4(0), one = Splat4(255);
+    for (size_t i = begin; i < end; ++i) {
+        float rounded[4];
+        Store4(rounded, Min4(Max4(Add4(Mul4(Load4(source + i * 4), scale), half), zero), one));
+        for (int c = 0; c < 4; ++c)
+            destination[i * 4 + c] = (uint8_t) rounded[c];
+    }
+}
+
+// 每个任务约处理 16K 个像素。
+static size_t RowGrain(int width)
+{
+    return std::max<size_t>(1, 16384 / std::max(1, width));
+}
+
+static void ForRows(JobSystem* jobs, size_t rows, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+    if (jobs)
+        jobs->ParallelFor(rows, grain, body);
+    else
+        body(0, rows);
+}
+
+void GenerateMipChain(const TextureImage& base, MipFilter filter, std::vector<TextureImage>& levels, JobSystem* jobs)
+{
+    VCC_TRACE_SCOPE("GenerateMipChain");
+    levels.assign(1, base);
+    if (!IsPowerOfTwo(base.Width) || !IsPowerOfTwo(base.Height))
+        return;
+
+    MipKernel kernel = MakeKernel(filter);
+    FloatImage current, next;
+    current.Width = base.Width;
+    current.Height = base.Height;
+
+    // 级别之间存在依赖，逐级生成；同一级别内的各行并行生成并随即量化。
+    int levelCount = MipLevelCount(base.Width, base.Height);
+    for (int level = 1; level < levelCount; ++level) {
+        next.Width = std::max(1, current.Width / 2);
+        next.Height = std::max(1, current.Height / 2);
+        next.Pixels.resize(size_t(next.Width) * next.Height * 4);
+        levels.push_back(TextureImage());
+        TextureImage& image = levels.back();
+        image.Width = next.Width;
+        image.Height = next.Height;
+        image.Pixels.resize(next.Pixels.size());
+        ForRows(jobs, next.Height, RowGrain(next.Width), [&](size_t begin, size_t end) {
+            if (level == 1)
+                DownsampleRows(&base.Pixels[0], base.Width, base.Height, next, kernel, begin, end);
+            else
+                DownsampleRows(&current.Pixels[0], current.Width, current.Height, next, kernel, begin, end);
+            QuantizePixels(&next.Pixels[0], &image.Pixels[0], begin * next.Width, end * next.Width);
+        });
+        current.Pixels.swap(next.Pixels);
+        current.Width = next.Width;
+        current.Height = next.Height;
+    }
+}
+
+// 按 order 的顺序逐行放置，放不下时返回 false。
+static bool ShelfPack(const TextureImage* images, const std::vector<size_t>& order, int padding, int width, int height,
+                      std::vector<AtlasRegion>& regions)
+{
+    int x = 0, y = 0, shelfHeight = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const TextureImage& image = images[order[i]];
+        int paddedWidth = image.Width + 2 * padding;
+        int paddedHeight = image.Height + 2 * padding;
+        if (paddedWidth > width)
+            return false;
+        if (x + paddedWidth > width) {
+            y += shelfHeight;
+            x = 0;
+            shelfHeight = 0;
+        }
+        if (y + paddedHeight > height)
+            return false;
+        AtlasRegion& region = regions[order[i]];
+        region.X = x + padding;
+        region.Y = y + padding;
+        region.Width = image.Width;
+        region.Height = image.Height;
+        x += paddedWidth;
+        shelfHeight = std::max(shelfHeight, paddedHeight);
+    }
+    return true;
+}
+
+bool PackTextureAtlas(const TextureImage* images, size_t count, int padding, int maxSize,
+                      TextureImage& atlas, std::vector<AtlasRegion>& regions)
+{
+    std::vector<size_t> order(count);
+    size_t area = 0;
+    for (size_t i = 0; i < count; ++i) {
+        order[i] = i;
+        area += size_t(images[i].Width + 2 * padding) * (images[i].Height + 2 * padding);
+    }
+    std::stable_sort(order.begin(), order.end(), [images](size_t a, size_t b) { return images[a].Height > images[b].Height; });
+
+    // 从面积足够的最小尺寸开始，放不下时交替加倍宽度与高度。
+    int width = 1, height = 1;
+    while (size_t(width) * height < area) {
+        if (width <= height)
+            width *= 2;
+        else
+            height *= 2;
+    }
+    regions.resize(count);
+    while (!ShelfPack(images, order, padding, width, height, regions)) {
+        if (width >= maxSize && height >= maxSize) {
+            std::cout << "Unable to pack " << count << " textures into a " << maxSize << "x" << maxSize << " atlas" << std::endl;
+            return false;
+        }
+        if ((width <= height && width < maxSize) || height >= maxSize)
+            width *= 2;
+        else
+            height *= 2;
+    }
+
+    atlas.Width = width;
+    atlas.Height = height;
+    atlas.Pixels.assign(size_t(width) * height * 4, 0);
+    for (size_t i = 0; i < count; ++i) {
+        const TextureImage& image = images[i];
+        AtlasRegion& region = regions[i];
+        // 边距复制最近的边缘像素。
+        for (int y = -padding; y < image.Height + padding; ++y) {
+            const uint8_t* in = &image.Pixels[size_t(Clamp(y, image.Height)) * image.Width * 4];
+            uint8_t* out = &atlas.Pixels[(size_t(region.Y + y) * width + region.X) * 4];
+            for (int x = -padding; x < image.Width + padding; ++x)
+                std::copy(in + Clamp(x, image.Width) * 4, in + Clamp(x, image.Width) * 4 + 4, out + x * 4);
+        }
+        region.Scale = vec2(float(image.Width) / width, float(image.Height) / height);
+        region.Offset = vec2(float(region.X) / width, float(region.Y) / height);
+    }
+    return true;
+}
+
+static void SetPixel(TextureImage& image, int x, int y, float value)
+{
+    uint8_t* p = &image.Pixels[(size_t(y) * image.Width + x) * 4];
+    p[0] = p[1] = p[2] = (uint8_t) (value * 255 + 0.5f);
+    p[3] = 255;
+}
+
+void GenerateConeTextures(int size, TextureImage images[ConeTextureCount])
+{
+    for (int i = 0; i < ConeTextureCount; ++i) {
+        images[i].Width = images[i].Height = i == ConeTextureWhite ? 4 : size;
+        images[i].Pixels.resize(size_t(images[i].Width) * images[i].Height * 4);
+    }
+    // 纹理与顶点颜色相乘，亮度因而不低于 0.6，以免掩盖烘焙的光照梯度。
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            // 椎体：沿圆周 16 格、沿高度 4 格。
+            bool odd = ((x * 16 / size) + (y * 4 / size)) % 2 != 0;
+            SetPixel(images[ConeTextureCone], x, y, odd ? 0.6f : 1.0f);
+            // 底盘：8 个同心圆环。
+            float dx = (x + 0.5f) / size - 0.5f, dy = (y + 0.5f) / size - 0.5f;
+            int ring = (int) (std::sqrt(dx * dx + dy * dy) * 16);
+            SetPixel(images[ConeTextureDisk], x, y, ring % 2 ? 0.7f : 1.0f);
+        }
+    }
+    std::fill(images[ConeTextureWhite].Pixels.begin(), images[ConeTextureWhite].Pixels.end(), 255);
+}
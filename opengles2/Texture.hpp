@@ -0,0 +1,91 @@
+//
+//  Texture.hpp
+//  opengles2
+//
+//  纹理的 CPU 端处理：读取原始 RGBA 图像、并行生成 mipmap 链、将小纹理打包为图集并换算网格的纹理坐标。
+//
+/*
+ 以纹理代替几何细节可以显著减少顶点数；本模块只处理像素数据，不包含任何 GL 调用，上传由各引擎完成。
+ mipmap 链在 CPU 上生成而非调用 glGenerateMipmap：后者在部分驱动上于渲染线程同步执行，且 ES 1.1 并不提供。
+ 各级别由上一级别的浮点像素逐级缩小，避免每一级都重新量化为 8 位而累积误差；每个像素的 RGBA 恰好是一个 Float4，
+ 滤波因此对 4 个通道同时计算（NEON/SSE，参见 Float4.hpp）。同一级别的各行互不依赖，以 JobSystem::ParallelFor 并行生成，
+ 结果与单线程生成逐位相同。滤波器可分离，先纵向再横向：MipFilterBox 为 2×2 平均，MipFilterKaiser 为 Kaiser 窗的 sinc 滤波
+ （每个方向 12 个抽头），后者在缩小后仍保留更多细节，负的旁瓣引起的过冲在量化时截断。
+ ES 2.0 只允许尺寸为 2 的幂的纹理使用 mipmap，其余纹理只生成第 0 级。
+ 图集以货架算法打包：子纹理按高度降序逐行放置，图集的宽、高均为 2 的幂。每个子纹理四周复制边缘像素作为边距，
+ 双线性过滤与较高分辨率的几个 mipmap 级别因此不会采样到相邻的子纹理；边距缩小至不足一个像素的级别仍会轻微混色。
+ 同一物体的多个部分共用一个图集时，各绘制调用之间无需切换纹理。
+ */
+
+#ifndef Texture_hpp
+#define Texture_hpp
+
+#include "Mesh.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class JobSystem;
+
+// RGBA8 图像，逐行存储，第一行对应纹理坐标 t = 0。
+struct TextureImage {
+    int Width;
+    int Height;
+    std::vector<uint8_t> Pixels;
+};
+
+enum MipFilter {
+    MipFilterBox,
+    MipFilterKaiser,
+};
+
+// 子纹理在图集中的像素矩形（不含边距），子纹理的坐标 (s, t) 在图集中为 (s, t) * Scale + Offset。
+struct AtlasRegion {
+    int X, Y, Width, Height;
+    vec2 Scale;
+    vec2 Offset;
+};
+
+// 读取 width × height 的原始 RGBA8 文件（无文件头），文件大小不符时返回 false。
+bool LoadRawImage(const char* path, int width, int height, TextureImage& image);
+
+inline bool IsPowerOfTwo(int n) { return n > 0 && (n & (n - 1)) == 0; }
+
+// 完整 mipmap 链的级别数（包括第 0 级，直至 1×1）。
+int MipLevelCount(int width, int height);
+
+// 由 base 生成 mipmap 链，levels[0] 即 base 的副本。jobs 不为 0 时各级别的行在其工作线程上并行生成。
+// 尺寸不是 2 的幂时只返回第 0 级。
+void GenerateMipChain(const TextureImage& base, MipFilter filter, std::vector<TextureImage>& levels, JobSystem* jobs = 0);
+
+size_t MipChainBytes(const std::vector<TextureImage>& levels);
+
+// 将 count 个图像打包为一个宽、高均不超过 maxSize 的图集，regions 与 images 一一对应；放不下时返回 false。
+bool PackTextureAtlas(const TextureImage* images, size_t count, int padding, int maxSize,
+                      TextureImage& atlas, std::vector<AtlasRegion>& regions);
+
+inline vec2 AtlasTexCoord(const AtlasRegion& region, const vec2& texCoord)
+{
+    return vec2(texCoord.x * region.Scale.x + region.Offset.x, texCoord.y * region.Scale.y + region.Offset.y);
+}
+
+// 将网格生成函数给出的 [0, 1] 纹理坐标换算至图集中 region 所在的区域。
+inline void RemapTexCoords(Vertex* vertices, size_t count, const AtlasRegion& region)
+{
+    for (size_t i = 0; i < count; ++i)
+        vertices[i].TexCoord = AtlasTexCoord(region, vertices[i].TexCoord);
+}
+
+// 椎体与底盘的默认纹理，以程序生成，两个引擎共用同一图集布局。
+// ConeTextureWhite 为纯白的小图像，没有纹理坐标的网格（载入的网格、流式场景）以其中心作为常量纹理坐标，无需切换着色器程序。
+enum ConeTexture {
+    ConeTextureCone,
+    ConeTextureDisk,
+    ConeTextureWhite,
+    ConeTextureCount,
+};
+
+// 生成 ConeTextureCount 个默认纹理：椎体为沿圆周与高度方向的棋盘格，底盘为同心圆环，边长均为 size。
+void GenerateConeTextures(int size, TextureImage images[ConeTextureCount]);
+
+#endif /* Texture_hpp */
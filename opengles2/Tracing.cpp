@@ -0,0 +1,194 @@
+//
+//  Tracing.cpp
+//  opengles2
+//
+
+#include "Tracing.hpp"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum TraceEventType {
+    TraceZoneEvent,
+    TraceCounterEvent,
+    TraceInstantEvent,
+};
+
+struct TraceEvent {
+    const char* Name;
+    uint64_t Timestamp;
+    uint64_t Duration;
+    double Value;
+    TraceEventType Type;
+};
+
+// 只有所属线程写入 Events 与 Written；Written 以 release 语义发布，导出时以 acquire 语义读取。
+struct TraceThreadBuffer {
+    std::vector<TraceEvent> Events;
+    std::atomic<uint64_t> Written;
+    unsigned ThreadIndex;
+    std::string Name;                   // 由 registry 的互斥量保护
+};
+
+struct TraceRegistry {
+    std::mutex Mutex;
+    std::vector<TraceThreadBuffer*> Buffers;
+    pthread_key_t Key;
+};
+
+static TraceRegistry& Registry()
+{
+    static TraceRegistry* registry = 0;
+    static std::once_flag once;
+    std::call_once(once, []() {
+        registry = new TraceRegistry;
+        pthread_key_create(&registry->Key, 0);
+    });
+    return *registry;
+}
+
+static TraceThreadBuffer& CurrentBuffer()
+{
+    TraceRegistry& registry = Registry();
+    TraceThreadBuffer* buffer = (TraceThreadBuffer*) pthread_getspecific(registry.Key);
+    if (buffer)
+        return *buffer;
+    buffer = new TraceThreadBuffer;
+    buffer->Events.resize(TraceBufferCapacity);
+    buffer->Written.store(0);
+    {
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        buffer->ThreadIndex = (unsigned) registry.Buffers.size() + 1;
+        registry.Buffers.push_back(buffer);
+    }
+    pthread_setspecific(registry.Key, buffer);
+    return *buffer;
+}
+
+static void Record(const TraceEvent& event)
+{
+    TraceThreadBuffer& buffer = CurrentBuffer();
+    uint64_t written = buffer.Written.load(std::memory_order_relaxed);
+    buffer.Events[written % TraceBufferCapacity] = event;
+    buffer.Written.store(written + 1, std::memory_order_release);
+}
+
+uint64_t Tracing::Now()
+{
+    static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Tracing::Zone(const char* name, uint64_t start, uint64_t end)
+{
+    TraceEvent event = { name, start, end - start, 0, TraceZoneEvent };
+    Record(event);
+}
+
+void Tracing::Counter(const char* name, double value)
+{
+    TraceEvent event = { name, Now(), 0, value, TraceCounterEvent };
+    Record(event);
+}
+
+void Tracing::Instant(const char* name)
+{
+    TraceEvent event = { name, Now(), 0, 0, TraceInstantEvent };
+    Record(event);
+}
+
+void Tracing::SetThreadName(const char* name)
+{
+    TraceThreadBuffer& buffer = CurrentBuffer();
+    std::lock_guard<std::mutex> lock(Registry().Mutex);
+    buffer.Name = name;
+}
+
+static void WriteJsonString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if ((unsigned char) *c >= 0x20)
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+// Chrome 跟踪格式的时间单位为微秒。
+static void WriteEvent(FILE* file, const TraceEvent& event, unsigned tid)
+{
+    fputs(",\n{\"name\":", file);
+    WriteJsonString(file, event.Name);
+    fprintf(file, ",\"pid\":1,\"tid\":%u,\"ts\":%.3f", tid, event.Timestamp / 1000.0);
+    switch (event.Type) {
+        case TraceZoneEvent:
+            fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f}", event.Duration / 1000.0);
+            break;
+        case TraceCounterEvent:
+            fprintf(file, ",\"ph\":\"C\",\"args\":{\"value\":%.17g}}", event.Value);
+            break;
+        case TraceInstantEvent:
+            fputs(",\"ph\":\"i\",\"s\":\"t\"}", file);
+            break;
+    }
+}
+
+bool Tracing::WriteChromeTrace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        std::cout << "Unable to create " << path << std::endl;
+        return false;
+    }
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+          "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"hellocone\"}}", file);
+
+    TraceRegistry& registry = Registry();
+    std::vector<TraceThreadBuffer*> buffers;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        buffers = registry.Buffers;
+        for (size_t i = 0; i < buffers.size(); ++i)
+            names.push_back(buffers[i]->Name);
+    }
+
+    size_t total = 0;
+    std::vector<TraceEvent> events;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        TraceThreadBuffer& buffer = *buffers[i];
+        std::string name = names[i].empty() ? "Thread " + std::to_string(buffer.ThreadIndex) : names[i];
+        fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer.ThreadIndex);
+        WriteJsonString(file, name.c_str());
+        fputs("}}", file);
+
+        // 先复制已发布的事件，再根据复制之后的写入位置丢弃其间可能已被所属线程覆盖的事件。
+        uint64_t end = buffer.Written.load(std::memory_order_acquire);
+        uint64_t begin = end > TraceBufferCapacity ? end - TraceBufferCapacity : 0;
+        events.clear();
+        for (uint64_t n = begin; n < end; ++n)
+            events.push_back(buffer.Events[n % TraceBufferCapacity]);
+        uint64_t after = buffer.Written.load(std::memory_order_acquire);
+        uint64_t valid = after > TraceBufferCapacity ? after - TraceBufferCapacity : 0;
+        size_t skip = (size_t) (std::max(valid, begin) - begin);
+        for (size_t n = skip; n < events.size(); ++n)
+            WriteEvent(file, events[n], buffer.ThreadIndex);
+        total += events.size() - std::min(skip, events.size());
+    }
+    fputs("\n]}\n", file);
+    bool ok = fclose(file) == 0;
+    if (ok)
+        std::cout << "Wrote " << total << " trace events from " << buffers.size() << " threads to " << path << std::endl;
+    else
+        std::cout << "Failed writing " << path << std::endl;
+    return ok;
+}
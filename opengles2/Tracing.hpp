@@ -0,0 +1,70 @@
+//
+//  Tracing.hpp
+//  opengles2
+//
+//  记录引擎各阶段的时间线（区间、计数器与瞬时事件），导出为 Chrome 跟踪格式的 JSON，供 chrome://tracing 或 Perfetto 查看。
+//
+/*
+ 引擎代码只通过下列宏记录事件，编译时未定义 VCC_ENABLE_TRACING=1 时宏展开为空语句，参数也不会被求值，不产生任何开销：
+   VCC_TRACE_SCOPE("Render");                  从此处到所在作用域结束的区间
+   VCC_TRACE_COUNTER("occluded", count);       计数器的当前值
+   VCC_TRACE_INSTANT("rotate");                瞬时事件
+   VCC_TRACE_THREAD_NAME("JobSystem worker");  当前线程在时间线上显示的名称（复制保存）
+ 事件名须为字符串常量，记录时只保存指针。
+ 每个线程第一次记录事件时获得自己的环形缓冲区（通过 pthread 线程键查找），此后写入事件不加锁、不分配内存；
+ 缓冲区写满后覆盖最早的事件，因此时间线总是保留每个线程最近的 TraceBufferCapacity 个事件。
+ WriteChromeTrace() 可在任意线程上随时调用：它读取各缓冲区已发布的事件，并丢弃读取期间可能已被覆盖的部分，不会阻塞记录事件的线程。
+ 线程退出后其缓冲区保留至进程结束，以便导出已退出线程（例如已销毁的 JobSystem 的工作线程）的事件。
+ */
+
+#ifndef Tracing_hpp
+#define Tracing_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef VCC_ENABLE_TRACING
+#define VCC_ENABLE_TRACING 0
+#endif
+
+// 每个线程的环形缓冲区可容纳的事件数。
+static const size_t TraceBufferCapacity = 16384;
+
+class Tracing {
+public:
+    // 自进程第一次调用以来经过的纳秒数。
+    static uint64_t Now();
+    static void Zone(const char* name, uint64_t start, uint64_t end);
+    static void Counter(const char* name, double value);
+    static void Instant(const char* name);
+    static void SetThreadName(const char* name);
+    // 将目前为止记录的全部事件写入 Chrome 跟踪格式的 JSON 文件，无法写入时返回 false。
+    static bool WriteChromeTrace(const char* path);
+};
+
+class TraceZone {
+public:
+    explicit TraceZone(const char* name) : m_name(name), m_start(Tracing::Now()) {}
+    ~TraceZone() { Tracing::Zone(m_name, m_start, Tracing::Now()); }
+private:
+    TraceZone(const TraceZone&);
+    TraceZone& operator=(const TraceZone&);
+    const char* m_name;
+    uint64_t m_start;
+};
+
+#if VCC_ENABLE_TRACING
+#define VCC_TRACE_CONCATENATE_(a, b) a##b
+#define VCC_TRACE_CONCATENATE(a, b) VCC_TRACE_CONCATENATE_(a, b)
+#define VCC_TRACE_SCOPE(name) TraceZone VCC_TRACE_CONCATENATE(traceZone, __LINE__)(name)
+#define VCC_TRACE_COUNTER(name, value) Tracing::Counter(name, (double) (value))
+#define VCC_TRACE_INSTANT(name) Tracing::Instant(name)
+#define VCC_TRACE_THREAD_NAME(name) Tracing::SetThreadName(name)
+#else
+#define VCC_TRACE_SCOPE(name) ((void) 0)
+#define VCC_TRACE_COUNTER(name, value) ((void) 0)
+#define VCC_TRACE_INSTANT(name) ((void) 0)
+#define VCC_TRACE_THREAD_NAME(name) ((void) 0)
+#endif
+
+#endif /* Tracing_hpp */
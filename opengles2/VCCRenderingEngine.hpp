@@ -18,6 +18,9 @@
 #ifndef VCCRenderingEngine_hpp
 #define VCCRenderingEngine_hpp
 #include <stdio.h>
+#include <stddef.h>
+#include "Camera.hpp"
+#include "FrameStats.hpp"
 
 enum VCCDeviceOrientation{
     VCCDeviceOrientationUnknown,
@@ -33,10 +36,36 @@ enum VCCDeviceOrientation{
 
 
 struct tagVCCRenderingEngine {
+    // 依次调用 Prepare() 与 Finalize()。
     virtual void Initialize(int width, int height) = 0;
+    // 初始化分为两步：Prepare() 只执行不需要 GL 上下文的 CPU 工作（读取快照、生成网格等），可在后台线程上调用；
+    // Finalize() 则在持有 GL 上下文的渲染线程上创建 GL 对象，须在 Prepare() 返回之后调用。
+    virtual void Prepare(int width, int height) = 0;
+    virtual void Finalize() = 0;
+    // 在 Finalize() 之前以背景色清屏，作为占位画面；可与后台线程上的 Prepare() 同时调用。
+    virtual void RenderPlaceholder() = 0;
     virtual void Render() const = 0;
     virtual void UpdateAnimation(float timeStep) = 0;
     virtual void OnRotate(VCCDeviceOrientation newOrientation) = 0;
+    // 视图尺寸变化后重新分配深度缓冲区等与尺寸相关的存储，需在 Finalize() 之后调用。
+    // 返回时颜色渲染缓冲区处于绑定状态，其存储由调用者随后按新的图层尺寸重新分配（参见 GLView.mm）。
+    virtual void Resize(int width, int height) = 0;
+    // 载入 .vccmesh 网格文件（参见 MeshFile.hpp）并以其替代程序化生成的椎体，需在 Finalize() 之后调用。
+    virtual bool LoadMesh(const char* path) = 0;
+    // 设置快照文件（.vccsnapshot，参见 EngineSnapshot.hpp）的路径，需在 Prepare() 之前调用。
+    // 快照有效时 Prepare() 直接从中恢复网格等计算结果，否则完整地初始化并由 Finalize() 写入新的快照。
+    virtual void SetSnapshotPath(const char* path) = 0;
+    // 将当前状态（包括动画状态）写入快照，通常在应用程序进入后台时调用。
+    virtual bool SaveSnapshot() const = 0;
+    // 以多个摄像机在同一帧中渲染同一场景（参见 Camera.hpp），count 为 0 时恢复 Initialize() 中唯一的视口与投影。
+    // 几何数据、缓冲区、动画与可见性计算在各摄像机之间共享。需在 Finalize() 之后于渲染线程上调用。
+    virtual void SetCameras(const Camera* cameras, size_t count) = 0;
+    // 拾取屏幕坐标 (x, y) 处的物体（参见 RayPicking.hpp），坐标与 Initialize() 的宽、高处于同一坐标系，原点位于左上角。
+    // 命中时返回 true 并写入物体编号（椎体与底盘为 0）以及沿视线的距离；载入的网格没有解析形式，不参与拾取。
+    // 设置了多个摄像机时，在包含该点的最上层视口（渲染至引擎自身渲染目标的摄像机中最后一个）中拾取。
+    virtual bool Pick(float x, float y, int& object, float& distance) const = 0;
+    // 返回最近一帧与自创建以来累计提交的顶点、图元、绘制调用、状态切换与上传字节数，以及网格与 GL 对象的内存占用（参见 FrameStats.hpp）。
+    virtual VCCFrameStats GetFrameStats() const = 0;
     virtual ~tagVCCRenderingEngine(){}
 };
 
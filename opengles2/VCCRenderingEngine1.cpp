@@ -13,14 +13,31 @@
 #include "VCCRenderingEngine.hpp"
 
 #include "Quaternion.hpp"
+#include "MeshFile.hpp"
+#include "JobSystem.hpp"
+#include "EngineSnapshot.hpp"
+#include "PhaseTimer.hpp"
+#include "Tessellation.hpp"
+#include "Tracing.hpp"
+#include "GLResource.hpp"
+#include "RayPicking.hpp"
+#include "FixedTimestep.hpp"
+#include "Texture.hpp"
 #include <vector>
+#include <iostream>
 
 static const float AnimationDuration = 0.25f;
+// 以固定步长推进动画（参见 FixedTimestep.hpp），绘制时在最近两步的方位之间插值；步长可大于显示链接的间隔。
+static const bool UseFixedTimestep = false;
+static const float FixedTimestepSeconds = 1.0f / 30;
+static const int MaxFixedSteps = 4;
+// 以纹理图集为椎体与底盘增加细节，固定管线以默认的 GL_MODULATE 将纹理与顶点颜色相乘（参见 Texture.hpp）。
+static const bool UseTextures = false;
+static const int ConeTextureSize = 128;
+static const MipFilter TextureMipFilter = MipFilterKaiser;
+static const int AtlasPadding = 4;
+static const int MaxAtlasSize = 2048;
 using namespace std;
-struct Vertex{
-    vec3 Position;
-    vec4 Color;
-};
 
 // Animation 结构将开启 3D 转换功能并包含了初始方位、当前差值方位以及结束方位3个方向上的四元数。
 // 同时，该结构还定义了两个时间间隔值 Elapsed 和 Duration，单位为秒，他们用于计算 0~1 之间的差值结构。
@@ -36,33 +53,120 @@ struct Animation{
 
 
 
+// 快照中的数据块编号。
+enum SnapshotBlockId {
+    SnapshotState = 1,
+    SnapshotCone,
+    SnapshotDisk,
+};
+
+// 快照中除网格以外的引擎状态。
+struct Engine1SnapshotState {
+    Animation AnimationState;
+    mat4 Rotation;
+};
+
+// 本引擎持有的各类 GL 对象，参见 GLResource.hpp。
+struct Engine1Renderbuffer {
+    static const GLResourceCategory Category = GLResourceRenderbuffer;
+    static GLuint Generate() { GLuint name; glGenRenderbuffersOES(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteRenderbuffersOES(1, &name); }
+};
+struct Engine1Framebuffer {
+    static const GLResourceCategory Category = GLResourceFramebuffer;
+    static GLuint Generate() { GLuint name; glGenFramebuffersOES(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteFramebuffersOES(1, &name); }
+};
+struct Engine1Texture {
+    static const GLResourceCategory Category = GLResourceTexture;
+    static GLuint Generate() { GLuint name; glGenTextures(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteTextures(1, &name); }
+};
+
 //浮点常量以定义对应的角速度；
 static const float RevolutionsPerSecond = 1;
 
 class VCCRenderingEngine1 : public VCCRenderingEngine{
 public:
     VCCRenderingEngine1();
+    ~VCCRenderingEngine1();
     void Initialize(int width, int height);
+    void Prepare(int width, int height);
+    void Finalize();
+    void RenderPlaceholder();
     void Render() const;
     void UpdateAnimation(float timeStep);
     void OnRotate(VCCDeviceOrientation newOrientation);
+    void Resize(int width, int height);
+    bool LoadMesh(const char* path);
+    void SetSnapshotPath(const char* path);
+    bool SaveSnapshot() const;
+    void SetCameras(const Camera* cameras, size_t count);
+    bool Pick(float x, float y, int& object, float& distance) const;
+    VCCFrameStats GetFrameStats() const;
 private:
+    void DrawScene() const;
+    void DrawLoadedMesh() const;
+    void UploadTexture();
+    uint64_t SnapshotParameterHash(int width, int height) const;
+    bool RestoreSnapshot();
+    void StepAnimation(float timeStep);
 
+    // 登记本引擎全部 GL 对象的估算占用，须声明在所有 GL 句柄之前，以便在它们全部析构之后才检查泄漏。
+    GLResourceRegistry m_glResources;
     
     //三角形数据位于两个 STL 容器 m_cone 和 m_disk 中。由于数据尺寸事先已知，向量容器类可视为一类较为理想的数据结构并可确保数据的连续存储。这里，针对 OpenGL，数据的连续存储是十分必要的。
     
     vector<Vertex> m_cone;
     vector<Vertex> m_disk;
+    // 引擎持有的任务调度器。UpdateAnimation() 将动画更新作为任务提交，Render() 在使用其结果之前等待 m_animationJobs。
+    mutable JobSystem m_jobs;
+    mutable JobCounter m_animationJobs;
     Animation m_animation;
+    mat4 m_rotation;
+    // 开启 UseFixedTimestep 时使用：最近一步之前的方位，m_rotation 为它与 m_animation.Current 按 m_clock.Alpha() 的插值。
+    FixedTimestep m_clock;
+    Quaternion m_previousRotation;
     //float m_desiredAngle;
     //float m_currentAngle;
-    GLuint m_framebuffer;
+    GLHandle<Engine1Framebuffer> m_framebuffer;
     //GLuint m_renderbuffer;
     
     //与 HelloArrow 程序不同，此处定义了两个渲染缓冲区。HelloArrow 程序执行 2d 渲染操作，因而仅使用了一个颜色缓冲区；而 helloCone 程序则需要需要新增一个缓冲区用于存储场景的深度值。简而言之，深度缓冲区可视为一类在各像素处存储 Z 值得特定的图像平面。
     //
-    GLuint m_colorRenderbuffer;
-    GLuint m_depthRenderbuffer;
+    GLHandle<Engine1Renderbuffer> m_colorRenderbuffer;
+    GLHandle<Engine1Renderbuffer> m_depthRenderbuffer;
+    
+    // SetCameras() 设置的摄像机及其 View * Projection，为空时按 Initialize() 的单一视口与投影绘制。
+    // 固定管线没有可供剔除的渲染队列，各摄像机共用客户端顶点数组，只重新设置视口与投影矩阵并重新提交绘制调用。
+    vector<Camera> m_cameras;
+    vector<mat4> m_cameraViewProjections;
+    
+    // 开启 UseTextures 时的纹理图集，m_textureLevels 在 Finalize() 上传之后即释放；载入的网格以白色区域的中心 m_whiteTexCoord 绘制。
+    GLHandle<Engine1Texture> m_texture;
+    vector<TextureImage> m_textureLevels;
+    vector<AtlasRegion> m_textureRegions;
+    vec2 m_whiteTexCoord;
+    // 开启 UseTextures 且图集打包成功；打包失败时退回无纹理的绘制，而不是在后台线程上终止进程。
+    bool m_textured;
+    
+    // 由 LoadMesh() 载入的网格。ES 1.1 版本直接以客户端数组的方式引用文件映射，映射在引擎的整个生命周期内保持有效。
+    MappedMesh m_mesh;
+    // 以编号为 0 的单位实例代表椎体与底盘。
+    RayPicker m_picker;
+    
+    // GetFrameStats() 返回的提交量统计，在 const 的 Render() 中累加；载入的矩阵计为 uniform 字节。
+    mutable FrameStatsRecorder m_frameStats;
+    
+    // 预热启动所用的快照，路径为空时不读写快照。
+    string m_snapshotPath;
+    uint64_t m_snapshotHash;
+    bool m_restored;
+    uint64_t m_restoredBytes;           // 最近一次初始化从快照恢复的字节数，经 GetFrameStats() 报告
+    int m_width;
+    int m_height;
+    // 初始化各阶段的耗时，Prepare() 与 Finalize() 可能位于不同的线程，但二者不会同时执行。
+    PhaseTimer m_initPhases;
 };
 
 //其中， UpdateAnimation() 和 OnRotate()通过桩函数（存根函数）实现，且需要进一步完善以支持旋转操作
@@ -72,11 +176,20 @@ VCCRenderingEngine* CreateRenderer1()
 {
     return new VCCRenderingEngine1();
 }
-VCCRenderingEngine1::VCCRenderingEngine1()
+VCCRenderingEngine1::VCCRenderingEngine1() : m_glResources("ES 1.1 engine"), m_clock(FixedTimestepSeconds, MaxFixedSteps),
+    m_restored(false), m_restoredBytes(0)
 {
     //生成渲染缓冲区操作符并将其绑定至管线上。
-    glGenRenderbuffersOES(1, &m_colorRenderbuffer);
+    m_colorRenderbuffer.Create(m_glResources, "color renderbuffer");
     glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_colorRenderbuffer);
+    PickInstance cone = { vec3(0, 0, 0), 1, 0 };
+    m_picker.SetInstances(&cone, 1);
+}
+
+// GL 对象由各句柄在成员析构时删除，调用者须保证引擎的 GL 上下文为当前上下文；动画任务仍可能在写入成员，须先等待其完成。
+VCCRenderingEngine1::~VCCRenderingEngine1()
+{
+    m_jobs.Wait(m_animationJobs);
 }
 
 //Initialize()方法将构建视口变换居正以及投影矩阵。其中，投影矩阵定义了一个当前可见场景的 3D 空间
@@ -86,86 +199,91 @@ VCCRenderingEngine1::VCCRenderingEngine1()
 
 void VCCRenderingEngine1::Initialize(int width, int height)
 {
-    // 将对象分解为三角形的过程通常称作三角形剖分，更常见的称谓为细分操作，进而反映了更为广泛的表面多边形填充问题。
+    Prepare(width, height);
+    Finalize();
+}
+
+// 初始化中不需要 GL 上下文的部分，可在后台线程上执行。
+void VCCRenderingEngine1::Prepare(int width, int height)
+{
+    VCC_TRACE_SCOPE("Prepare");
+    m_initPhases.Restart();
+    m_width = width;
+    m_height = height;
     
-    // 针对圆和椎体，定义相关常量。
-    const float coneRadius = 0.5f;
-    const float coneHeight = 1.866f;
-    const int coneSlices = 40;
+    // 将对象分解为三角形的过程通常称作三角形剖分，更常见的称谓为细分操作，进而反映了更为广泛的表面多边形填充问题。
     
-    // Generate vertices for the disk
-    {
-        // 分配底盘点
-        m_disk.resize(coneSlices + 2);
-        
-        // 初始化为 GL_TRIANGLE_FAN 拓扑关系
-        // 初始化底盘中心点
-        vector<Vertex>::iterator vertex_it = m_disk.begin();
-        vertex_it->Color = vec4(0.75, 0.75, 0.75, 1);
-        vertex_it->Position.x = 0;
-        vertex_it->Position.y = 1 - coneHeight;
-        vertex_it->Position.z = 0;
-        vertex_it++;
-        
-        // 初始化底盘圆周点
-        const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex_it != m_disk.end(); theta += dtheta) {
-            vertex_it->Color = vec4(0.75, 0.75, 0.75, 1);
-            vertex_it->Position.x = coneRadius * cos(theta);
-            vertex_it->Position.y = 1 - coneHeight;
-            vertex_it->Position.z = coneRadius * sin(theta);
-            vertex_it++;
+    // 针对圆和椎体生成顶点，相关常量与生成过程参见 Mesh.hpp。两个网格在不同的工作线程上生成，片段数很高时各自再划分为多个任务（参见 Tessellation.hpp）。
+    // 快照有效时直接从中恢复网格与动画状态。
+    // 图集的布局先于快照与网格确定，mipmap 链与网格同时生成；快照中的网格已换算过纹理坐标。
+    // 是否使用纹理参与快照的参数散列，打包失败时因而不会恢复按图集换算过纹理坐标的网格。
+    TextureImage atlas;
+    m_textured = false;
+    if (UseTextures) {
+        TextureImage images[ConeTextureCount];
+        GenerateConeTextures(ConeTextureSize, images);
+        m_textured = PackTextureAtlas(images, ConeTextureCount, AtlasPadding, MaxAtlasSize, atlas, m_textureRegions);
+        if (m_textured) {
+            m_whiteTexCoord = AtlasTexCoord(m_textureRegions[ConeTextureWhite], vec2(0.5f, 0.5f));
+        } else {
+            // PackTextureAtlas() 已输出失败的原因。
+            std::cout << "Drawing the cone without textures" << std::endl;
+            m_textureRegions.clear();
         }
-        
+        m_initPhases.Mark("texture atlas");
     }
+
+    m_snapshotHash = SnapshotParameterHash(width, height);
+    m_restoredBytes = 0;
+    m_restored = !m_snapshotPath.empty() && RestoreSnapshot();
+    m_initPhases.Mark("snapshot restore");
     
-    // Generate bertices for the body of the cone
-    {
-        // 分配椎体点
-        m_cone.resize((coneSlices + 1) * 2);
-        
-        // 初始化为 GL_TRISNGLES_STRIP 三角带拓扑关系.
-        vector<Vertex>::iterator vertex_it = m_cone.begin();
-        const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex_it != m_cone.end(); theta += dtheta) {
-            
-            // Grayscale gradient
-            // 为了简化光照模拟计算，这里采用了灰度梯度值，其中，颜色值使用了固定值，且不会随对象位置的变化而变化，
-            // 该技术有时也称作烘焙光照。
-            float brightness = abs(sin(theta));
-            vec4 color(brightness, brightness, brightness, 1);
-            
-            // 顶点
-            vertex_it->Position = vec3(0, 1, 0);
-            vertex_it->Color = color;
-            vertex_it++;
-            
-            // 圆周点
-            vertex_it->Position.x = coneRadius * cos(theta);
-            vertex_it->Position.y = 1 - coneHeight;
-            vertex_it->Position.z = coneRadius * sin(theta);
-            vertex_it->Color = color;
-            vertex_it++;
+    JobCounter textureJobs;
+    if (m_textured)
+        m_jobs.Run([this, &atlas]() { GenerateMipChain(atlas, TextureMipFilter, m_textureLevels, &m_jobs); }, &textureJobs);
+    
+    if (!m_restored) {
+        JobCounter meshJobs;
+        m_jobs.Run([this]() { TessellateDisk(m_jobs, m_disk, ConeRadius, ConeHeight, ConeSlices); }, &meshJobs);
+        m_jobs.Run([this]() { TessellateCone(m_jobs, m_cone, ConeRadius, ConeHeight, ConeSlices); }, &meshJobs);
+        m_jobs.Wait(meshJobs);
+        if (m_textured) {
+            RemapTexCoords(&m_cone[0], m_cone.size(), m_textureRegions[ConeTextureCone]);
+            RemapTexCoords(&m_disk[0], m_disk.size(), m_textureRegions[ConeTextureDisk]);
         }
-
+        m_initPhases.Mark("geometry");
     }
-    
+    if (m_textured) {
+        m_jobs.Wait(textureJobs);
+        m_initPhases.Mark("textures");
+    }
+}
+
+// 初始化中需要 GL 上下文的部分，须在渲染线程上于 Prepare() 完成之后调用。
+void VCCRenderingEngine1::Finalize()
+{
+    VCC_TRACE_SCOPE("Finalize");
+    m_initPhases.Mark("wait for render thread");
     
     // 创建深度缓存
     // 生成深度缓冲区 ID，实施绑定操作并分配储存空间。
-    glGenRenderbuffersOES(1, &m_depthRenderbuffer);
+    m_depthRenderbuffer.Create(m_glResources, "depth renderbuffer");
     glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_depthRenderbuffer);
-    glRenderbufferStorageOES(GL_RENDERBUFFER_OES, GL_DEPTH_COMPONENT16_OES, width, height);
+    glRenderbufferStorageOES(GL_RENDERBUFFER_OES, GL_DEPTH_COMPONENT16_OES, m_width, m_height);
+    m_depthRenderbuffer.SetBytes(size_t(m_width) * m_height * 2);
+    // 颜色渲染缓冲区的存储由 EAGLContext 按图层分配，按 RGBA8 估算。
+    m_colorRenderbuffer.SetBytes(size_t(m_width) * m_height * 4);
     
     
     
     
     //Create the framebuffer object and attach the depth and color buffer
     // 生成帧缓冲区对象 ID，实施绑定操作，并通过 glFramebufferRenderbufferOES 将其与颜色值和深度值进行关联。
+    // 绘制过占位画面时帧缓冲区已经存在，参见 RenderPlaceholder()。
     
     
-    
-    glGenFramebuffersOES(1, &m_framebuffer);
+    if (!m_framebuffer)
+        m_framebuffer.Create(m_glResources, "framebuffer");
     glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_framebuffer);
     glFramebufferRenderbufferOES(GL_FRAMEBUFFER_OES, GL_COLOR_ATTACHMENT0_OES, GL_RENDERBUFFER_OES, m_colorRenderbuffer);
     glFramebufferRenderbufferOES(GL_FRAMEBUFFER_OES, GL_DEPTH_ATTACHMENT_OES, GL_RENDERBUFFER_OES, m_depthRenderbuffer);
@@ -174,14 +292,19 @@ void VCCRenderingEngine1::Initialize(int width, int height)
     // 绑定颜色渲染缓冲区并使未来的渲染操作与其发生关联。
     glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_colorRenderbuffer);
     // 构建视口的左、下、宽、以及高度属性值。
-    glViewport(0, 0, width, height);
+    glViewport(0, 0, m_width, m_height);
     // 针对 3D 场景，开启深度测试功能。
     glEnable(GL_DEPTH_TEST);
+    m_initPhases.Mark("framebuffers");
     // 构建投影和模型-视图转换。
     glMatrixMode(GL_PROJECTION);
     glFrustumf(-1.6f, 1.6, -2.4, 2.4, 5, 10);
     glMatrixMode(GL_MODELVIEW);
     glTranslatef(0, 0, -7);
+    if (m_textured) {
+        UploadTexture();
+        m_initPhases.Mark("texture upload");
+    }
             //glMatrixMode(GL_PROJECTION);
             //initialize the projection matrix
             //const float maxX = 2;
@@ -192,6 +315,24 @@ void VCCRenderingEngine1::Initialize(int width, int height)
             //OnRotate(VCCDeviceOrientationPortrait);
             //m_currentAngle = m_desiredAngle;
     
+    
+    if (!m_restored && !m_snapshotPath.empty()) {
+        SaveSnapshot();
+        m_initPhases.Mark("snapshot write");
+    }
+}
+
+// Finalize() 之前只有颜色渲染缓冲区可用：为其单独创建帧缓冲区并以场景的背景色清屏，Finalize() 随后沿用该帧缓冲区。
+void VCCRenderingEngine1::RenderPlaceholder()
+{
+    if (!m_framebuffer) {
+        m_framebuffer.Create(m_glResources, "framebuffer");
+        glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_framebuffer);
+        glFramebufferRenderbufferOES(GL_FRAMEBUFFER_OES, GL_COLOR_ATTACHMENT0_OES, GL_RENDERBUFFER_OES, m_colorRenderbuffer);
+        glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_colorRenderbuffer);
+    }
+    glClearColor(0.5f, 0.5f, 0.5f, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
 }
 
 //针对平滑旋转操作，Apple 通过 UIViewController 类提供了相应的底层实现方案，但这并非 OpenGL ES 所推荐的方法，其原因如下
@@ -206,6 +347,7 @@ void VCCRenderingEngine1::Initialize(int width, int height)
 
 void VCCRenderingEngine1::Render() const
 {
+    VCC_TRACE_SCOPE("Render");
     glClearColor(0.5f, 0.5f, 0.5f, 1);
     // 针对深度缓冲区，增加了一个参数
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -214,23 +356,85 @@ void VCCRenderingEngine1::Render() const
     
     glEnableClientState(GL_VERTEX_ARRAY);
     glEnableClientState(GL_COLOR_ARRAY);
-    mat4 rotation(m_animation.Current.ToMatrix());
-    glMultMatrixf(rotation.Pointer());
-    
-    // draw cone
-    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_cone[0].Position.x);
-    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_cone[0].Color.x);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, m_cone.size());//该函数调用即可令 OpenGL 从定义于 gl*Pointer 中的指针获取数据，同时三角形数据将渲染至目标表面上。
+    if (m_textured)
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    m_jobs.Wait(m_animationJobs);
+    glMultMatrixf(m_rotation.Pointer());
+    m_frameStats.Uniform(sizeof(mat4));
+    if (m_mesh.IsOpen()) {
+        // 量化的位置坐标需先经过反量化矩阵；ES 1.1 不对 GL_SHORT 做规格化处理。
+        mat4 dequantization = MeshFileDequantizationMatrix(m_mesh.Header(), *m_mesh.FindAttribute(MeshAttributePosition), false);
+        glMultMatrixf(dequantization.Pointer());
+        m_frameStats.Uniform(sizeof(mat4));
+    }
     
-    // draw disk
-    glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_disk[0].Position.x);
-    glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_disk[0].Color.x);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, m_disk.size());
+    if (m_cameras.empty()) {
+        DrawScene();
+    } else {
+        // 观察矩阵并入投影矩阵，Modelview 栈因而与单一视口时相同。
+        GLuint boundFramebuffer = m_framebuffer;
+        glEnable(GL_SCISSOR_TEST);
+        glMatrixMode(GL_PROJECTION);
+        for (size_t c = 0; c < m_cameras.size(); ++c) {
+            const Camera& camera = m_cameras[c];
+            GLuint target = camera.Framebuffer ? camera.Framebuffer : (GLuint) m_framebuffer;
+            if (target != boundFramebuffer) {
+                glBindFramebufferOES(GL_FRAMEBUFFER_OES, target);
+                m_frameStats.StateChange();
+                boundFramebuffer = target;
+            }
+            CameraViewport viewport = ViewportInTarget(camera, camera.Framebuffer ? camera.TargetWidth : m_width,
+                                                       camera.Framebuffer ? camera.TargetHeight : m_height);
+            glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+            glScissor(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glLoadMatrixf(m_cameraViewProjections[c].Pointer());
+            m_frameStats.StateChange(2);
+            m_frameStats.Uniform(sizeof(mat4));
+            glMatrixMode(GL_MODELVIEW);
+            DrawScene();
+            glMatrixMode(GL_PROJECTION);
+        }
+        glMatrixMode(GL_MODELVIEW);
+        glDisable(GL_SCISSOR_TEST);
+        if (boundFramebuffer != m_framebuffer)
+            glBindFramebufferOES(GL_FRAMEBUFFER_OES, m_framebuffer);
+    }
     
     glDisableClientState(GL_VERTEX_ARRAY);
     glDisableClientState(GL_COLOR_ARRAY);
+    if (m_textured)
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     //关闭两个顶点属性。在执行绘制命令时，需要开启相关的顶点属性，但当后续绘制命令采用完全不同的垫垫属性集时，保留原有的属性并非上次。
     glPopMatrix();
+    m_frameStats.EndFrame();
+}
+
+// 以当前的 Modelview 与投影矩阵绘制椎体与底盘（或载入的网格）。
+void VCCRenderingEngine1::DrawScene() const
+{
+    if (m_mesh.IsOpen()) {
+        DrawLoadedMesh();
+    } else {
+        // draw cone
+        glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_cone[0].Position.x);
+        glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_cone[0].Color.x);
+        if (m_textured)
+            glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &m_cone[0].TexCoord.x);
+        m_frameStats.StateChange();
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, m_cone.size());//该函数调用即可令 OpenGL 从定义于 gl*Pointer 中的指针获取数据，同时三角形数据将渲染至目标表面上。
+        m_frameStats.Draw(m_cone.size(), PrimitiveCount(GL_TRIANGLE_STRIP, m_cone.size()));
+
+        // draw disk
+        glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &m_disk[0].Position.x);
+        glColorPointer(4, GL_FLOAT, sizeof(Vertex), &m_disk[0].Color.x);
+        if (m_textured)
+            glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &m_disk[0].TexCoord.x);
+        m_frameStats.StateChange();
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, m_disk.size());
+        m_frameStats.Draw(m_disk.size(), PrimitiveCount(GL_TRIANGLE_STRIP, m_disk.size()));
+
+    }
 }
 
 //程序考察箭头的旋转方向问题，即顺时针还是逆时针旋转。此处，仅检测期望值是否大于当前角度值并不充分：若用户将设备方位从 270 改变至 0，则该角度值应增至 360。
@@ -241,6 +445,38 @@ void VCCRenderingEngine1::Render() const
 
 // 为了实现平滑的旋转操作，UpdateAnimation() 方法将在旋转四元数的基础上调用 Slerp() 方法。
 void VCCRenderingEngine1::UpdateAnimation(float timeStep)
+{
+    VCC_TRACE_SCOPE("UpdateAnimation");
+    // 动画状态仅由动画任务修改；提交新任务前须等待上一次提交的任务完成。
+    m_jobs.Wait(m_animationJobs);
+    if (!UseFixedTimestep) {
+        if (m_animation.Current == m_animation.End)
+            return;
+        m_jobs.Run([this, timeStep]() {
+            VCC_TRACE_SCOPE("Animation");
+            StepAnimation(timeStep);
+            m_rotation = mat4(m_animation.Current.ToMatrix());
+        }, &m_animationJobs);
+        return;
+    }
+    // 时钟在静止时同样推进，动画开始时累加器中只有不足一步的时间。
+    int steps = m_clock.Advance(timeStep);
+    float alpha = m_clock.Alpha();
+    // 最后一步到达终点之后，仍要再走一步才不再需要插值。
+    if (m_animation.Current == m_animation.End && m_previousRotation == m_animation.Current)
+        return;
+    m_jobs.Run([this, steps, alpha]() {
+        VCC_TRACE_SCOPE("Animation");
+        for (int i = 0; i < steps; ++i) {
+            m_previousRotation = m_animation.Current;
+            StepAnimation(FixedTimestepSeconds);
+        }
+        m_rotation = mat4(m_previousRotation.Slerp(alpha, m_animation.Current).ToMatrix());
+    }, &m_animationJobs);
+}
+
+// 将动画推进 timeStep 秒，只在动画任务中调用。
+void VCCRenderingEngine1::StepAnimation(float timeStep)
 {
     if (m_animation.Current == m_animation.End)
         return;
@@ -253,6 +489,19 @@ void VCCRenderingEngine1::UpdateAnimation(float timeStep)
     }
 }
 
+// 投影矩阵保持不变，场景随视口一同拉伸，与 Initialize() 的做法一致。
+void VCCRenderingEngine1::Resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_depthRenderbuffer);
+    glRenderbufferStorageOES(GL_RENDERBUFFER_OES, GL_DEPTH_COMPONENT16_OES, m_width, m_height);
+    m_depthRenderbuffer.SetBytes(size_t(m_width) * m_height * 2);
+    m_colorRenderbuffer.SetBytes(size_t(m_width) * m_height * 4);
+    glViewport(0, 0, m_width, m_height);
+    glBindRenderbufferOES(GL_RENDERBUFFER_OES, m_colorRenderbuffer);
+}
+
 // OnRotate() 方法将启动一个新的动画序列
 void VCCRenderingEngine1::OnRotate(VCCDeviceOrientation newOrientation)
 {
@@ -285,8 +534,224 @@ void VCCRenderingEngine1::OnRotate(VCCDeviceOrientation newOrientation)
             break;
     }
     
+    m_jobs.Wait(m_animationJobs);
     m_animation.Elapsed = 0;
     m_animation.Start = m_animation.Current = m_animation.End;
+    m_previousRotation = m_animation.Current;
+    m_rotation = mat4(m_animation.Current.ToMatrix());
     m_animation.End = Quaternion::CreateFromVectors(vec3(0, 1, 0), direction);
     
 }
+
+static GLenum MeshComponentToGL(uint32_t type)
+{
+    switch (type) {
+        case MeshComponentShort:
+            return GL_SHORT;
+        case MeshComponentUnsignedByte:
+            return GL_UNSIGNED_BYTE;
+        default:
+            return GL_FLOAT;
+    }
+}
+
+static GLenum MeshTopologyToGL(uint32_t topology)
+{
+    switch (topology) {
+        case MeshTopologyTriangleStrip:
+            return GL_TRIANGLE_STRIP;
+        case MeshTopologyTriangleFan:
+            return GL_TRIANGLE_FAN;
+        default:
+            return GL_TRIANGLES;
+    }
+}
+
+// LoadMesh() 仅映射并校验网格文件，顶点与索引数据在绘制时由 OpenGL 直接从映射内存中读取。
+// 新文件在局部对象中打开并校验，失败时原先载入的网格保持不变。
+bool VCCRenderingEngine1::LoadMesh(const char* path)
+{
+    MappedMesh mesh;
+    if (!mesh.Open(path))
+        return false;
+    
+    // ES 1.1 规范仅支持 8 位与 16 位索引，且颜色数组必须为 4 个分量。
+    const MeshFileAttribute* position = mesh.FindAttribute(MeshAttributePosition);
+    const MeshFileAttribute* color = mesh.FindAttribute(MeshAttributeColor);
+    if (!position || position->Type == MeshComponentUnsignedByte || mesh.Header().IndexSize == 4 ||
+        (color && color->Components != 4)) {
+        std::cout << "Mesh file " << path << " is not supported by OpenGL ES 1.1" << std::endl;
+        return false;
+    }
+    // 原先的映射随局部对象析构而解除。
+    m_mesh.Swap(mesh);
+    return true;
+}
+
+// 上传 Prepare() 生成的图集及其 mipmap 链并启用纹理，CPU 端的像素随即释放。
+void VCCRenderingEngine1::UploadTexture()
+{
+    m_texture.Create(m_glResources, "texture atlas");
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    bool mipmapped = m_textureLevels.size() > 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    for (size_t level = 0; level < m_textureLevels.size(); ++level) {
+        const TextureImage& image = m_textureLevels[level];
+        glTexImage2D(GL_TEXTURE_2D, (GLint) level, GL_RGBA, image.Width, image.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &image.Pixels[0]);
+    }
+    m_texture.SetBytes(MipChainBytes(m_textureLevels));
+    vector<TextureImage>().swap(m_textureLevels);
+    glEnable(GL_TEXTURE_2D);
+}
+
+void VCCRenderingEngine1::DrawLoadedMesh() const
+{
+    const MeshFileHeader& header = m_mesh.Header();
+    const unsigned char* vertices = (const unsigned char*) m_mesh.Vertices();
+    const MeshFileAttribute* position = m_mesh.FindAttribute(MeshAttributePosition);
+    const MeshFileAttribute* color = m_mesh.FindAttribute(MeshAttributeColor);
+    
+    glVertexPointer(position->Components, MeshComponentToGL(position->Type), header.VertexStride, vertices + position->Offset);
+    if (color) {
+        glColorPointer(4, MeshComponentToGL(color->Type), header.VertexStride, vertices + color->Offset);
+    } else {
+        glDisableClientState(GL_COLOR_ARRAY);
+        glColor4f(1, 1, 1, 1);
+    }
+    // 载入的网格没有对应的纹理，以图集中的白色区域绘制。
+    if (m_textured) {
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glMultiTexCoord4f(GL_TEXTURE0, m_whiteTexCoord.x, m_whiteTexCoord.y, 0, 1);
+    }
+    m_frameStats.StateChange();
+    
+    const unsigned char* indices = (const unsigned char*) m_mesh.Indices();
+    for (uint32_t i = 0; i < header.SubmeshCount; ++i) {
+        const MeshFileSubmesh& submesh = m_mesh.Submeshes()[i];
+        GLenum mode = MeshTopologyToGL(submesh.Topology);
+        if (indices)
+            glDrawElements(mode, submesh.Count, GL_UNSIGNED_SHORT, indices + size_t(submesh.First) * header.IndexSize);
+        else
+            glDrawArrays(mode, submesh.First, submesh.Count);
+        m_frameStats.Draw(submesh.Count, PrimitiveCount(mode, submesh.Count));
+    }
+}
+
+// 投影与 Modelview 与 Finalize()、Render() 中的 glFrustumf、glTranslatef 以及 m_rotation 一致。
+bool VCCRenderingEngine1::Pick(float x, float y, int& object, float& distance) const
+{
+    if (m_mesh.IsOpen())
+        return false;
+    m_jobs.Wait(m_animationJobs);
+    mat4 modelview = m_rotation * mat4::Translate(0, 0, -7);
+    PickRay ray;
+    if (m_cameras.empty()) {
+        ray = UnprojectScreenPoint(x, y, m_width, m_height, modelview, mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10));
+    } else {
+        CameraViewport viewport;
+        int c = CameraAtPoint(m_cameras, m_width, m_height, x, y, viewport);
+        if (c < 0)
+            return false;
+        ray = UnprojectScreenPoint(x - viewport.X, y - (m_height - viewport.Y - viewport.Height), viewport.Width, viewport.Height,
+                                   modelview * m_cameras[c].View, m_cameras[c].Projection);
+    }
+    PickHit hit = m_picker.Pick(ray);
+    if (hit.Instance < 0)
+        return false;
+    object = hit.Instance;
+    distance = hit.Distance;
+    return true;
+}
+
+// 离开多摄像机模式时恢复 Finalize() 设置的视口与投影。
+void VCCRenderingEngine1::SetCameras(const Camera* cameras, size_t count)
+{
+    bool wasMultiCamera = !m_cameras.empty();
+    m_cameras.assign(cameras, cameras + count);
+    m_cameraViewProjections.clear();
+    for (size_t i = 0; i < count; ++i)
+        m_cameraViewProjections.push_back(cameras[i].View * cameras[i].Projection);
+    if (count || !wasMultiCamera)
+        return;
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glFrustumf(-1.6f, 1.6, -2.4, 2.4, 5, 10);
+    glMatrixMode(GL_MODELVIEW);
+    glViewport(0, 0, m_width, m_height);
+    m_frameStats.StateChange(2);
+    m_frameStats.Uniform(sizeof(mat4));
+}
+
+// ES 1.1 直接以客户端数组引用网格，载入网格的文件映射因而计入网格占用。
+VCCFrameStats VCCRenderingEngine1::GetFrameStats() const
+{
+    VCCFrameStats stats = m_frameStats.Stats();
+    stats.MeshBytes = (m_cone.capacity() + m_disk.capacity()) * sizeof(Vertex);
+    if (m_mesh.IsOpen())
+        stats.MeshBytes += m_mesh.Header().FileSize;
+    stats.GLBytes = m_glResources.TotalBytes();
+    stats.SnapshotBytes = m_restoredBytes;
+    stats.Initialization = m_initPhases;
+    return stats;
+}
+
+void VCCRenderingEngine1::SetSnapshotPath(const char* path)
+{
+    m_snapshotPath = path ? path : "";
+}
+
+uint64_t VCCRenderingEngine1::SnapshotParameterHash(int width, int height) const
+{
+    SnapshotHasher hasher;
+    hasher.AddValue(width);
+    hasher.AddValue(height);
+    hasher.AddValue(sizeof(Vertex));
+    hasher.AddValue(sizeof(Engine1SnapshotState));
+    hasher.AddValue(ConeRadius);
+    hasher.AddValue(ConeHeight);
+    hasher.AddValue(ConeSlices);
+    hasher.AddValue(m_textured);
+    hasher.AddValue(ConeTextureSize);
+    hasher.AddValue(AtlasPadding);
+    return hasher.Hash();
+}
+
+bool VCCRenderingEngine1::SaveSnapshot() const
+{
+    VCC_TRACE_SCOPE("SaveSnapshot");
+    if (m_snapshotPath.empty())
+        return false;
+    m_jobs.Wait(m_animationJobs);
+    Engine1SnapshotState state;
+    state.AnimationState = m_animation;
+    state.Rotation = m_rotation;
+    EngineSnapshotWriter writer;
+    writer.AddValue(SnapshotState, state);
+    writer.AddVector(SnapshotCone, m_cone);
+    writer.AddVector(SnapshotDisk, m_disk);
+    return writer.Save(m_snapshotPath.c_str(), m_snapshotHash);
+}
+
+bool VCCRenderingEngine1::RestoreSnapshot()
+{
+    VCC_TRACE_SCOPE("RestoreSnapshot");
+    EngineSnapshot snapshot;
+    if (!snapshot.Open(m_snapshotPath.c_str(), m_snapshotHash))
+        return false;
+    Engine1SnapshotState state;
+    if (!snapshot.ReadValue(SnapshotState, state) || !snapshot.ReadVector(SnapshotCone, m_cone)
+        || !snapshot.ReadVector(SnapshotDisk, m_disk) || m_cone.empty() || m_disk.empty()) {
+        std::cout << "Snapshot " << m_snapshotPath << " is incomplete" << std::endl;
+        m_cone.clear();
+        m_disk.clear();
+        return false;
+    }
+    m_animation = state.AnimationState;
+    m_rotation = state.Rotation;
+    m_previousRotation = m_animation.Current;
+    m_restoredBytes = snapshot.Size();
+    return true;
+}
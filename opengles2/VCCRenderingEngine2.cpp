@@ -15,18 +15,86 @@
 #include "VCCRenderingEngine.hpp"
 
 #include "Quaternion.hpp"
+#include "MeshFile.hpp"
+#include "RenderQueue.hpp"
+#include "DynamicResolution.hpp"
+#include "OcclusionCuller.hpp"
+#include "JobSystem.hpp"
+#include "LevelOfDetail.hpp"
+#include "StreamingScene.hpp"
+#include "EngineSnapshot.hpp"
+#include "PhaseTimer.hpp"
+#include "Tessellation.hpp"
+#include "Tracing.hpp"
+#include "GLResource.hpp"
+#include "RayPicking.hpp"
+#include "FixedTimestep.hpp"
+#include "Texture.hpp"
+#include "VertexStream.hpp"
+#include <stddef.h>
+#include <string.h>
 #include <vector>
+#include <cmath>
 
 #include <iostream>
 #define STRINGIFY(A) #A
 
 #include "Shaders/Simple.frag"
 #include "Shaders/Simple.vert"
+#include "Shaders/Quaternion.vert"
+#include "Shaders/Blit.frag"
+#include "Shaders/Blit.vert"
+#include "Shaders/Textured.frag"
 static const float AnimationDuration = 0.25f;
+// 以固定步长推进动画（参见 FixedTimestep.hpp），绘制时在最近两步的方位之间插值；步长可大于显示链接的间隔。
+static const bool UseFixedTimestep = false;
+static const float FixedTimestepSeconds = 1.0f / 30;
+static const int MaxFixedSteps = 4;
+// 以 16 位整数存储椎体的位置坐标（参见 Quantization.hpp），反量化矩阵预先乘入 Modelview 矩阵。
+static const bool UseQuantizedPositions = false;
+// 根据帧时间动态调整场景的渲染分辨率（参见 DynamicResolution.hpp），再放大至屏幕。
+static const bool UseDynamicResolution = false;
+// 绘制之前以 CPU 光栅化的层级深度剔除被椎体完全遮挡的物体（参见 OcclusionCuller.hpp）。
+static const bool UseOcclusionCulling = false;
+// 遮挡体代理所用的椎体片段数；顶点位于椎体表面上，因此代理内接于椎体，剔除是保守的。
+static const int OccluderSlices = 12;
+// 依据椎体在屏幕上的投影尺寸，从预先生成的 LOD 链中选择片段数（参见 LevelOfDetail.hpp）。
+static const bool UseLevelOfDetail = false;
+// 以 StreamingScene 流式生成并绘制由大量椎体实例构成的网格场景，取代单个椎体；实例总数约一千万。
+static const bool UseStreamingScene = false;
+static const uint32_t StreamingSceneColumns = 3200;
+static const uint32_t StreamingSceneRows = 3200;
+// 以四元数与平移（7 个浮点数）取代 Modelview 矩阵提交物体的变换，旋转由顶点着色器完成（参见 Shaders/Quaternion.vert）。
+static const bool UseGpuQuaternions = false;
+// 在此基础上，动画期间提交起止四元数与插值系数，由顶点着色器做归一化线性插值，CPU 不再逐帧计算 Slerp；
+// nlerp 的起止方位与 Slerp 相同，但动画中途的角速度并不均匀，旋转角度越大差异越明显（参见 Tools/Benchmark.cpp 中的 transforms）。
+static const bool UseGpuQuaternionBlend = false;
+// 遮挡剔除、LOD 选择与流式场景仍在 CPU 上使用旋转矩阵。
+static const bool UseRotationMatrix = !UseGpuQuaternions || UseOcclusionCulling || UseLevelOfDetail || UseStreamingScene;
+// 以纹理图集为椎体与底盘增加细节，纹理与顶点颜色相乘（参见 Texture.hpp）；mipmap 链在 Prepare() 中与网格同时在 CPU 上生成。
+static const bool UseTextures = false;
+static const int ConeTextureSize = 128;
+static const MipFilter TextureMipFilter = MipFilterKaiser;
+static const int AtlasPadding = 4;
+static const int MaxAtlasSize = 2048;
+// 椎体每帧形变（顶点起伏、圆周行波），形变后的顶点经写指针直接写入流式顶点缓冲区，不再每帧重建数组并以客户端指针提交
+// （参见 VertexStream.hpp）。形变作用于浮点坐标，开启 UseQuantizedPositions 时不生效。
+static const bool UseMorphingCone = false;
+static const float MorphAmplitude = 0.15f;
+static const float MorphRadiansPerSecond = 4;
+static const size_t VertexStreamBytes = 256 * 1024;
+static const unsigned int VertexStreamRegions = 3;     // 须多于 GPU 落后于 CPU 的帧数
+static const VertexStreamSync VertexStreamMode = VertexStreamFence;
+// 估算显存的预算（字节），0 表示不限制；载入的网格会使总量超出预算时，LoadMesh() 拒绝载入（参见 GLResource.hpp）。
+static const size_t GLMemoryBudget = 0;
 using namespace std;
-struct Vertex{
-    vec3 Position;
-    vec4 Color;
+
+// 渲染队列中用于区分各组顶点数据的标识符。
+enum VertexSourceId {
+    VertexSourceCone = 1,
+    VertexSourceDisk,
+    VertexSourceMesh,
+    VertexSourceMorphedCone,
 };
 
 // Animation 结构将开启 3D 转换功能并包含了初始方位、当前差值方位以及结束方位3个方向上的四元数。
@@ -43,37 +111,244 @@ struct Animation{
 
 
 
+// 快照中的数据块编号，各 LOD 级别的网格依次占用 SnapshotCone + level 等编号。
+enum SnapshotBlockId {
+    SnapshotState = 1,
+    SnapshotOccluder,
+    SnapshotCone = 16,
+    SnapshotDisk = SnapshotCone + LodLevelCount,
+    SnapshotQuantizedCone = SnapshotDisk + LodLevelCount,
+    SnapshotQuantizedDisk = SnapshotQuantizedCone + LodLevelCount,
+};
+
+// 快照中除网格以外的引擎状态，各字段均可按位复制。
+struct Engine2SnapshotState {
+    mat4 Projection;
+    mat4 Dequantization;
+    vec3 ConeBoundsMin, ConeBoundsMax;
+    vec3 DiskBoundsMin, DiskBoundsMax;
+    vec3 ConeSphereCenter;
+    float ConeSphereRadius;
+    Animation AnimationState;
+    mat4 Rotation;
+    GLint PositionSlot, ColorSlot, ModelviewUniform, ProjectionUniform;
+    GLint BlitPositionSlot, BlitTexCoordScaleUniform, BlitTexCoordMaxUniform, BlitSceneUniform;
+    GLint TransformUniform;
+    GLint TexCoordSlot, TextureUniform;
+    uint64_t DriverHash;                // 以上位置所属的 GL 驱动
+};
+
+// 本引擎持有的各类 GL 对象，参见 GLResource.hpp。
+struct Engine2Renderbuffer {
+    static const GLResourceCategory Category = GLResourceRenderbuffer;
+    static GLuint Generate() { GLuint name; glGenRenderbuffers(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteRenderbuffers(1, &name); }
+};
+struct Engine2Framebuffer {
+    static const GLResourceCategory Category = GLResourceFramebuffer;
+    static GLuint Generate() { GLuint name; glGenFramebuffers(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteFramebuffers(1, &name); }
+};
+struct Engine2Texture {
+    static const GLResourceCategory Category = GLResourceTexture;
+    static GLuint Generate() { GLuint name; glGenTextures(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteTextures(1, &name); }
+};
+struct Engine2Buffer {
+    static const GLResourceCategory Category = GLResourceBuffer;
+    static GLuint Generate() { GLuint name; glGenBuffers(1, &name); return name; }
+    static void Delete(GLuint name) { glDeleteBuffers(1, &name); }
+};
+// VertexStream 所需的 GL 调用：EXT_map_buffer_range 映射，APPLE_sync 栅栏。
+struct Engine2StreamTraits {
+    typedef GLsync Fence;
+    static void* Map(GLuint buffer, size_t offset, size_t bytes)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        return glMapBufferRangeEXT(GL_ARRAY_BUFFER, offset, bytes,
+                                   GL_MAP_WRITE_BIT_EXT | GL_MAP_INVALIDATE_RANGE_BIT_EXT | GL_MAP_UNSYNCHRONIZED_BIT_EXT);
+    }
+    static void Unmap(GLuint) { glUnmapBufferOES(GL_ARRAY_BUFFER); }
+    static void Orphan(GLuint buffer, size_t bytes)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, 0, GL_STREAM_DRAW);
+    }
+    static GLsync InsertFence() { return glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0); }
+    static bool FenceSignaled(GLsync fence) { return glClientWaitSyncAPPLE(fence, 0, 0) != GL_TIMEOUT_EXPIRED_APPLE; }
+    static void WaitFence(GLsync fence)
+    {
+        glClientWaitSyncAPPLE(fence, GL_SYNC_FLUSH_COMMANDS_BIT_APPLE, GL_TIMEOUT_IGNORED_APPLE);
+    }
+    static void DeleteFence(GLsync fence) { glDeleteSyncAPPLE(fence); }
+};
+// 着色器程序由 BuildProgram() 创建后交由句柄接管。
+struct Engine2Program {
+    static const GLResourceCategory Category = GLResourceProgram;
+    static void Delete(GLuint name) { glDeleteProgram(name); }
+};
+
 //浮点常量以定义对应的角速度；
 static const float RevolutionsPerSecond = 1;
 
 class VCCRenderingEngine2 : public VCCRenderingEngine{
 public:
     VCCRenderingEngine2();
+    ~VCCRenderingEngine2();
     void Initialize(int width, int height);
+    void Prepare(int width, int height);
+    void Finalize();
+    void RenderPlaceholder();
     void Render() const;
     void UpdateAnimation(float timeStep);
     void OnRotate(VCCDeviceOrientation newOrientation);
+    void Resize(int width, int height);
+    bool LoadMesh(const char* path);
+    void SetSnapshotPath(const char* path);
+    bool SaveSnapshot() const;
+    void SetCameras(const Camera* cameras, size_t count);
+    bool Pick(float x, float y, int& object, float& distance) const;
+    VCCFrameStats GetFrameStats() const;
 private:
+    void SelectConeLod(const mat4& modelview) const;
+    QuaternionTransform ObjectTransform() const;
+    void StepAnimation(float timeStep);
+    void QueueConeAndDisk(const mat4& modelview, const QuaternionTransform& transform) const;
+    void MorphCone(int level, DrawItem& item) const;
+    void QueueLoadedMesh(const mat4& modelview, const QuaternionTransform& transform) const;
+    void PushDrawItem(const DrawItem& item) const;
+    void DrawStreamingScene(const mat4& modelview) const;
+    size_t SubmitRenderQueue(const CameraFrustum* frustum = 0) const;
+    void RenderCameras(const mat4& sceneModelview, bool streaming) const;
+    void BindCamera(size_t index, GLuint& boundFramebuffer) const;
+    void GenerateGeometry();
+    uint64_t SnapshotParameterHash() const;
+    uint64_t DriverHash() const;
+    bool RestoreSnapshot();
+    void CreateSceneTarget(bool queryLocations);
+    void UploadTexture();
+    void UpscaleScene() const;
+    int SceneWidth() const;
+    int SceneHeight() const;
     
+    // 登记本引擎全部 GL 对象的估算占用，须声明在所有 GL 句柄之前，以便在它们全部析构之后才检查泄漏。
+    GLResourceRegistry m_glResources;
     // shader ...
     GLuint BuildShader(const char* source, GLenum shaderType) const;
     GLuint BuildProgram(const char* vShader, const char* fShader) const;
-    GLuint m_simpleProgram;
+    GLHandle<Engine2Program> m_simpleProgram;
+    GLuint m_positionSlot;
+    GLuint m_colorSlot;
+    GLint m_modelviewUniform;           // 开启 UseGpuQuaternions 时为着色器中的 Dequantization
+    GLint m_projectionUniform;
+    GLint m_transformUniform;
+    GLuint m_texCoordSlot;              // 以下两项仅在 m_textured 时有效
+    GLint m_textureUniform;
     
     //三角形数据位于两个 STL 容器 m_cone 和 m_disk 中。由于数据尺寸事先已知，向量容器类可视为一类较为理想的数据结构并可确保数据的连续存储。这里，针对 OpenGL，数据的连续存储是十分必要的。
     
-    vector<Vertex> m_cone;
-    vector<Vertex> m_disk;
+    // 数组下标为 LOD 级别，未开启 UseLevelOfDetail 时只生成第 0 级。
+    vector<Vertex> m_cone[LodLevelCount];
+    vector<Vertex> m_disk[LodLevelCount];
+    // 开启 UseQuantizedPositions 时使用的量化顶点，此时 m_cone 和 m_disk 在量化后即被释放。
+    vector<QuantizedVertex> m_quantizedCone[LodLevelCount];
+    vector<QuantizedVertex> m_quantizedDisk[LodLevelCount];
+    // 椎体与底盘作为同一个物体选择级别，两者的圆周顶点因而始终一致，不会出现裂缝。
+    LodSelector m_lodSelector;
+    vec3 m_coneSphereCenter;            // 模型坐标系下的包围球
+    float m_coneSphereRadius;
+    mutable int m_coneLodLevel;
+    // 流式场景的数据块不经过渲染队列：每个数据块上传至同一个顶点缓冲区（每次上传均使旧存储失效）后立即绘制并归还缓冲池，
+    // 所有数据块共享同一个索引缓冲区。
+    mutable StreamingScene m_streamingScene;
+    mutable GLHandle<Engine2Buffer> m_streamVertexBuffer;   // 每次上传后在 const 的 Render() 中更新估算的字节数
+    GLHandle<Engine2Buffer> m_streamIndexBuffer;
+    // 形变椎体的顶点缓冲区及其环形分区；m_coneStream 在缓冲区的句柄之后声明，因而先于缓冲区析构。
+    GLHandle<Engine2Buffer> m_morphVertexBuffer;
+    mutable VertexStream<Engine2StreamTraits> m_coneStream;
+    float m_morphPhase;
+    // 将所绘制网格的顶点坐标还原为模型坐标的矩阵，位置以浮点数存储时为单位矩阵。
+    // m_coneDequantization 只属于椎体与底盘，载入网格后 m_dequantization 改为网格的矩阵。
+    mat4 m_dequantization;
+    mat4 m_coneDequantization;
+    // 各网格的包围盒，与顶点坐标处于同一坐标系（量化时为规格化坐标），用于计算排序键中的视图深度以及遮挡剔除。
+    vec3 m_coneBoundsMin, m_coneBoundsMax;
+    vec3 m_diskBoundsMin, m_diskBoundsMax;
+    vec3 m_meshBoundsMin, m_meshBoundsMax;
+    // 椎体的低精度遮挡体代理（三角形列表，模型坐标）。
+    vector<vec3> m_coneOccluder;
+    mutable OcclusionCuller m_occlusionCuller;
+    mat4 m_projection;
+    // 每帧重新填充的渲染队列；声明为 mutable 以便在 Render() 中复用其存储空间。
+    mutable RenderQueue m_renderQueue;
+    // SetCameras() 设置的摄像机及其 View * Projection 与视锥，为空时按 Initialize() 的单一视口与 m_projection 绘制。
+    vector<Camera> m_cameras;
+    vector<mat4> m_cameraViewProjections;
+    vector<CameraFrustum> m_cameraFrusta;
+    // 多摄像机模式下各绘制命令的包围球（按排序后的顺序，w 为半径），每帧只变换一次，供所有摄像机的视锥测试共用。
+    mutable vector<vec4> m_itemSpheres;
+    // 引擎持有的任务调度器。UpdateAnimation() 将动画更新作为任务提交，Render() 在使用其结果之前等待 m_animationJobs。
+    mutable JobSystem m_jobs;
+    mutable JobCounter m_animationJobs;
     Animation m_animation;
+    mat4 m_rotation;
+    // 开启 UseFixedTimestep 时使用：最近一步之前的方位，绘制时按 m_clock.Alpha() 在它与 m_animation.Current 之间插值。
+    FixedTimestep m_clock;
+    Quaternion m_previousRotation;
     //float m_desiredAngle;
     //float m_currentAngle;
-    GLuint m_framebuffer;
+    GLHandle<Engine2Framebuffer> m_framebuffer;
     //GLuint m_renderbuffer;
     
     //与 HelloArrow 程序不同，此处定义了两个渲染缓冲区。HelloArrow 程序执行 2d 渲染操作，因而仅使用了一个颜色缓冲区；而 helloCone 程序则需要需要新增一个缓冲区用于存储场景的深度值。简而言之，深度缓冲区可视为一类在各像素处存储 Z 值得特定的图像平面。
     //
-    GLuint m_colorRenderbuffer;
-    GLuint m_depthRenderbuffer;
+    GLHandle<Engine2Renderbuffer> m_colorRenderbuffer;
+    GLHandle<Engine2Renderbuffer> m_depthRenderbuffer;
+    int m_width;
+    int m_height;
+    
+    // 动态分辨率模式下的离屏渲染目标。纹理按屏幕尺寸一次性分配，场景仅绘制到其左下角按比例缩小的区域，
+    // 因此调整比例时无需重新分配任何存储空间。
+    GLHandle<Engine2Framebuffer> m_sceneFramebuffer;
+    GLHandle<Engine2Texture> m_sceneTexture;
+    GLHandle<Engine2Program> m_blitProgram;
+    GLuint m_blitPositionSlot;
+    GLint m_blitTexCoordScaleUniform;
+    GLint m_blitTexCoordMaxUniform;
+    GLint m_blitSceneUniform;
+    DynamicResolutionController m_resolution;
+    
+    // 开启 UseTextures 时的纹理图集。m_textureLevels 为 Prepare() 生成的 mipmap 链，Finalize() 上传之后即释放；
+    // m_textureRegions 的下标为 ConeTexture，m_whiteTexCoord 为白色区域的中心，供没有纹理坐标的网格使用。
+    GLHandle<Engine2Texture> m_texture;
+    vector<TextureImage> m_textureLevels;
+    vector<AtlasRegion> m_textureRegions;
+    vec2 m_whiteTexCoord;
+    // 开启 UseTextures 且图集打包成功；打包失败时退回无纹理的绘制，而不是在后台线程上终止进程。
+    bool m_textured;
+    
+    // 由 LoadMesh() 载入的网格。文件映射中的顶点与索引数据被直接交给 glBufferData 上传，随后即解除映射，
+    // 引擎仅保留头部、顶点布局以及绘制区间这类小型元数据。m_meshVertexBuffer 为 0 时绘制程序化生成的椎体。
+    GLHandle<Engine2Buffer> m_meshVertexBuffer;
+    GLHandle<Engine2Buffer> m_meshIndexBuffer;
+    MeshFileHeader m_meshHeader;
+    vector<MeshFileAttribute> m_meshAttributes;
+    vector<MeshFileSubmesh> m_meshSubmeshes;
+    // 以编号为 0 的单位实例代表椎体与底盘，与所选的 LOD 级别无关。
+    RayPicker m_picker;
+    
+    // 预热启动所用的快照，路径为空时不读写快照。
+    string m_snapshotPath;
+    uint64_t m_snapshotHash;
+    bool m_restored;
+    uint64_t m_restoredBytes;           // 最近一次初始化从快照恢复的字节数，经 GetFrameStats() 报告
+    // 着色器变量的位置取决于 GL 驱动；快照记录写入时的驱动标识，Finalize() 据此决定能否沿用快照中的位置。
+    uint64_t m_driverHash;
+    uint64_t m_restoredDriverHash;
+    // 初始化各阶段的耗时，Prepare() 与 Finalize() 可能位于不同的线程，但二者不会同时执行。
+    PhaseTimer m_initPhases;
+    // GetFrameStats() 返回的提交量统计，在 const 的 Render() 中累加。
+    mutable FrameStatsRecorder m_frameStats;
 };
 
 //其中， UpdateAnimation() 和 OnRotate()通过桩函数（存根函数）实现，且需要进一步完善以支持旋转操作
@@ -84,10 +359,20 @@ VCCRenderingEngine* CreateRenderer2()
     return new VCCRenderingEngine2();
 }
 VCCRenderingEngine2::VCCRenderingEngine2()
+    : m_glResources("ES 2.0 engine", GLMemoryBudget), m_coneLodLevel(0), m_morphPhase(0),
+      m_clock(FixedTimestepSeconds, MaxFixedSteps), m_restored(false), m_restoredBytes(0)
 {
     //生成渲染缓冲区操作符并将其绑定至管线上。
-    glGenRenderbuffers(1, &m_colorRenderbuffer);
+    m_colorRenderbuffer.Create(m_glResources, "color renderbuffer");
     glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
+    PickInstance cone = { vec3(0, 0, 0), 1, 0 };
+    m_picker.SetInstances(&cone, 1);
+}
+
+// GL 对象由各句柄在成员析构时删除，调用者须保证引擎的 GL 上下文为当前上下文；动画任务仍可能在写入成员，须先等待其完成。
+VCCRenderingEngine2::~VCCRenderingEngine2()
+{
+    m_jobs.Wait(m_animationJobs);
 }
 
 //Initialize()方法将构建视口变换居正以及投影矩阵。其中，投影矩阵定义了一个当前可见场景的 3D 空间
@@ -95,99 +380,194 @@ VCCRenderingEngine2::VCCRenderingEngine2()
 //待生成全部顶点后，代码将对 OpenGL 帧缓冲区对象以及转换状态进行初始化操作。
 //鉴于当前程序包含了大量的 3D 操作，因而需要开启深度测试。
 
-void VCCRenderingEngine2::Initialize(int width, int height)
+// 将模型坐标换算至量化后的顶点坐标系，即反量化变换 p * Scale + Offset 的逆变换。
+static vec3 ToVertexSpace(const vec3& p, const vec3& scale, const vec3& offset)
+{
+    return vec3((p.x - offset.x) / scale.x, (p.y - offset.y) / scale.y, (p.z - offset.z) / scale.z);
+}
+
+// 生成各网格并求出其包围盒，开启 UseQuantizedPositions 时随后量化。快照有效时不会调用。
+void VCCRenderingEngine2::GenerateGeometry()
 {
+    VCC_TRACE_SCOPE("GenerateGeometry");
     // 将对象分解为三角形的过程通常称作三角形剖分，更常见的称谓为细分操作，进而反映了更为广泛的表面多边形填充问题。
     
-    // 针对圆和椎体，定义相关常量。
-    const float coneRadius = 0.5f;
-    const float coneHeight = 1.866f;
-    const int coneSlices = 40;
+    // 针对圆和椎体生成顶点，相关常量与生成过程参见 Mesh.hpp。
+    // 各网格在不同的工作线程上生成，片段数很高时各自再划分为多个任务（参见 Tessellation.hpp）；包围盒的计算则依赖于网格生成任务的完成。
+    // 各 LOD 级别的圆周顶点都落在同一个圆上，因而共享第 0 级的包围盒。
+    int lodLevels = UseLevelOfDetail ? LodLevelCount : 1;
+    JobCounter meshJobs, boundsJobs;
+    for (int level = 0; level < lodLevels; ++level) {
+        m_jobs.Run([this, level]() { TessellateDisk(m_jobs, m_disk[level], ConeRadius, ConeHeight, LodSlices[level]); }, &meshJobs);
+        m_jobs.Run([this, level]() { TessellateCone(m_jobs, m_cone[level], ConeRadius, ConeHeight, LodSlices[level]); }, &meshJobs);
+    }
+    m_jobs.Run([this]() { ComputeBounds(&m_cone[0][0], m_cone[0].size(), m_coneBoundsMin, m_coneBoundsMax); }, &boundsJobs, &meshJobs);
+    m_jobs.Run([this]() { ComputeBounds(&m_disk[0][0], m_disk[0].size(), m_diskBoundsMin, m_diskBoundsMax); }, &boundsJobs, &meshJobs);
     
-    // Generate vertices for the disk
-    {
-        // 分配底盘点
-        m_disk.resize(coneSlices + 2);
-        
-        // 初始化为 GL_TRIANGLE_FAN 拓扑关系
-        // 初始化底盘中心点
-        vector<Vertex>::iterator vertex_it = m_disk.begin();
-        vertex_it->Color = vec4(0.75, 0.75, 0.75, 1);
-        vertex_it->Position.x = 0;
-        vertex_it->Position.y = 1 - coneHeight;
-        vertex_it->Position.z = 0;
-        vertex_it++;
-        
-        // 初始化底盘圆周点
-        const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex_it != m_disk.end(); theta += dtheta) {
-            vertex_it->Color = vec4(0.75, 0.75, 0.75, 1);
-            vertex_it->Position.x = coneRadius * cos(theta);
-            vertex_it->Position.y = 1 - coneHeight;
-            vertex_it->Position.z = coneRadius * sin(theta);
-            vertex_it++;
+    if (UseOcclusionCulling) {
+        // 将低精度椎体的三角形带展开为三角形列表。
+        m_jobs.Run([this]() {
+            vector<Vertex> occluder;
+            GenerateCone(occluder, ConeRadius, ConeHeight, OccluderSlices);
+            for (size_t i = 2; i < occluder.size(); ++i) {
+                m_coneOccluder.push_back(occluder[i - 2].Position);
+                m_coneOccluder.push_back(occluder[i - 1].Position);
+                m_coneOccluder.push_back(occluder[i].Position);
+            }
+        }, &meshJobs);
+    }
+    m_jobs.Wait(meshJobs);
+    m_jobs.Wait(boundsJobs);
+    
+    // 纹理坐标须在量化之前换算至图集中。
+    if (m_textured) {
+        for (int level = 0; level < lodLevels; ++level) {
+            RemapTexCoords(&m_cone[level][0], m_cone[level].size(), m_textureRegions[ConeTextureCone]);
+            RemapTexCoords(&m_disk[level][0], m_disk[level].size(), m_textureRegions[ConeTextureDisk]);
         }
-        
     }
     
-    // Generate bertices for the body of the cone
-    {
-        // 分配椎体点
-        m_cone.resize((coneSlices + 1) * 2);
+    // 椎体的包围盒已包含底盘。
+    m_coneSphereCenter = (m_coneBoundsMin + m_coneBoundsMax) / 2;
+    vec3 extent = m_coneBoundsMax - m_coneBoundsMin;
+    m_coneSphereRadius = std::sqrt(extent.Dot(extent)) / 2;
+    
+    if (UseQuantizedPositions) {
+        // 椎体与底盘共享同一个包围盒，从而只需一个反量化矩阵。
+        const vec3& coneMin = m_coneBoundsMin;
+        const vec3& coneMax = m_coneBoundsMax;
+        const vec3& diskMin = m_diskBoundsMin;
+        const vec3& diskMax = m_diskBoundsMax;
+        vec3 boundsMin(min(coneMin.x, diskMin.x), min(coneMin.y, diskMin.y), min(coneMin.z, diskMin.z));
+        vec3 boundsMax(max(coneMax.x, diskMax.x), max(coneMax.y, diskMax.y), max(coneMax.z, diskMax.z));
+        PositionQuantization quantization = ComputePositionQuantization(boundsMin, boundsMax);
         
-        // 初始化为 GL_TRISNGLES_STRIP 三角带拓扑关系.
-        vector<Vertex>::iterator vertex_it = m_cone.begin();
-        const float dtheta = TwoPi / coneSlices;
-        for (float theta = 0; vertex_it != m_cone.end(); theta += dtheta) {
-            
-            // Grayscale gradient
-            // 为了简化光照模拟计算，这里采用了灰度梯度值，其中，颜色值使用了固定值，且不会随对象位置的变化而变化，
-            // 该技术有时也称作烘焙光照。
-            float brightness = abs(sin(theta));
-            vec4 color(brightness, brightness, brightness, 1);
-            
-            // 顶点
-            vertex_it->Position = vec3(0, 1, 0);
-            vertex_it->Color = color;
-            vertex_it++;
-            
-            // 圆周点
-            vertex_it->Position.x = coneRadius * cos(theta);
-            vertex_it->Position.y = 1 - coneHeight;
-            vertex_it->Position.z = coneRadius * sin(theta);
-            vertex_it->Color = color;
-            vertex_it++;
+        for (int level = 0; level < lodLevels; ++level) {
+            m_quantizedCone[level].resize(m_cone[level].size());
+            m_quantizedDisk[level].resize(m_disk[level].size());
+            QuantizePositions(&m_cone[level][0], m_cone[level].size(), quantization, &m_quantizedCone[level][0]);
+            QuantizePositions(&m_disk[level][0], m_disk[level].size(), quantization, &m_quantizedDisk[level][0]);
         }
+        m_coneDequantization = DequantizationMatrix(quantization);
+        // Scale 各分量均为正数，换算后包围盒的最小、最大顶点不会互换。
+        m_coneBoundsMin = ToVertexSpace(m_coneBoundsMin, quantization.Scale, quantization.Offset);
+        m_coneBoundsMax = ToVertexSpace(m_coneBoundsMax, quantization.Scale, quantization.Offset);
+        m_diskBoundsMin = ToVertexSpace(m_diskBoundsMin, quantization.Scale, quantization.Offset);
+        m_diskBoundsMax = ToVertexSpace(m_diskBoundsMax, quantization.Scale, quantization.Offset);
+        
+        QuantizationErrorReport coneError = MeasureQuantizationError(&m_cone[0][0], &m_quantizedCone[0][0], m_cone[0].size(), quantization);
+        QuantizationErrorReport diskError = MeasureQuantizationError(&m_disk[0][0], &m_quantizedDisk[0][0], m_disk[0].size(), quantization);
+        std::cout << "Position quantization error: cone max " << coneError.MaxError << " rms " << coneError.RmsError
+                  << ", disk max " << diskError.MaxError << " rms " << diskError.RmsError << std::endl;
+        
+        for (int level = 0; level < lodLevels; ++level) {
+            vector<Vertex>().swap(m_cone[level]);
+            vector<Vertex>().swap(m_disk[level]);
+        }
+    }
+}
+
+void VCCRenderingEngine2::Initialize(int width, int height)
+{
+    Prepare(width, height);
+    Finalize();
+}
 
+// 初始化中不需要 GL 上下文的部分：读取快照或生成网格，可在后台线程上执行。
+void VCCRenderingEngine2::Prepare(int width, int height)
+{
+    VCC_TRACE_SCOPE("Prepare");
+    m_initPhases.Restart();
+    m_width = width;
+    m_height = height;
+
+    // 图集的布局在读取快照与生成网格之前确定，以便换算网格的纹理坐标；快照中的网格已经换算过。
+    // 是否使用纹理参与快照的参数散列，打包失败时因而不会恢复按图集换算过纹理坐标的网格。
+    TextureImage atlas;
+    m_textured = false;
+    if (UseTextures) {
+        TextureImage images[ConeTextureCount];
+        GenerateConeTextures(ConeTextureSize, images);
+        m_textured = PackTextureAtlas(images, ConeTextureCount, AtlasPadding, MaxAtlasSize, atlas, m_textureRegions);
+        if (m_textured) {
+            m_whiteTexCoord = AtlasTexCoord(m_textureRegions[ConeTextureWhite], vec2(0.5f, 0.5f));
+        } else {
+            // PackTextureAtlas() 已输出失败的原因。
+            std::cout << "Drawing the cone without textures" << std::endl;
+            m_textureRegions.clear();
+        }
+        m_initPhases.Mark("texture atlas");
+    }
+
+    m_snapshotHash = SnapshotParameterHash();
+    m_restoredBytes = 0;
+    m_restored = !m_snapshotPath.empty() && RestoreSnapshot();
+    m_initPhases.Mark("snapshot restore");
+    
+    // mipmap 链不在快照中，总是重新生成，其任务与网格生成同时执行。
+    JobCounter textureJobs;
+    if (m_textured)
+        m_jobs.Run([this, &atlas]() { GenerateMipChain(atlas, TextureMipFilter, m_textureLevels, &m_jobs); }, &textureJobs);
+    
+    if (!m_restored) {
+        GenerateGeometry();
+        m_projection = mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10);
+        m_initPhases.Mark("geometry");
+    }
+    if (m_textured) {
+        m_jobs.Wait(textureJobs);
+        m_initPhases.Mark("textures");
     }
+    m_dequantization = m_coneDequantization;
+    // 排序键中的视图深度在近、远裁剪面之间量化。
+    m_renderQueue.SetDepthRange(5, 10);
     
+    if (UseStreamingScene) {
+        // 网格场景的边长约为 3，恰好覆盖视口。
+        float spacing = 3.0f / StreamingSceneColumns;
+        m_streamingScene.SetGrid(StreamingSceneColumns, StreamingSceneRows, spacing, spacing * 0.4f);
+    }
+}
+
+// 初始化中需要 GL 上下文的部分，须在渲染线程上于 Prepare() 完成之后调用。
+void VCCRenderingEngine2::Finalize()
+{
+    VCC_TRACE_SCOPE("Finalize");
+    m_initPhases.Mark("wait for render thread");
     
     // 创建深度缓存
     // 生成深度缓冲区 ID，实施绑定操作并分配储存空间。
-    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    m_depthRenderbuffer.Create(m_glResources, "depth renderbuffer");
     glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, m_width, m_height);
+    m_depthRenderbuffer.SetBytes(size_t(m_width) * m_height * 2);
+    // 颜色渲染缓冲区的存储由 EAGLContext 按图层分配，按 RGBA8 估算。
+    m_colorRenderbuffer.SetBytes(size_t(m_width) * m_height * 4);
     
     
     
     
     //Create the framebuffer object and attach the depth and color buffer
     // 生成帧缓冲区对象 ID，实施绑定操作，并通过 glFramebufferRenderbufferOES 将其与颜色值和深度值进行关联。
+    // 绘制过占位画面时帧缓冲区已经存在，参见 RenderPlaceholder()。
     
     
-    
-    glGenFramebuffers(1, &m_framebuffer);
+    if (!m_framebuffer)
+        m_framebuffer.Create(m_glResources, "framebuffer");
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRenderbuffer);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    // 动态分辨率模式下深度缓冲区改为附着于离屏帧缓冲区，参见 CreateSceneTarget()。
+    if (!UseDynamicResolution)
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
     
     // Bind the color buffer for rendering
     // 绑定颜色渲染缓冲区并使未来的渲染操作与其发生关联。
     glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
     // 构建视口的左、下、宽、以及高度属性值。
-    glViewport(0, 0, width, height);
+    glViewport(0, 0, m_width, m_height);
     // 针对 3D 场景，开启深度测试功能。
     glEnable(GL_DEPTH_TEST);
+    m_initPhases.Mark("framebuffers");
     //    构建投影和模型-视图转换，针对 ES 2.0 规范，相关内容不再有效
     //    glMatrixMode(GL_PROJECTION);
     //    glFrustumf(-1.6f, 1.6, -2.4, 2.4, 5, 10);
@@ -195,15 +575,172 @@ void VCCRenderingEngine2::Initialize(int width, int height)
     //    glTranslatef(0, 0, -7);
     
     //    修改如下
-    m_simpleProgram = BuildProgram(SimpleVertexShader, SimpleFragmentShader);
+    const char* vertexShader = UseGpuQuaternions ? QuaternionVertexShader : SimpleVertexShader;
+    const char* fragmentShader = m_textured ? TexturedFragmentShader : SimpleFragmentShader;
+    m_simpleProgram.Adopt(m_glResources, BuildProgram(vertexShader, fragmentShader), "simple program");
+    m_simpleProgram.SetBytes(strlen(vertexShader) + strlen(fragmentShader));
     //
     glUseProgram(m_simpleProgram);
+    // 属性与 uniform 的位置在程序链接后即不再变化，因而只需查询一次；
+    // 快照来自同一驱动时直接沿用其中记录的位置，驱动不同（例如系统升级后）则重新查询。
+    m_driverHash = DriverHash();
+    bool reuseLocations = m_restored && m_restoredDriverHash == m_driverHash;
+    if (!reuseLocations) {
+        m_positionSlot = glGetAttribLocation(m_simpleProgram, "Position");
+        m_colorSlot = glGetAttribLocation(m_simpleProgram, "SourceColor");
+        m_modelviewUniform = glGetUniformLocation(m_simpleProgram, UseGpuQuaternions ? "Dequantization" : "Modelview");
+        m_projectionUniform = glGetUniformLocation(m_simpleProgram, "Projection");
+        m_transformUniform = UseGpuQuaternions ? glGetUniformLocation(m_simpleProgram, "Transform") : -1;
+        m_texCoordSlot = m_textured ? glGetAttribLocation(m_simpleProgram, "SourceTexCoord") : 0;
+        m_textureUniform = m_textured ? glGetUniformLocation(m_simpleProgram, "Texture") : -1;
+    }
     // Set projection matrix
-    GLuint projectionUniform = glGetUniformLocation(m_simpleProgram, "Projection");
-    mat4 projectionMatrix = mat4::Frustum(-1.6f, 1.6, -2.4, 2.4, 5, 10);
-    glUniformMatrix4fv(projectionUniform, 1, 0, projectionMatrix.Pointer());
+    glUniformMatrix4fv(m_projectionUniform, 1, 0, m_projection.Pointer());
+    if (m_textured)
+        UploadTexture();
+    
+    if (UseDynamicResolution)
+        CreateSceneTarget(!reuseLocations);
+    m_initPhases.Mark("shaders");
+    
+    if (UseStreamingScene) {
+        m_streamVertexBuffer.Create(m_glResources, "streaming vertex buffer");
+        m_streamIndexBuffer.Create(m_glResources, "streaming index buffer");
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_streamIndexBuffer);
+        const vector<uint16_t>& indices = m_streamingScene.Indices();
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), &indices[0], GL_STATIC_DRAW);
+        m_streamIndexBuffer.SetBytes(indices.size() * sizeof(uint16_t));
+        m_frameStats.Buffer(indices.size() * sizeof(uint16_t));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        m_initPhases.Mark("streaming buffers");
+    }
+    
+    if (UseMorphingCone && m_quantizedCone[0].empty()) {
+        m_morphVertexBuffer.Create(m_glResources, "morphing cone stream");
+        glBindBuffer(GL_ARRAY_BUFFER, m_morphVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, VertexStreamBytes, 0, GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        m_morphVertexBuffer.SetBytes(VertexStreamBytes);
+        m_coneStream.Attach(m_morphVertexBuffer, VertexStreamBytes, VertexStreamRegions, VertexStreamMode);
+    }
+    
+    if (!reuseLocations && !m_snapshotPath.empty()) {
+        SaveSnapshot();
+        m_initPhases.Mark("snapshot write");
+    }
+}
 
+// Finalize() 之前只有颜色渲染缓冲区可用：为其单独创建帧缓冲区并以场景的背景色清屏，Finalize() 随后沿用该帧缓冲区。
+void VCCRenderingEngine2::RenderPlaceholder()
+{
+    if (!m_framebuffer) {
+        m_framebuffer.Create(m_glResources, "framebuffer");
+        glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorRenderbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
+    }
+    glClearColor(0.5f, 0.5f, 0.5f, 1);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void VCCRenderingEngine2::CreateSceneTarget(bool queryLocations)
+{
+    m_sceneTexture.Create(m_glResources, "scene texture");
+    glBindTexture(GL_TEXTURE_2D, m_sceneTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    m_sceneTexture.SetBytes(size_t(m_width) * m_height * 4);
     
+    m_sceneFramebuffer.Create(m_glResources, "scene framebuffer");
+    glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_sceneTexture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Incomplete scene framebuffer" << std::endl;
+        exit(1);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    
+    m_blitProgram.Adopt(m_glResources, BuildProgram(BlitVertexShader, BlitFragmentShader), "blit program");
+    m_blitProgram.SetBytes(strlen(BlitVertexShader) + strlen(BlitFragmentShader));
+    glUseProgram(m_blitProgram);
+    if (queryLocations) {
+        m_blitPositionSlot = glGetAttribLocation(m_blitProgram, "Position");
+        m_blitTexCoordScaleUniform = glGetUniformLocation(m_blitProgram, "TexCoordScale");
+        m_blitTexCoordMaxUniform = glGetUniformLocation(m_blitProgram, "TexCoordMax");
+        m_blitSceneUniform = glGetUniformLocation(m_blitProgram, "Scene");
+    }
+    glUniform1i(m_blitSceneUniform, 0);
+}
+
+// 上传 Prepare() 生成的图集及其 mipmap 链，绑定于 0 号纹理单元；须在 m_simpleProgram 启用时调用。
+void VCCRenderingEngine2::UploadTexture()
+{
+    m_texture.Create(m_glResources, "texture atlas");
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    // 尺寸不是 2 的幂时只有第 0 级，ES 2.0 也不允许其使用 mipmap 过滤。
+    bool mipmapped = m_textureLevels.size() > 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    for (size_t level = 0; level < m_textureLevels.size(); ++level) {
+        const TextureImage& image = m_textureLevels[level];
+        glTexImage2D(GL_TEXTURE_2D, (GLint) level, GL_RGBA, image.Width, image.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &image.Pixels[0]);
+    }
+    m_texture.SetBytes(MipChainBytes(m_textureLevels));
+    vector<TextureImage>().swap(m_textureLevels);
+    glUniform1i(m_textureUniform, 0);
+}
+
+int VCCRenderingEngine2::SceneWidth() const
+{
+    return max(1, int(m_width * m_resolution.Scale() + 0.5f));
+}
+
+int VCCRenderingEngine2::SceneHeight() const
+{
+    return max(1, int(m_height * m_resolution.Scale() + 0.5f));
+}
+
+// 将离屏纹理中的场景区域放大绘制至屏幕的颜色渲染缓冲区。
+void VCCRenderingEngine2::UpscaleScene() const
+{
+    VCC_TRACE_SCOPE("UpscaleScene");
+    // 深度值在放大后不再需要，告知驱动无需将其写回内存。
+    const GLenum discards[] = { GL_DEPTH_ATTACHMENT };
+    glDiscardFramebufferEXT(GL_FRAMEBUFFER, 1, discards);
+    glDisable(GL_SCISSOR_TEST);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_width, m_height);
+    glDisable(GL_DEPTH_TEST);
+    m_frameStats.StateChange(2);
+    
+    glUseProgram(m_blitProgram);
+    glBindTexture(GL_TEXTURE_2D, m_sceneTexture);
+    m_frameStats.StateChange(2);
+    int sceneWidth = SceneWidth();
+    int sceneHeight = SceneHeight();
+    glUniform2f(m_blitTexCoordScaleUniform, float(sceneWidth) / m_width, float(sceneHeight) / m_height);
+    // 双线性过滤不应采样到场景区域之外的纹素。
+    glUniform2f(m_blitTexCoordMaxUniform, (sceneWidth - 0.5f) / m_width, (sceneHeight - 0.5f) / m_height);
+    m_frameStats.Uniform(2 * 2 * sizeof(GLfloat));
+    
+    static const GLfloat quad[] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+    glEnableVertexAttribArray(m_blitPositionSlot);
+    glVertexAttribPointer(m_blitPositionSlot, 2, GL_FLOAT, GL_FALSE, 0, quad);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_frameStats.StateChange();
+    m_frameStats.Draw(4, PrimitiveCount(GL_TRIANGLE_STRIP, 4));
+    glDisableVertexAttribArray(m_blitPositionSlot);
+    
+    glEnable(GL_DEPTH_TEST);
+    // presentRenderbuffer 要求颜色渲染缓冲区处于绑定状态。
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
 }
 
 //针对平滑旋转操作，Apple 通过 UIViewController 类提供了相应的底层实现方案，但这并非 OpenGL ES 所推荐的方法，其原因如下
@@ -218,48 +755,437 @@ void VCCRenderingEngine2::Initialize(int width, int height)
 
 void VCCRenderingEngine2::Render() const
 {
-    GLuint positionSlot = glGetAttribLocation(m_simpleProgram, "Position");
-    GLuint colorSlot = glGetAttribLocation(m_simpleProgram, "SourceColor");
+    VCC_TRACE_SCOPE("Render");
+    if (UseDynamicResolution) {
+        // 仅清除并绘制离屏纹理中按比例缩小的区域。
+        glBindFramebuffer(GL_FRAMEBUFFER, m_sceneFramebuffer);
+        glViewport(0, 0, SceneWidth(), SceneHeight());
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, 0, SceneWidth(), SceneHeight());
+        m_frameStats.StateChange(2);
+        // 上一帧的 UpscaleScene() 在同一纹理单元上绑定了离屏纹理。
+        if (m_textured) {
+            glBindTexture(GL_TEXTURE_2D, m_texture);
+            m_frameStats.StateChange();
+        }
+    }
     
     glClearColor(0.5f, 0.5f, 0.5f, 1);
     // 针对深度缓冲区，增加了一个参数
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
-    glEnableVertexAttribArray(positionSlot);
-    glEnableVertexAttribArray(colorSlot);
-    mat4 rotation(m_animation.Current.ToMatrix());
+    m_jobs.Wait(m_animationJobs);
+    const mat4& rotation = m_rotation;
     mat4 translation = mat4::Translate(0, 0, -7);
+    // 开启 UseGpuQuaternions 时 Modelview 只包含反量化矩阵，旋转与平移由顶点着色器完成。
+    QuaternionTransform transform = ObjectTransform();
+    mat4 modelviewMatrix = UseGpuQuaternions ? m_dequantization : m_dequantization * rotation * translation;
+    
+    // 在加入渲染队列之前构建本帧的遮挡深度，载入的网格没有遮挡体代理，因此不会被剔除。
+    // 遮挡关系取决于视角，多摄像机模式下不做遮挡剔除，只按各摄像机的视锥剔除。
+    bool multiCamera = !m_cameras.empty();
+    if (UseOcclusionCulling && !multiCamera) {
+        VCC_TRACE_SCOPE("Occluders");
+        m_occlusionCuller.BeginFrame(m_projection);
+        if (!m_meshVertexBuffer && !UseStreamingScene)
+            m_occlusionCuller.AddOccluder(&m_coneOccluder[0], m_coneOccluder.size(), rotation * translation);
+        m_occlusionCuller.RasterizeOccluders(&m_jobs);
+    }
+    
+    // 流式场景的生产者在提交渲染队列期间即开始生成第一批数据块。
+    bool streaming = UseStreamingScene && !m_meshVertexBuffer;
+    if (streaming)
+        m_streamingScene.BeginPass();
+    
+    // 绘制命令先加入渲染队列，按排序键排序后再统一提交，而非以固定的顺序直接绘制。
+    m_renderQueue.Clear();
+    m_coneStream.BeginFrame();
+    if (m_meshVertexBuffer)
+        QueueLoadedMesh(modelviewMatrix, transform);
+    else if (!streaming) {
+        if (UseLevelOfDetail)
+            SelectConeLod(rotation * translation);
+        QueueConeAndDisk(modelviewMatrix, transform);
+    }
+    m_renderQueue.Sort();
+    // 多摄像机模式下同一个已排序的队列提交多次，节省的状态切换仍按排序一次计。
+    const RenderQueueStats& queueStats = m_renderQueue.Stats();
+    uint32_t stateChangesSaved = queueStats.UnsortedStateChanges - min(queueStats.UnsortedStateChanges, queueStats.StateChanges);
+    m_frameStats.StateChangesSaved(stateChangesSaved);
+    VCC_TRACE_COUNTER("Render queue items", m_renderQueue.Size());
+    VCC_TRACE_COUNTER("State changes saved by sorting", stateChangesSaved);
+    // 流式顶点始终为浮点坐标，不需要反量化矩阵。
+    if (multiCamera) {
+        RenderCameras(rotation * translation, streaming);
+    } else {
+        SubmitRenderQueue();
+        if (streaming)
+            DrawStreamingScene(rotation * translation);
+    }
+    
+    if (UseOcclusionCulling && !multiCamera) {
+        const OcclusionStats& occlusion = m_occlusionCuller.Stats();
+        m_frameStats.Cull(occlusion.Tested, occlusion.Occluded);
+        VCC_TRACE_COUNTER("Occluded objects", occlusion.Occluded);
+    }
+    
+    // 本帧写入的分区在此之后的栅栏完成前不再写入。
+    m_coneStream.EndFrame();
     
-    // Set the model-view matrix
-    GLint modelviewUniform = glGetUniformLocation(m_simpleProgram, "Modelview");
-    mat4 modelviewMatrix = rotation * translation;
-    glUniformMatrix4fv(modelviewUniform, 1, 0, modelviewMatrix.Pointer());
+    if (UseDynamicResolution)
+        UpscaleScene();
+    m_frameStats.EndFrame();
+}
+
+// 椎体（或载入的网格）本帧的旋转与平移。开启 UseGpuQuaternionBlend 时，动画期间的插值交给顶点着色器，m_animation.Current 则保持为起点。
+// 开启 UseFixedTimestep 时绘制的是上一步与当前步之间的状态：CPU 插值在两步的方位之间进行，着色器插值则改用两步之间的动画时间。
+QuaternionTransform VCCRenderingEngine2::ObjectTransform() const
+{
+    QuaternionTransform transform;
+    bool stepping = UseFixedTimestep && m_previousRotation != m_animation.Current;
+    bool blending = UseGpuQuaternionBlend && (m_animation.Current != m_animation.End || stepping);
+    float elapsed = m_animation.Elapsed;
+    if (UseFixedTimestep)
+        elapsed = max(0.0f, elapsed - (1 - m_clock.Alpha()) * FixedTimestepSeconds);
+    if (blending)
+        transform.Rotation = m_animation.Start;
+    else if (stepping)
+        transform.Rotation = m_previousRotation.Slerp(m_clock.Alpha(), m_animation.Current);
+    else
+        transform.Rotation = m_animation.Current;
+    transform.RotationEnd = m_animation.End;
+    transform.Blend = blending ? min(1.0f, elapsed / AnimationDuration) : 0;
+    transform.Translation = vec3(0, 0, -7);
+    return transform;
+}
 
+void VCCRenderingEngine2::QueueConeAndDisk(const mat4& modelview, const QuaternionTransform& transform) const
+{
+    DrawItem item;
+    item.Program = m_simpleProgram;
+    item.VertexBuffer = 0;
+    item.IndexBuffer = 0;
+    item.IndexType = 0;
+    item.First = 0;
+    item.Modelview = modelview;
+    item.UseQuaternion = UseGpuQuaternions;
+    item.Transform = transform;
+    item.Translucent = false;
+    item.Position.Enabled = true;
+    item.Color.Enabled = true;
+    item.Color.Type = GL_FLOAT;
+    item.Color.Components = 4;
+    item.Color.Normalized = false;
+    item.TexCoord.Enabled = m_textured;
+    item.TexCoord.Type = GL_FLOAT;
+    item.TexCoord.Components = 2;
+    item.TexCoord.Normalized = false;
+    
+    // 量化后的位置以规格化的 GL_SHORT 提交，反量化已包含于 Modelview 矩阵中。
+    int level = m_coneLodLevel;
+    bool quantized = !m_quantizedCone[level].empty();
+    item.Stride = quantized ? sizeof(QuantizedVertex) : sizeof(Vertex);
+    item.Position.Type = quantized ? GL_SHORT : GL_FLOAT;
+    item.Position.Components = 3;
+    item.Position.Normalized = quantized;
     
     // draw cone 相对 es1.1 版本也要发生变化
-    {
-        GLsizei stride = sizeof(Vertex);
-        const GLvoid* pCoords = &m_cone[0].Position.x;
-        const GLvoid* pColors = &m_cone[0].Color.x;
-        glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
-        glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, m_cone.size());//该函数调用即可令 OpenGL 从定义于 gl*Pointer 中的指针获取数据，同时三角形数据将渲染至目标表面上。
-    }
+    // 各 LOD 级别是不同的顶点源。
+    item.VertexSource = VertexSourceCone | level << 8;
+    item.Position.Pointer = quantized ? (const void*) m_quantizedCone[level][0].Position : &m_cone[level][0].Position.x;
+    item.Color.Pointer = quantized ? &m_quantizedCone[level][0].Color.x : &m_cone[level][0].Color.x;
+    item.TexCoord.Pointer = quantized ? &m_quantizedCone[level][0].TexCoord.x : &m_cone[level][0].TexCoord.x;
+    item.Mode = GL_TRIANGLE_STRIP;
+    item.Count = quantized ? m_quantizedCone[level].size() : m_cone[level].size();
+    item.BoundsMin = m_coneBoundsMin;
+    item.BoundsMax = m_coneBoundsMax;
+    if (m_coneStream.Attached() && !quantized)
+        MorphCone(level, item);
+    PushDrawItem(item);
+    
+    // 底盘的顶点数据位于客户端数组中。
+    item.VertexBuffer = 0;
+    
     // draw disk
-    {
-        GLsizei stride = sizeof(Vertex);
-        const GLvoid* pCoords = &m_disk[0].Position.x;
-        const GLvoid* pColors = &m_disk[0].Color.x;
-        glVertexAttribPointer(positionSlot, 3, GL_FLOAT, GL_FALSE, stride, pCoords);
-        glVertexAttribPointer(colorSlot, 4, GL_FLOAT, GL_FALSE, stride, pColors);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, m_disk.size());
+    item.VertexSource = VertexSourceDisk | level << 8;
+    item.Position.Pointer = quantized ? (const void*) m_quantizedDisk[level][0].Position : &m_disk[level][0].Position.x;
+    item.Color.Pointer = quantized ? &m_quantizedDisk[level][0].Color.x : &m_disk[level][0].Color.x;
+    item.TexCoord.Pointer = quantized ? &m_quantizedDisk[level][0].TexCoord.x : &m_disk[level][0].TexCoord.x;
+    item.Mode = GL_TRIANGLE_FAN;
+    item.Count = quantized ? m_quantizedDisk[level].size() : m_disk[level].size();
+    item.BoundsMin = m_diskBoundsMin;
+    item.BoundsMax = m_diskBoundsMax;
+    PushDrawItem(item);
+}
+
+// 将本帧形变后的椎体写入流式顶点缓冲区的当前分区，item 改为从缓冲区中的偏移量读取顶点；分区已满时仍以静态顶点绘制。
+void VCCRenderingEngine2::MorphCone(int level, DrawItem& item) const
+{
+    const vector<Vertex>& cone = m_cone[level];
+    size_t bytes = cone.size() * sizeof(Vertex);
+    size_t offset;
+    Vertex* vertices = (Vertex*) m_coneStream.Map(bytes, offset);
+    if (!vertices)
+        return;
+    MorphConeVertices(&cone[0], cone.size(), MorphAmplitude, m_morphPhase, vertices);
+    m_coneStream.Unmap();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_frameStats.Buffer(bytes);
+    
+    item.VertexSource = VertexSourceMorphedCone | level << 8;
+    item.VertexBuffer = m_morphVertexBuffer;
+    item.Position.Pointer = (const GLvoid*) (offset + offsetof(Vertex, Position));
+    item.Color.Pointer = (const GLvoid*) (offset + offsetof(Vertex, Color));
+    item.TexCoord.Pointer = (const GLvoid*) (offset + offsetof(Vertex, TexCoord));
+    item.BoundsMin.y -= MorphAmplitude;
+    item.BoundsMax.y += MorphAmplitude;
+}
+
+// 按包围球的投影半径选择本帧椎体与底盘的 LOD 级别，modelview 不包含反量化矩阵。
+// 多摄像机模式下所有摄像机共用同一级别，按投影半径最大（所需细节最多）的摄像机选择。
+void VCCRenderingEngine2::SelectConeLod(const mat4& modelview) const
+{
+    float radius = 0;
+    if (m_cameras.empty())
+        radius = ProjectedRadius(m_coneSphereCenter, m_coneSphereRadius, modelview, m_projection, m_height);
+    for (size_t i = 0; i < m_cameras.size(); ++i) {
+        const Camera& camera = m_cameras[i];
+        int height = camera.Framebuffer ? camera.TargetHeight : m_height;
+        int viewportHeight = ViewportInTarget(camera, 1, height).Height;
+        radius = max(radius, ProjectedRadius(m_coneSphereCenter, m_coneSphereRadius, modelview * camera.View,
+                                             camera.Projection, viewportHeight));
+    }
+    int level = m_lodSelector.Select(radius, m_coneLodLevel);
+    
+    uint32_t fullVertices = (ConeSlices + 1) * 2 + ConeSlices + 2;
+    uint32_t vertices = (LodSlices[level] + 1) * 2 + LodSlices[level] + 2;
+    m_frameStats.Lod(level != m_coneLodLevel, fullVertices - vertices);
+    m_coneLodLevel = level;
+    VCC_TRACE_COUNTER("Cone LOD level", level);
+    VCC_TRACE_COUNTER("LOD vertices saved", fullVertices - vertices);
+}
+
+// 被遮挡的物体不会进入渲染队列。
+void VCCRenderingEngine2::PushDrawItem(const DrawItem& item) const
+{
+    if (UseOcclusionCulling && m_cameras.empty()) {
+        mat4 modelview = item.UseQuaternion ? item.Modelview * item.Transform.ToMatrix() : item.Modelview;
+        if (!m_occlusionCuller.IsVisible(item.BoundsMin, item.BoundsMax, modelview))
+            return;
+    }
+    m_renderQueue.Push(item);
+}
+
+// 依次提交排序后的绘制命令，仅在着色器程序、顶点源或 Modelview 矩阵发生变化时才更新相应的状态。
+// frustum 不为 0 时跳过包围球（m_itemSpheres）位于其外的绘制命令，返回跳过的数目。
+size_t VCCRenderingEngine2::SubmitRenderQueue(const CameraFrustum* frustum) const
+{
+    VCC_TRACE_SCOPE("SubmitRenderQueue");
+    GLuint currentProgram = 0;
+    uint32_t currentSource = 0;
+    const mat4* currentModelview = 0;
+    const QuaternionTransform* currentTransform = 0;
+    GLuint currentIndexBuffer = 0;
+    
+    size_t culled = 0;
+    
+    glEnableVertexAttribArray(m_positionSlot);
+    for (size_t i = 0; i < m_renderQueue.Size(); ++i) {
+        const DrawItem& item = m_renderQueue[i];
+        if (frustum) {
+            const vec4& sphere = m_itemSpheres[i];
+            if (!frustum->Intersects(vec3(sphere.x, sphere.y, sphere.z), sphere.w)) {
+                culled++;
+                continue;
+            }
+        }
         
+        if (item.Program != currentProgram) {
+            glUseProgram(item.Program);
+            m_frameStats.StateChange();
+            currentProgram = item.Program;
+            currentModelview = 0;
+            currentTransform = 0;
+        }
+        
+        if (item.VertexSource != currentSource) {
+            glBindBuffer(GL_ARRAY_BUFFER, item.VertexBuffer);
+            glVertexAttribPointer(m_positionSlot, item.Position.Components, item.Position.Type,
+                                  item.Position.Normalized, item.Stride, item.Position.Pointer);
+            // 缺少颜色属性的网格统一使用白色。
+            if (item.Color.Enabled) {
+                glEnableVertexAttribArray(m_colorSlot);
+                glVertexAttribPointer(m_colorSlot, item.Color.Components, item.Color.Type,
+                                      item.Color.Normalized, item.Stride, item.Color.Pointer);
+            } else {
+                glDisableVertexAttribArray(m_colorSlot);
+                glVertexAttrib4f(m_colorSlot, 1, 1, 1, 1);
+            }
+            if (m_textured && item.TexCoord.Enabled) {
+                glEnableVertexAttribArray(m_texCoordSlot);
+                glVertexAttribPointer(m_texCoordSlot, item.TexCoord.Components, item.TexCoord.Type,
+                                      item.TexCoord.Normalized, item.Stride, item.TexCoord.Pointer);
+            } else if (m_textured) {
+                glDisableVertexAttribArray(m_texCoordSlot);
+                glVertexAttrib4f(m_texCoordSlot, m_whiteTexCoord.x, m_whiteTexCoord.y, 0, 1);
+            }
+            m_frameStats.StateChange();
+            currentSource = item.VertexSource;
+        }
+        
+        // Set the model-view matrix
+        if (!currentModelview || memcmp(currentModelview, &item.Modelview, sizeof(mat4)) != 0) {
+            glUniformMatrix4fv(m_modelviewUniform, 1, 0, item.Modelview.Pointer());
+            m_frameStats.Uniform(sizeof(mat4));
+            currentModelview = &item.Modelview;
+        }
+        
+        // 同一物体的各绘制区间共享同一变换，只上传一次；不插值时着色器不读取 RotationEnd。
+        if (item.UseQuaternion && (!currentTransform || memcmp(currentTransform, &item.Transform, sizeof(QuaternionTransform)) != 0)) {
+            glUniform4fv(m_transformUniform, UseGpuQuaternionBlend ? 3 : 2, &item.Transform.Rotation.x);
+            m_frameStats.Uniform((UseGpuQuaternionBlend ? 3 : 2) * 4 * sizeof(GLfloat));
+            currentTransform = &item.Transform;
+        }
+        
+        if (item.IndexBuffer) {
+            if (item.IndexBuffer != currentIndexBuffer) {
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, item.IndexBuffer);
+                m_frameStats.StateChange();
+                currentIndexBuffer = item.IndexBuffer;
+            }
+            size_t indexSize = item.IndexType == GL_UNSIGNED_INT ? 4 : 2;
+            glDrawElements(item.Mode, item.Count, item.IndexType, (const GLvoid*) (item.First * indexSize));
+        } else {
+            glDrawArrays(item.Mode, item.First, item.Count);//该函数调用即可令 OpenGL 从定义于 gl*Pointer 中的指针获取数据，同时三角形数据将渲染至目标表面上。
+        }
+        m_frameStats.Draw(item.Count, PrimitiveCount(item.Mode, item.Count));
     }
     
-    glDisableVertexAttribArray(positionSlot);
-    glDisableVertexAttribArray(colorSlot);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray(m_positionSlot);
+    glDisableVertexAttribArray(m_colorSlot);
+    if (m_textured)
+        glDisableVertexAttribArray(m_texCoordSlot);
     //关闭两个顶点属性。在执行绘制命令时，需要开启相关的顶点属性，但当后续绘制命令采用完全不同的垫垫属性集时，保留原有的属性并非上次。
+    return culled;
+}
 
+// 以各摄像机依次绘制同一个已排序的渲染队列：每个摄像机只切换渲染目标、视口与投影，并跳过其视锥之外的绘制命令。
+// 流式场景的每个数据块只上传一次，随即在各摄像机的视口中绘制。
+void VCCRenderingEngine2::RenderCameras(const mat4& sceneModelview, bool streaming) const
+{
+    VCC_TRACE_SCOPE("RenderCameras");
+    m_itemSpheres.resize(m_renderQueue.Size());
+    for (size_t i = 0; i < m_renderQueue.Size(); ++i) {
+        const DrawItem& item = m_renderQueue[i];
+        mat4 modelview = item.UseQuaternion ? item.Modelview * item.Transform.ToMatrix() : item.Modelview;
+        vec3 center;
+        float radius;
+        TransformBoundingSphere(item.BoundsMin, item.BoundsMax, modelview, center, radius);
+        m_itemSpheres[i] = vec4(center.x, center.y, center.z, radius);
+    }
+    
+    GLuint engineTarget = UseDynamicResolution ? m_sceneFramebuffer : m_framebuffer;
+    GLuint boundFramebuffer = engineTarget;
+    size_t culled = 0;
+    glEnable(GL_SCISSOR_TEST);
+    for (size_t c = 0; c < m_cameras.size(); ++c) {
+        BindCamera(c, boundFramebuffer);
+        // 裁剪矩形限定清除的范围：画中画等重叠的视口不会继承下层视口的深度，调用者的渲染目标也由此清除。
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        culled += SubmitRenderQueue(&m_cameraFrusta[c]);
+    }
+    VCC_TRACE_COUNTER("Camera draws culled", culled);
+    if (streaming)
+        DrawStreamingScene(sceneModelview);
+    
+    if (boundFramebuffer != engineTarget)
+        glBindFramebuffer(GL_FRAMEBUFFER, engineTarget);
+    // 动态分辨率模式下 UpscaleScene() 随后会关闭裁剪测试。
+    if (!UseDynamicResolution)
+        glDisable(GL_SCISSOR_TEST);
+}
+
+// 切换至第 index 个摄像机的渲染目标、视口与投影；投影是 m_simpleProgram 的 uniform，因此同时启用该程序。
+void VCCRenderingEngine2::BindCamera(size_t index, GLuint& boundFramebuffer) const
+{
+    const Camera& camera = m_cameras[index];
+    GLuint target = camera.Framebuffer;
+    int width = camera.TargetWidth, height = camera.TargetHeight;
+    if (!target) {
+        target = UseDynamicResolution ? (GLuint) m_sceneFramebuffer : (GLuint) m_framebuffer;
+        width = UseDynamicResolution ? SceneWidth() : m_width;
+        height = UseDynamicResolution ? SceneHeight() : m_height;
+    }
+    if (target != boundFramebuffer) {
+        glBindFramebuffer(GL_FRAMEBUFFER, target);
+        m_frameStats.StateChange();
+        boundFramebuffer = target;
+    }
+    CameraViewport viewport = ViewportInTarget(camera, width, height);
+    glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+    glScissor(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+    glUseProgram(m_simpleProgram);
+    glUniformMatrix4fv(m_projectionUniform, 1, 0, m_cameraViewProjections[index].Pointer());
+    m_frameStats.StateChange(2);
+    m_frameStats.Uniform(sizeof(mat4));
+}
+
+// 逐块上传并绘制流式场景；GPU 处理当前数据块的同时，生产者线程已在生成后续的数据块。
+void VCCRenderingEngine2::DrawStreamingScene(const mat4& modelview) const
+{
+    VCC_TRACE_SCOPE("DrawStreamingScene");
+    glUseProgram(m_simpleProgram);
+    glUniformMatrix4fv(m_modelviewUniform, 1, 0, modelview.Pointer());
+    m_frameStats.Uniform(sizeof(mat4));
+    // 流式场景以矩阵给出完整的变换，四元数部分设为恒等变换。
+    if (UseGpuQuaternions) {
+        static const GLfloat identity[] = { 0, 0, 0, 1, 0, 0, 0, 0 };
+        glUniform4fv(m_transformUniform, 2, identity);
+        m_frameStats.Uniform(sizeof(identity));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_streamVertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_streamIndexBuffer);
+    glEnableVertexAttribArray(m_positionSlot);
+    glEnableVertexAttribArray(m_colorSlot);
+    glVertexAttribPointer(m_positionSlot, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) offsetof(Vertex, Position));
+    glVertexAttribPointer(m_colorSlot, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*) offsetof(Vertex, Color));
+    m_frameStats.StateChange(3);
+    // 流式实例的纹理坐标没有换算至图集中，以白色区域绘制。
+    if (m_textured) {
+        glVertexAttrib4f(m_texCoordSlot, m_whiteTexCoord.x, m_whiteTexCoord.y, 0, 1);
+        m_frameStats.StateChange();
+    }
+    
+    GLuint boundFramebuffer = UseDynamicResolution ? m_sceneFramebuffer : m_framebuffer;
+    while (const SceneChunk* chunk = m_streamingScene.NextChunk()) {
+        // glBufferData 返回时数据已复制完毕，缓冲区随即归还给生产者。
+        uint32_t instances = chunk->InstanceCount;
+        size_t bytes = instances * m_streamingScene.VerticesPerInstance() * sizeof(Vertex);
+        glBufferData(GL_ARRAY_BUFFER, bytes, &chunk->Vertices[0], GL_STREAM_DRAW);
+        m_streamVertexBuffer.SetBytes(bytes);
+        m_frameStats.Buffer(bytes);
+        m_streamingScene.ReleaseChunk(chunk);
+        GLsizei indices = instances * m_streamingScene.IndicesPerInstance();
+        if (m_cameras.empty()) {
+            glDrawElements(GL_TRIANGLES, indices, GL_UNSIGNED_SHORT, 0);
+            m_frameStats.Draw(indices, PrimitiveCount(GL_TRIANGLES, indices));
+        }
+        // 数据块没有包围盒，在每个摄像机中都绘制。
+        for (size_t c = 0; c < m_cameras.size(); ++c) {
+            BindCamera(c, boundFramebuffer);
+            glDrawElements(GL_TRIANGLES, indices, GL_UNSIGNED_SHORT, 0);
+            m_frameStats.Draw(indices, PrimitiveCount(GL_TRIANGLES, indices));
+        }
+    }
+    if (boundFramebuffer != (UseDynamicResolution ? m_sceneFramebuffer : m_framebuffer))
+        glBindFramebuffer(GL_FRAMEBUFFER, UseDynamicResolution ? m_sceneFramebuffer : m_framebuffer);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    glDisableVertexAttribArray(m_positionSlot);
+    glDisableVertexAttribArray(m_colorSlot);
 }
 
 //程序考察箭头的旋转方向问题，即顺时针还是逆时针旋转。此处，仅检测期望值是否大于当前角度值并不充分：若用户将设备方位从 270 改变至 0，则该角度值应增至 360。
@@ -270,18 +1196,77 @@ void VCCRenderingEngine2::Render() const
 
 // 为了实现平滑的旋转操作，UpdateAnimation() 方法将在旋转四元数的基础上调用 Slerp() 方法。
 void VCCRenderingEngine2::UpdateAnimation(float timeStep)
+{
+    VCC_TRACE_SCOPE("UpdateAnimation");
+    // 显示链接的时间间隔即为上一帧的帧时间。
+    if (UseDynamicResolution)
+        m_resolution.Update(timeStep);
+    
+    // 动画状态仅由动画任务修改；提交新任务前须等待上一次提交的任务完成。
+    m_jobs.Wait(m_animationJobs);
+    if (UseMorphingCone)
+        m_morphPhase = fmod(m_morphPhase + MorphRadiansPerSecond * timeStep, TwoPi);
+    if (!UseFixedTimestep) {
+        if (m_animation.Current == m_animation.End)
+            return;
+        m_jobs.Run([this, timeStep]() {
+            VCC_TRACE_SCOPE("Animation");
+            StepAnimation(timeStep);
+            if (UseRotationMatrix)
+                m_rotation = mat4(ObjectTransform().BlendedRotation().ToMatrix());
+        }, &m_animationJobs);
+        return;
+    }
+    // 时钟在静止时同样推进，动画开始时累加器中只有不足一步的时间；Alpha() 在下一次调用之前保持不变，供 Render() 读取。
+    int steps = m_clock.Advance(timeStep);
+    // 最后一步到达终点之后，仍要再走一步才不再需要插值。
+    if (m_animation.Current == m_animation.End && m_previousRotation == m_animation.Current)
+        return;
+    m_jobs.Run([this, steps]() {
+        VCC_TRACE_SCOPE("Animation");
+        for (int i = 0; i < steps; ++i) {
+            m_previousRotation = m_animation.Current;
+            StepAnimation(FixedTimestepSeconds);
+        }
+        if (UseRotationMatrix)
+            m_rotation = mat4(ObjectTransform().BlendedRotation().ToMatrix());
+    }, &m_animationJobs);
+}
+
+// 将动画推进 timeStep 秒，只在动画任务中调用。
+void VCCRenderingEngine2::StepAnimation(float timeStep)
 {
     if (m_animation.Current == m_animation.End)
         return;
     m_animation.Elapsed += timeStep;
     if (m_animation.Elapsed >= AnimationDuration) {
         m_animation.Current = m_animation.End;
-    } else {
+    } else if (!UseGpuQuaternionBlend) {
         float mu = m_animation.Elapsed / AnimationDuration;
         m_animation.Current = m_animation.Start.Slerp(mu, m_animation.End);
     }
 }
 
+// 投影矩阵保持不变，场景随视口一同拉伸，与 Initialize() 的做法一致。动态分辨率模式下离屏纹理按新的尺寸重新分配，
+// 深度缓冲区仍附着于离屏帧缓冲区，重新分配存储不影响附着关系。
+void VCCRenderingEngine2::Resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, m_width, m_height);
+    m_depthRenderbuffer.SetBytes(size_t(m_width) * m_height * 2);
+    m_colorRenderbuffer.SetBytes(size_t(m_width) * m_height * 4);
+    if (UseDynamicResolution) {
+        glBindTexture(GL_TEXTURE_2D, m_sceneTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        m_sceneTexture.SetBytes(size_t(m_width) * m_height * 4);
+    } else {
+        glViewport(0, 0, m_width, m_height);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorRenderbuffer);
+}
+
 // OnRotate() 方法将启动一个新的动画序列
 void VCCRenderingEngine2::OnRotate(VCCDeviceOrientation newOrientation)
 {
@@ -314,12 +1299,207 @@ void VCCRenderingEngine2::OnRotate(VCCDeviceOrientation newOrientation)
             break;
     }
     
+    m_jobs.Wait(m_animationJobs);
     m_animation.Elapsed = 0;
     m_animation.Start = m_animation.Current = m_animation.End;
+    m_previousRotation = m_animation.Current;
+    m_rotation = mat4(m_animation.Current.ToMatrix());
     m_animation.End = Quaternion::CreateFromVectors(vec3(0, 1, 0), direction);
     
 }
 
+static GLenum MeshComponentToGL(uint32_t type)
+{
+    switch (type) {
+        case MeshComponentShort:
+            return GL_SHORT;
+        case MeshComponentUnsignedByte:
+            return GL_UNSIGNED_BYTE;
+        default:
+            return GL_FLOAT;
+    }
+}
+
+static GLenum MeshTopologyToGL(uint32_t topology)
+{
+    switch (topology) {
+        case MeshTopologyTriangleStrip:
+            return GL_TRIANGLE_STRIP;
+        case MeshTopologyTriangleFan:
+            return GL_TRIANGLE_FAN;
+        default:
+            return GL_TRIANGLES;
+    }
+}
+
+// LoadMesh() 通过 mmap 映射网格文件，并将映射指针直接交给 glBufferData，整个载入过程不存在中间拷贝。
+bool VCCRenderingEngine2::LoadMesh(const char* path)
+{
+    MappedMesh mesh;
+    if (!mesh.Open(path))
+        return false;
+    
+    const MeshFileHeader& header = mesh.Header();
+    if (!mesh.FindAttribute(MeshAttributePosition)) {
+        std::cout << "Mesh file " << path << " has no position attribute" << std::endl;
+        return false;
+    }
+    
+    // 新网格的缓冲区取代原有网格的缓冲区。
+    size_t vertexBytes = size_t(header.VertexStride) * header.VertexCount;
+    size_t indexBytes = size_t(header.IndexSize) * header.IndexCount;
+    if (!m_glResources.Fits(vertexBytes + indexBytes, m_meshVertexBuffer.Bytes() + m_meshIndexBuffer.Bytes())) {
+        std::cout << "Mesh file " << path << " (" << (vertexBytes + indexBytes) / 1024 << " KB) exceeds the GL memory budget" << std::endl;
+        m_glResources.Print();
+        return false;
+    }
+    
+    if (!m_meshVertexBuffer)
+        m_meshVertexBuffer.Create(m_glResources, "mesh vertex buffer");
+    glBindBuffer(GL_ARRAY_BUFFER, m_meshVertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertexBytes), mesh.Vertices(), GL_STATIC_DRAW);
+    m_frameStats.Buffer(vertexBytes);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_meshVertexBuffer.SetBytes(vertexBytes);
+    
+    if (header.IndexSize) {
+        if (!m_meshIndexBuffer)
+            m_meshIndexBuffer.Create(m_glResources, "mesh index buffer");
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_meshIndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indexBytes), mesh.Indices(), GL_STATIC_DRAW);
+        m_frameStats.Buffer(indexBytes);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        m_meshIndexBuffer.SetBytes(indexBytes);
+    } else {
+        m_meshIndexBuffer.Reset();
+    }
+    
+    m_meshHeader = header;
+    m_dequantization = MeshFileDequantizationMatrix(header, *mesh.FindAttribute(MeshAttributePosition));
+    m_meshAttributes.assign(mesh.Attributes(), mesh.Attributes() + header.AttributeCount);
+    m_meshSubmeshes.assign(mesh.Submeshes(), mesh.Submeshes() + header.SubmeshCount);
+    // 包围盒以模型坐标给出，需换算至顶点坐标所在的坐标系（位置未量化时 Scale 为 1，Offset 为 0）。
+    vec3 scale(header.PositionScale[0], header.PositionScale[1], header.PositionScale[2]);
+    vec3 offset(header.PositionOffset[0], header.PositionOffset[1], header.PositionOffset[2]);
+    m_meshBoundsMin = ToVertexSpace(vec3(header.BoundsMin[0], header.BoundsMin[1], header.BoundsMin[2]), scale, offset);
+    m_meshBoundsMax = ToVertexSpace(vec3(header.BoundsMax[0], header.BoundsMax[1], header.BoundsMax[2]), scale, offset);
+    return true;
+}
+
+void VCCRenderingEngine2::QueueLoadedMesh(const mat4& modelview, const QuaternionTransform& transform) const
+{
+    DrawItem item;
+    item.Program = m_simpleProgram;
+    item.VertexSource = VertexSourceMesh;
+    item.VertexBuffer = m_meshVertexBuffer;
+    item.Stride = m_meshHeader.VertexStride;
+    item.Position.Enabled = false;
+    item.Color.Enabled = false;
+    // 载入的网格没有对应的纹理，即使带有纹理坐标也以图集中的白色区域绘制。
+    item.TexCoord.Enabled = false;
+    for (size_t i = 0; i < m_meshAttributes.size(); ++i) {
+        const MeshFileAttribute& attribute = m_meshAttributes[i];
+        DrawAttribute* target;
+        if (attribute.Semantic == MeshAttributePosition)
+            target = &item.Position;
+        else if (attribute.Semantic == MeshAttributeColor)
+            target = &item.Color;
+        else
+            continue;
+        target->Enabled = true;
+        target->Type = MeshComponentToGL(attribute.Type);
+        target->Components = attribute.Components;
+        target->Normalized = attribute.Normalized != 0;
+        target->Pointer = (const GLvoid*) (size_t) attribute.Offset;
+    }
+    item.IndexBuffer = m_meshHeader.IndexSize ? m_meshIndexBuffer : 0;
+    item.IndexType = m_meshHeader.IndexSize == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+    item.Modelview = modelview;
+    item.UseQuaternion = UseGpuQuaternions;
+    item.Transform = transform;
+    item.BoundsMin = m_meshBoundsMin;
+    item.BoundsMax = m_meshBoundsMax;
+    item.Translucent = false;
+    
+    for (size_t i = 0; i < m_meshSubmeshes.size(); ++i) {
+        const MeshFileSubmesh& submesh = m_meshSubmeshes[i];
+        item.Mode = MeshTopologyToGL(submesh.Topology);
+        item.First = submesh.First;
+        item.Count = submesh.Count;
+        PushDrawItem(item);
+    }
+}
+
+// 离开多摄像机模式时恢复 Finalize() 设置的视口与投影。
+void VCCRenderingEngine2::SetCameras(const Camera* cameras, size_t count)
+{
+    bool wasMultiCamera = !m_cameras.empty();
+    m_cameras.assign(cameras, cameras + count);
+    m_cameraViewProjections.clear();
+    m_cameraFrusta.clear();
+    for (size_t i = 0; i < count; ++i) {
+        m_cameraViewProjections.push_back(cameras[i].View * cameras[i].Projection);
+        m_cameraFrusta.push_back(CameraFrustum(m_cameraViewProjections.back()));
+    }
+    if (count || !wasMultiCamera)
+        return;
+    glUseProgram(m_simpleProgram);
+    glUniformMatrix4fv(m_projectionUniform, 1, 0, m_projection.Pointer());
+    m_frameStats.StateChange();
+    m_frameStats.Uniform(sizeof(mat4));
+    if (!UseDynamicResolution) {
+        glViewport(0, 0, m_width, m_height);
+        m_frameStats.StateChange();
+    }
+}
+
+// 以本帧绘制时的变换（包括着色器中的插值）求射线；流式场景的实例不在 CPU 上保留，与载入的网格一样不参与拾取。
+bool VCCRenderingEngine2::Pick(float x, float y, int& object, float& distance) const
+{
+    if (m_meshVertexBuffer || UseStreamingScene)
+        return false;
+    m_jobs.Wait(m_animationJobs);
+    PickRay ray;
+    if (m_cameras.empty()) {
+        ray = UnprojectScreenPoint(x, y, m_width, m_height, ObjectTransform().ToMatrix(), m_projection);
+    } else {
+        CameraViewport viewport;
+        int c = CameraAtPoint(m_cameras, m_width, m_height, x, y, viewport);
+        if (c < 0)
+            return false;
+        const Camera& camera = m_cameras[c];
+        ray = UnprojectScreenPoint(x - viewport.X, y - (m_height - viewport.Y - viewport.Height), viewport.Width, viewport.Height,
+                                   ObjectTransform().ToMatrix() * camera.View, camera.Projection);
+    }
+    PickHit hit = m_picker.Pick(ray);
+    if (hit.Instance < 0)
+        return false;
+    object = hit.Instance;
+    distance = hit.Distance;
+    return true;
+}
+
+// 网格占用按各容器的容量计算；载入网格的数据上传后即解除映射，不再占用 CPU 内存。
+VCCFrameStats VCCRenderingEngine2::GetFrameStats() const
+{
+    VCCFrameStats stats = m_frameStats.Stats();
+    uint64_t meshBytes = m_coneOccluder.capacity() * sizeof(vec3);
+    for (int level = 0; level < LodLevelCount; ++level) {
+        meshBytes += (m_cone[level].capacity() + m_disk[level].capacity()) * sizeof(Vertex);
+        meshBytes += (m_quantizedCone[level].capacity() + m_quantizedDisk[level].capacity()) * sizeof(QuantizedVertex);
+    }
+    if (UseStreamingScene)
+        meshBytes += m_streamingScene.PoolBytes() + m_streamingScene.Indices().capacity() * sizeof(uint16_t);
+    stats.MeshBytes = meshBytes;
+    stats.GLBytes = m_glResources.TotalBytes();
+    stats.Stream = m_coneStream.Stats();
+    if (UseStreamingScene)
+        stats.Scene = m_streamingScene.Stats();
+    stats.SnapshotBytes = m_restoredBytes;
+    stats.Initialization = m_initPhases;
+    return stats;
+}
+
 GLuint VCCRenderingEngine2::BuildShader(const char *source, GLenum shaderType) const{
     GLuint shaderHandle = glCreateShader(shaderType);
     glShaderSource(shaderHandle, 1, &source, 0);
@@ -341,6 +1521,7 @@ GLuint VCCRenderingEngine2::BuildShader(const char *source, GLenum shaderType) c
 GLuint VCCRenderingEngine2::BuildProgram(const char* vertexShaderSource,
                                       const char* fragmentShaderSource) const
 {
+    VCC_TRACE_SCOPE("BuildProgram");
     GLuint vertexShader = BuildShader(vertexShaderSource, GL_VERTEX_SHADER);
     GLuint fragmentShader = BuildShader(fragmentShaderSource, GL_FRAGMENT_SHADER);
     
@@ -358,5 +1539,155 @@ GLuint VCCRenderingEngine2::BuildProgram(const char* vertexShaderSource,
         exit(1);
     }
     
+    // 链接之后程序不再需要着色器对象；分离并删除后，其存储随程序一同释放。
+    glDetachShader(programHandle, vertexShader);
+    glDetachShader(programHandle, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
     return programHandle;
 }
+
+void VCCRenderingEngine2::SetSnapshotPath(const char* path)
+{
+    m_snapshotPath = path ? path : "";
+}
+
+// 凡是影响 Prepare() 计算结果的参数都需计入散列值，否则修改参数后仍会恢复出过时的快照。
+uint64_t VCCRenderingEngine2::SnapshotParameterHash() const
+{
+    SnapshotHasher hasher;
+    hasher.AddValue(m_width);
+    hasher.AddValue(m_height);
+    hasher.AddValue(sizeof(Vertex));
+    hasher.AddValue(sizeof(QuantizedVertex));
+    hasher.AddValue(sizeof(Engine2SnapshotState));
+    hasher.AddValue(ConeRadius);
+    hasher.AddValue(ConeHeight);
+    hasher.AddValue(LodSlices);
+    hasher.AddValue(OccluderSlices);
+    hasher.AddValue(UseQuantizedPositions);
+    hasher.AddValue(UseLevelOfDetail);
+    hasher.AddValue(UseOcclusionCulling);
+    hasher.AddValue(UseDynamicResolution);
+    hasher.AddValue(UseGpuQuaternions);
+    hasher.AddValue(m_textured);
+    hasher.AddValue(ConeTextureSize);
+    hasher.AddValue(AtlasPadding);
+    // 着色器变量的位置由着色器源码与驱动共同决定，驱动的标识另见 DriverHash()。
+    hasher.AddString(SimpleVertexShader);
+    hasher.AddString(QuaternionVertexShader);
+    hasher.AddString(SimpleFragmentShader);
+    hasher.AddString(BlitVertexShader);
+    hasher.AddString(BlitFragmentShader);
+    hasher.AddString(TexturedFragmentShader);
+    return hasher.Hash();
+}
+
+// 需要 GL 上下文，因而不计入参数散列值：Prepare() 可在没有 GL 上下文的后台线程上恢复网格，位置则由 Finalize() 校验。
+uint64_t VCCRenderingEngine2::DriverHash() const
+{
+    SnapshotHasher hasher;
+    hasher.AddString((const char*) glGetString(GL_RENDERER));
+    hasher.AddString((const char*) glGetString(GL_VERSION));
+    return hasher.Hash();
+}
+
+bool VCCRenderingEngine2::SaveSnapshot() const
+{
+    VCC_TRACE_SCOPE("SaveSnapshot");
+    if (m_snapshotPath.empty())
+        return false;
+    m_jobs.Wait(m_animationJobs);
+    
+    Engine2SnapshotState state;
+    state.Projection = m_projection;
+    state.Dequantization = m_coneDequantization;
+    state.ConeBoundsMin = m_coneBoundsMin;
+    state.ConeBoundsMax = m_coneBoundsMax;
+    state.DiskBoundsMin = m_diskBoundsMin;
+    state.DiskBoundsMax = m_diskBoundsMax;
+    state.ConeSphereCenter = m_coneSphereCenter;
+    state.ConeSphereRadius = m_coneSphereRadius;
+    state.AnimationState = m_animation;
+    state.Rotation = m_rotation;
+    state.PositionSlot = m_positionSlot;
+    state.ColorSlot = m_colorSlot;
+    state.ModelviewUniform = m_modelviewUniform;
+    state.ProjectionUniform = m_projectionUniform;
+    state.BlitPositionSlot = UseDynamicResolution ? m_blitPositionSlot : -1;
+    state.BlitTexCoordScaleUniform = UseDynamicResolution ? m_blitTexCoordScaleUniform : -1;
+    state.BlitTexCoordMaxUniform = UseDynamicResolution ? m_blitTexCoordMaxUniform : -1;
+    state.BlitSceneUniform = UseDynamicResolution ? m_blitSceneUniform : -1;
+    state.TransformUniform = m_transformUniform;
+    state.TexCoordSlot = m_textured ? (GLint) m_texCoordSlot : -1;
+    state.TextureUniform = m_textureUniform;
+    state.DriverHash = m_driverHash;
+    
+    // 未使用的 LOD 级别以及量化后被释放的浮点网格均写为空数据块。
+    EngineSnapshotWriter writer;
+    writer.AddValue(SnapshotState, state);
+    writer.AddVector(SnapshotOccluder, m_coneOccluder);
+    for (int level = 0; level < LodLevelCount; ++level) {
+        writer.AddVector(SnapshotCone + level, m_cone[level]);
+        writer.AddVector(SnapshotDisk + level, m_disk[level]);
+        writer.AddVector(SnapshotQuantizedCone + level, m_quantizedCone[level]);
+        writer.AddVector(SnapshotQuantizedDisk + level, m_quantizedDisk[level]);
+    }
+    return writer.Save(m_snapshotPath.c_str(), m_snapshotHash);
+}
+
+// 以一次 mmap 读入快照并复制各数据块，快照缺失、过时或不完整时返回 false 并保持引擎状态不变。
+bool VCCRenderingEngine2::RestoreSnapshot()
+{
+    VCC_TRACE_SCOPE("RestoreSnapshot");
+    EngineSnapshot snapshot;
+    if (!snapshot.Open(m_snapshotPath.c_str(), m_snapshotHash))
+        return false;
+    
+    Engine2SnapshotState state;
+    bool ok = snapshot.ReadValue(SnapshotState, state) && snapshot.ReadVector(SnapshotOccluder, m_coneOccluder);
+    for (int level = 0; ok && level < LodLevelCount; ++level) {
+        ok = snapshot.ReadVector(SnapshotCone + level, m_cone[level])
+          && snapshot.ReadVector(SnapshotDisk + level, m_disk[level])
+          && snapshot.ReadVector(SnapshotQuantizedCone + level, m_quantizedCone[level])
+          && snapshot.ReadVector(SnapshotQuantizedDisk + level, m_quantizedDisk[level]);
+    }
+    bool hasCone = UseQuantizedPositions ? !m_quantizedCone[0].empty() : !m_cone[0].empty();
+    if (!ok || !hasCone) {
+        std::cout << "Snapshot " << m_snapshotPath << " is incomplete" << std::endl;
+        m_coneOccluder.clear();
+        for (int level = 0; level < LodLevelCount; ++level) {
+            m_cone[level].clear();
+            m_disk[level].clear();
+            m_quantizedCone[level].clear();
+            m_quantizedDisk[level].clear();
+        }
+        return false;
+    }
+    
+    m_projection = state.Projection;
+    m_coneDequantization = state.Dequantization;
+    m_coneBoundsMin = state.ConeBoundsMin;
+    m_coneBoundsMax = state.ConeBoundsMax;
+    m_diskBoundsMin = state.DiskBoundsMin;
+    m_diskBoundsMax = state.DiskBoundsMax;
+    m_coneSphereCenter = state.ConeSphereCenter;
+    m_coneSphereRadius = state.ConeSphereRadius;
+    m_animation = state.AnimationState;
+    m_rotation = state.Rotation;
+    m_previousRotation = m_animation.Current;
+    m_positionSlot = state.PositionSlot;
+    m_colorSlot = state.ColorSlot;
+    m_modelviewUniform = state.ModelviewUniform;
+    m_projectionUniform = state.ProjectionUniform;
+    m_blitPositionSlot = state.BlitPositionSlot;
+    m_blitTexCoordScaleUniform = state.BlitTexCoordScaleUniform;
+    m_blitTexCoordMaxUniform = state.BlitTexCoordMaxUniform;
+    m_blitSceneUniform = state.BlitSceneUniform;
+    m_transformUniform = state.TransformUniform;
+    m_texCoordSlot = (GLuint) state.TexCoordSlot;
+    m_textureUniform = state.TextureUniform;
+    m_restoredDriverHash = state.DriverHash;
+    m_restoredBytes = snapshot.Size();
+    return true;
+}
@@ -1,13 +1,28 @@
 #pragma once
+#include "VectorExpression.hpp"
 #include <cmath>
 
 const float Pi = 4 * std::atan(1.0f);
 const float TwoPi = 2 * Pi;
 
+// 以分量类型 T 表示的 π。模板中的常量均须以 T 表示，不可写作 float 字面量，否则 double 实例化的精度受限于 float。
+template <typename T>
+inline T ScalarPi()
+{
+    return T(3.14159265358979323846);
+}
+
+// 分量类型无关的数学函数：float 与 double 使用 std 中的重载，其他分量类型（例如 Fixed.hpp 中的 Fixed16）
+// 在其所在的命名空间中提供同名函数，由实参相关查找找到。模板中的数学函数均须以此形式调用。
+#define VCC_SCALAR_MATH using std::sqrt; using std::sin; using std::cos; using std::acos
+
 template <typename T>
 struct Vector2 {
     Vector2() {}
     Vector2(T x, T y) : x(x), y(y) {}
+    // 不同分量类型之间的显式转换，例如以 double 计算后转换为 float 提交。
+    template <typename U>
+    explicit Vector2(const Vector2<U>& v) : x(T(v.x)), y(T(v.y)) {}
     T Dot(const Vector2& v) const
     {
         return x * v.x + y * v.y;
@@ -20,17 +35,17 @@ struct Vector2 {
     {
         return Vector2(x - v.x, y - v.y);
     }
-    Vector2 operator/(float s) const
+    Vector2 operator/(T s) const
     {
         return Vector2(x / s, y / s);
     }
-    Vector2 operator*(float s) const
+    Vector2 operator*(T s) const
     {
         return Vector2(x * s, y * s);
     }
     void Normalize()
     {
-        float s = 1.0f / Length();
+        T s = 1 / Length();
         x *= s;
         y *= s;
     }
@@ -46,17 +61,18 @@ struct Vector2 {
     }
     T Length() const
     {
+        VCC_SCALAR_MATH;
         return sqrt(LengthSquared());
     }
     operator Vector2<float>() const
     {
-        return Vector2<float>(x, y);
+        return Vector2<float>(float(x), float(y));
     }
     bool operator==(const Vector2& v) const
     {
         return x == v.x && y == v.y;
     }
-    Vector2 Lerp(float t, const Vector2& v) const
+    Vector2 Lerp(T t, const Vector2& v) const
     {
         return Vector2(x * (1 - t) + v.x * t,
                        y * (1 - t) + v.y * t);
@@ -72,13 +88,39 @@ struct Vector2 {
     T y;
 };
 
+// Vector3 与 Vector4 的 +、-、* 与 / 返回表达式，参见 VectorExpression.hpp。
+// 以表达式构造时逐分量转换：分量类型相同的表达式可以隐式求值，不同分量类型之间的转换（例如由 dvec3 构造 vec3）须显式写出。
 template <typename T>
-struct Vector3 {
+struct Vector3 : VectorExpression<Vector3<T> > {
+    typedef Vector3 Value;
+    typedef T Scalar;
+    typedef const Vector3& Operand;
     Vector3() {}
     Vector3(T x, T y, T z) : x(x), y(y), z(z) {}
+    template <typename E, typename VectorSameScalar<E, T>::Type = 0>
+    VCC_VECTOR_INLINE Vector3(const VectorExpression<E>& e)
+    {
+        const E& v = e.Self();
+        x = T(v[0]);
+        y = T(v[1]);
+        z = T(v[2]);
+    }
+    template <typename E, typename VectorOtherScalar<E, T>::Type = 0>
+    VCC_VECTOR_INLINE explicit Vector3(const VectorExpression<E>& e)
+    {
+        const E& v = e.Self();
+        x = T(v[0]);
+        y = T(v[1]);
+        z = T(v[2]);
+    }
+    VCC_VECTOR_INLINE T operator[](int i) const
+    {
+        return (&x)[i];
+    }
     void Normalize()
     {
-        float s = 1.0f / std::sqrt(x * x + y * y + z * z);
+        VCC_SCALAR_MATH;
+        T s = 1 / sqrt(x * x + y * y + z * z);
         x *= s;
         y *= s;
         z *= s;
@@ -99,21 +141,21 @@ struct Vector3 {
     {
         return x * v.x + y * v.y + z * v.z;
     }
-    Vector3 operator+(const Vector3& v) const
-    {
-        return Vector3(x + v.x, y + v.y,  z + v.z);
-    }
-    void operator+=(const Vector3& v)
+    template <typename E>
+    VCC_VECTOR_INLINE void operator+=(const VectorExpression<E>& e)
     {
-        x += v.x;
-        y += v.y;
-        z += v.z;
+        const E& v = e.Self();
+        x += v[0];
+        y += v[1];
+        z += v[2];
     }
-    void operator-=(const Vector3& v)
+    template <typename E>
+    VCC_VECTOR_INLINE void operator-=(const VectorExpression<E>& e)
     {
-        x -= v.x;
-        y -= v.y;
-        z -= v.z;
+        const E& v = e.Self();
+        x -= v[0];
+        y -= v[1];
+        z -= v[2];
     }
     void operator/=(T s)
     {
@@ -121,27 +163,11 @@ struct Vector3 {
         y /= s;
         z /= s;
     }
-    Vector3 operator-(const Vector3& v) const
-    {
-        return Vector3(x - v.x, y - v.y,  z - v.z);
-    }
-    Vector3 operator-() const
-    {
-        return Vector3(-x, -y, -z);
-    }
-    Vector3 operator*(T s) const
-    {
-        return Vector3(x * s, y * s, z * s);
-    }
-    Vector3 operator/(T s) const
-    {
-        return Vector3(x / s, y / s, z / s);
-    }
     bool operator==(const Vector3& v) const
     {
         return x == v.x && y == v.y && z == v.z;
     }
-    Vector3 Lerp(float t, const Vector3& v) const
+    Vector3 Lerp(T t, const Vector3& v) const
     {
         return Vector3(x * (1 - t) + v.x * t,
                        y * (1 - t) + v.y * t,
@@ -164,14 +190,39 @@ struct Vector3 {
 };
 
 template <typename T>
-struct Vector4 {
+struct Vector4 : VectorExpression<Vector4<T> > {
+    typedef Vector4 Value;
+    typedef T Scalar;
+    typedef const Vector4& Operand;
     Vector4() {}
     Vector4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+    template <typename E, typename VectorSameScalar<E, T>::Type = 0>
+    VCC_VECTOR_INLINE Vector4(const VectorExpression<E>& e)
+    {
+        const E& v = e.Self();
+        x = T(v[0]);
+        y = T(v[1]);
+        z = T(v[2]);
+        w = T(v[3]);
+    }
+    template <typename E, typename VectorOtherScalar<E, T>::Type = 0>
+    VCC_VECTOR_INLINE explicit Vector4(const VectorExpression<E>& e)
+    {
+        const E& v = e.Self();
+        x = T(v[0]);
+        y = T(v[1]);
+        z = T(v[2]);
+        w = T(v[3]);
+    }
+    VCC_VECTOR_INLINE T operator[](int i) const
+    {
+        return (&x)[i];
+    }
     T Dot(const Vector4& v) const
     {
         return x * v.x + y * v.y + z * v.z + w * v.w;
     }
-    Vector4 Lerp(float t, const Vector4& v) const
+    Vector4 Lerp(T t, const Vector4& v) const
     {
         return Vector4(x * (1 - t) + v.x * t,
                        y * (1 - t) + v.y * t,
@@ -197,3 +248,7 @@ typedef Vector4<int> ivec4;
 typedef Vector2<float> vec2;
 typedef Vector3<float> vec3;
 typedef Vector4<float> vec4;
+
+typedef Vector2<double> dvec2;
+typedef Vector3<double> dvec3;
+typedef Vector4<double> dvec4;
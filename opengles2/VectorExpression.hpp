@@ -0,0 +1,265 @@
+//
+//  VectorExpression.hpp
+//  opengles2
+//
+//  以表达式模板实现向量的逐分量运算，将整条运算链合并为一次逐分量求值，不再为每一步运算生成临时向量。
+//
+/*
+ Vector3、Vector4 与 QuaternionT 均派生自 VectorExpression，它们之间的 +、-、一元 -、与标量的 *、/ 以及 Scaled()
+ 不再立即求值，而是返回记录了运算结构的表达式节点；表达式在转换为具体的向量（构造、赋值、传参或 +=、-=）时才逐分量求值：
+   vec3 p = a + (b - a) * t;     // 只计算一次 p.x = a.x + (b.x - a.x) * t，以此类推，不生成 b - a 等临时向量
+ 各分量的运算顺序与逐步求值完全相同，因此结果逐位一致。不同类型的向量（例如 vec3 与 vec4）之间的运算无法通过编译。
+ 表达式节点按值保存子表达式、按引用保存向量本身，因此只能在同一条语句内使用，不可用 auto 保存。
+ 表达式本身只提供逐分量的 Scaled()，Dot()、Normalized() 等其他成员函数须先将表达式转换为具体的向量再调用。
+ 批量数据以 VectorSpan 包装（可带步长，例如 Vertex 数组中的 Position），同样的运算符作用于整个数组，
+ Evaluate() 在一次循环中对每个元素求值并写入输出：
+   Evaluate(&out[0], VectorSpan<vec3>(&a[0], n) + (VectorSpan<vec3>(&b[0], n) - VectorSpan<vec3>(&a[0], n)) * t);
+ 节点的访问函数均强制内联。开启优化时编译器本来也能消除逐步求值的临时对象，两种写法性能相当；
+ 未开启优化的调试版本中，单个向量的表达式与逐步求值相差无几，对整个数组求值的 Evaluate() 则快得多（参见 Tools/Benchmark.cpp
+ 中的 vectormath），调试版本中的热点循环应改用后者。
+ */
+
+#ifndef VectorExpression_hpp
+#define VectorExpression_hpp
+
+#include <stddef.h>
+#include <cmath>
+#include <type_traits>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VCC_VECTOR_INLINE inline __attribute__((always_inline))
+#else
+#define VCC_VECTOR_INLINE inline
+#endif
+
+template <typename A, typename B>
+struct VectorSameValue;
+template <typename A>
+struct VectorSameValue<A, A> {
+    typedef A Type;
+};
+
+// 表达式 E 的分量类型与 T 相同时 VectorSameScalar 定义 Type，不同时 VectorOtherScalar 定义 Type，
+// 向量以表达式构造时据此只允许相同分量类型的隐式转换，其余转换须显式写出。
+template <typename E, typename T, bool Same = std::is_same<typename E::Scalar, T>::value>
+struct VectorSameScalar {
+};
+template <typename E, typename T>
+struct VectorSameScalar<E, T, true> {
+    typedef int Type;
+};
+template <typename E, typename T, bool Same = std::is_same<typename E::Scalar, T>::value>
+struct VectorOtherScalar {
+};
+template <typename E, typename T>
+struct VectorOtherScalar<E, T, false> {
+    typedef int Type;
+};
+
+template <typename E, typename Op>
+class VectorScalar;
+struct VectorMultiply;
+
+// 单个向量的表达式。Derived 须提供：
+//   Value     求值结果的向量类型        Scalar    分量类型
+//   Operand   作为子表达式时的保存方式（向量本身为常量引用，节点为值）
+//   Scalar operator[](int i) const     第 i 个分量
+template <typename Derived>
+struct VectorExpression {
+    VCC_VECTOR_INLINE const Derived& Self() const { return static_cast<const Derived&>(*this); }
+    // 与 operator* 相同，供四元数沿用原有的写法。
+    template <typename S>
+    VCC_VECTOR_INLINE VectorScalar<Derived, VectorMultiply> Scaled(S s) const { return VectorScalar<Derived, VectorMultiply>(Self(), s); }
+};
+
+// 向量数组的表达式。Derived 须提供 Element（单个元素的表达式类型）、Count() 与 Element operator[](size_t n) const。
+template <typename Derived>
+struct VectorArrayExpression {
+    VCC_VECTOR_INLINE const Derived& Self() const { return static_cast<const Derived&>(*this); }
+};
+
+struct VectorAdd {
+    template <typename A, typename B>
+    static VCC_VECTOR_INLINE A Apply(A a, B b) { return a + b; }
+};
+struct VectorSubtract {
+    template <typename A, typename B>
+    static VCC_VECTOR_INLINE A Apply(A a, B b) { return a - b; }
+};
+struct VectorMultiply {
+    template <typename A, typename B>
+    static VCC_VECTOR_INLINE A Apply(A a, B b) { return a * b; }
+};
+struct VectorDivide {
+    template <typename A, typename B>
+    static VCC_VECTOR_INLINE A Apply(A a, B b) { return a / b; }
+};
+
+// 两个向量的逐分量运算。
+template <typename L, typename R, typename Op>
+class VectorBinary : public VectorExpression<VectorBinary<L, R, Op> > {
+public:
+    typedef typename VectorSameValue<typename L::Value, typename R::Value>::Type Value;
+    typedef typename L::Scalar Scalar;
+    typedef VectorBinary Operand;
+    VCC_VECTOR_INLINE VectorBinary(const L& left, const R& right) : m_left(left), m_right(right) {}
+    VCC_VECTOR_INLINE Scalar operator[](int i) const { return Op::Apply(m_left[i], m_right[i]); }
+private:
+    typename L::Operand m_left;
+    typename R::Operand m_right;
+};
+
+// 向量与标量的逐分量运算。
+template <typename E, typename Op>
+class VectorScalar : public VectorExpression<VectorScalar<E, Op> > {
+public:
+    typedef typename E::Value Value;
+    typedef typename E::Scalar Scalar;
+    typedef VectorScalar Operand;
+    VCC_VECTOR_INLINE VectorScalar(const E& operand, Scalar s) : m_operand(operand), m_scalar(s) {}
+    VCC_VECTOR_INLINE Scalar operator[](int i) const { return Op::Apply(m_operand[i], m_scalar); }
+private:
+    typename E::Operand m_operand;
+    Scalar m_scalar;
+};
+
+template <typename E>
+class VectorNegation : public VectorExpression<VectorNegation<E> > {
+public:
+    typedef typename E::Value Value;
+    typedef typename E::Scalar Scalar;
+    typedef VectorNegation Operand;
+    VCC_VECTOR_INLINE explicit VectorNegation(const E& operand) : m_operand(operand) {}
+    VCC_VECTOR_INLINE Scalar operator[](int i) const { return -m_operand[i]; }
+private:
+    typename E::Operand m_operand;
+};
+
+template <typename L, typename R>
+VCC_VECTOR_INLINE VectorBinary<L, R, VectorAdd> operator+(const VectorExpression<L>& l, const VectorExpression<R>& r)
+{
+    return VectorBinary<L, R, VectorAdd>(l.Self(), r.Self());
+}
+
+template <typename L, typename R>
+VCC_VECTOR_INLINE VectorBinary<L, R, VectorSubtract> operator-(const VectorExpression<L>& l, const VectorExpression<R>& r)
+{
+    return VectorBinary<L, R, VectorSubtract>(l.Self(), r.Self());
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorScalar<E, VectorMultiply> operator*(const VectorExpression<E>& e, typename E::Scalar s)
+{
+    return VectorScalar<E, VectorMultiply>(e.Self(), s);
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorScalar<E, VectorDivide> operator/(const VectorExpression<E>& e, typename E::Scalar s)
+{
+    return VectorScalar<E, VectorDivide>(e.Self(), s);
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorNegation<E> operator-(const VectorExpression<E>& e)
+{
+    return VectorNegation<E>(e.Self());
+}
+
+// 向量数组的叶节点：count 个相距 stride 字节的元素，可以指向结构体数组中的某个成员。
+template <typename V>
+class VectorSpan : public VectorArrayExpression<VectorSpan<V> > {
+public:
+    typedef V Element;
+    typedef VectorSpan Operand;
+    VectorSpan(const V* first, size_t count, size_t stride = sizeof(V))
+        : m_first((const unsigned char*) first), m_count(count), m_stride(stride) {}
+    VCC_VECTOR_INLINE size_t Count() const { return m_count; }
+    VCC_VECTOR_INLINE const V& operator[](size_t n) const { return *(const V*) (m_first + n * m_stride); }
+private:
+    const unsigned char* m_first;
+    size_t m_count;
+    size_t m_stride;
+};
+
+// 数组节点的元素即以对应元素构成的单个向量的表达式。
+template <typename L, typename R, typename Op>
+class VectorArrayBinary : public VectorArrayExpression<VectorArrayBinary<L, R, Op> > {
+public:
+    typedef VectorBinary<typename L::Element, typename R::Element, Op> Element;
+    typedef VectorArrayBinary Operand;
+    VCC_VECTOR_INLINE VectorArrayBinary(const L& left, const R& right) : m_left(left), m_right(right) {}
+    VCC_VECTOR_INLINE size_t Count() const { return m_left.Count(); }
+    VCC_VECTOR_INLINE Element operator[](size_t n) const { return Element(m_left[n], m_right[n]); }
+private:
+    typename L::Operand m_left;
+    typename R::Operand m_right;
+};
+
+template <typename E, typename Op>
+class VectorArrayScalar : public VectorArrayExpression<VectorArrayScalar<E, Op> > {
+public:
+    typedef VectorScalar<typename E::Element, Op> Element;
+    typedef VectorArrayScalar Operand;
+    typedef typename E::Element::Scalar Scalar;
+    VCC_VECTOR_INLINE VectorArrayScalar(const E& operand, Scalar s) : m_operand(operand), m_scalar(s) {}
+    VCC_VECTOR_INLINE size_t Count() const { return m_operand.Count(); }
+    VCC_VECTOR_INLINE Element operator[](size_t n) const { return Element(m_operand[n], m_scalar); }
+private:
+    typename E::Operand m_operand;
+    Scalar m_scalar;
+};
+
+template <typename E>
+class VectorArrayNegation : public VectorArrayExpression<VectorArrayNegation<E> > {
+public:
+    typedef VectorNegation<typename E::Element> Element;
+    typedef VectorArrayNegation Operand;
+    VCC_VECTOR_INLINE explicit VectorArrayNegation(const E& operand) : m_operand(operand) {}
+    VCC_VECTOR_INLINE size_t Count() const { return m_operand.Count(); }
+    VCC_VECTOR_INLINE Element operator[](size_t n) const { return Element(m_operand[n]); }
+private:
+    typename E::Operand m_operand;
+};
+
+template <typename L, typename R>
+VCC_VECTOR_INLINE VectorArrayBinary<L, R, VectorAdd> operator+(const VectorArrayExpression<L>& l, const VectorArrayExpression<R>& r)
+{
+    return VectorArrayBinary<L, R, VectorAdd>(l.Self(), r.Self());
+}
+
+template <typename L, typename R>
+VCC_VECTOR_INLINE VectorArrayBinary<L, R, VectorSubtract> operator-(const VectorArrayExpression<L>& l, const VectorArrayExpression<R>& r)
+{
+    return VectorArrayBinary<L, R, VectorSubtract>(l.Self(), r.Self());
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorArrayScalar<E, VectorMultiply> operator*(const VectorArrayExpression<E>& e, typename E::Element::Scalar s)
+{
+    return VectorArrayScalar<E, VectorMultiply>(e.Self(), s);
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorArrayScalar<E, VectorDivide> operator/(const VectorArrayExpression<E>& e, typename E::Element::Scalar s)
+{
+    return VectorArrayScalar<E, VectorDivide>(e.Self(), s);
+}
+
+template <typename E>
+VCC_VECTOR_INLINE VectorArrayNegation<E> operator-(const VectorArrayExpression<E>& e)
+{
+    return VectorArrayNegation<E>(e.Self());
+}
+
+// 对数组表达式逐元素求值，结果写入 out 起始、相距 stride 字节的各元素。
+// 每个输出元素只依赖于各输入数组中的同一元素，因此 out 可以与输入重叠。
+template <typename V, typename E>
+inline void Evaluate(V* out, const VectorArrayExpression<E>& e, size_t stride = sizeof(V))
+{
+    const E& expression = e.Self();
+    unsigned char* bytes = (unsigned char*) out;
+    for (size_t n = 0, count = expression.Count(); n < count; ++n, bytes += stride)
+        *(V*) bytes = V(expression[n]);
+}
+
+#endif /* VectorExpression_hpp */
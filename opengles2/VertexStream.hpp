@@ -0,0 +1,171 @@
+//
+//  VertexStream.hpp
+//  opengles2
+//
+//  每帧变化的几何（形变的椎体、调试线段、粒子标记等）的顶点环形缓冲区：调用者经写指针直接写入映射的 GL 缓冲区。
+//
+/*
+ 若每帧重建 vector<Vertex> 再以客户端指针提交，每帧都要分配内存，驱动在绘制时还要再复制一次。VertexStream 持有一个大的
+ 顶点缓冲区，划分为 regions 个分区轮流使用：第 n 帧写入第 n % regions 个分区，Map() 在当前分区中顺序分配空间并以不同步
+ （unsynchronized）方式映射，调用者直接向返回的指针写入顶点，Unmap() 之后以返回的偏移量设置顶点属性并绘制。
+ GPU 读取较早几帧的分区时 CPU 写入当前分区，两者互不等待。重新使用一个分区之前须确认 GPU 已经读完，有两种方式：
+   VertexStreamFence   每帧结束时在最后一个绘制调用之后插入栅栏；再次轮到该分区时栅栏通常已经完成（计入 StallsAvoided），
+                       否则等待栅栏（计入 Stalls，说明分区数少于 GPU 落后于 CPU 的帧数）
+   VertexStreamOrphan  每轮回到第 0 个分区时孤立整个缓冲区（以空指针重新分配存储）：GPU 仍在读取的旧存储由驱动在读完后回收，
+                       CPU 随即写入新的存储而无需等待（计入 StallsAvoided），适用于不支持栅栏的驱动
+ 一帧的数据超出分区大小时孤立整个缓冲区，从当前分区的起点重新分配（计入 Overflows），各分区原有的栅栏随之作废；
+ 单次分配超过分区大小时 Map() 返回 0，调用者应跳过这次绘制。分配按 16 字节对齐。
+ 缓冲区由引擎的 GLHandle 创建并以 glBufferData 分配存储，VertexStream 只记录其名称；GL 调用由引擎提供的 Traits 完成：
+   typedef ... Fence;
+   static void* Map(unsigned int buffer, size_t offset, size_t bytes);     绑定缓冲区并以不同步方式只写映射该区间
+   static void Unmap(unsigned int buffer);                                 Map() 与 Unmap() 之间不得绑定其他顶点缓冲区
+   static void Orphan(unsigned int buffer, size_t bytes);
+   static Fence InsertFence();
+   static bool FenceSignaled(Fence fence);                                 不等待
+   static void WaitFence(Fence fence);
+   static void DeleteFence(Fence fence);
+ 与 GLHandle 相同，析构（或 Detach()）时须保证创建缓冲区的上下文为当前上下文，并且须先于缓冲区的句柄析构。
+ */
+
+#ifndef VertexStream_hpp
+#define VertexStream_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct VertexStreamStats {
+    uint64_t Frames;
+    uint64_t Allocations;
+    uint64_t BytesStreamed;             // 经写指针写入的字节数
+    uint64_t StallsAvoided;             // 重新使用分区时无需等待 GPU 的次数
+    uint64_t Stalls;                    // 等待栅栏的次数
+    uint64_t Orphans;                   // 孤立整个缓冲区的次数（包括 Overflows）
+    uint64_t Overflows;                 // 一帧的数据超出分区大小的次数
+};
+
+enum VertexStreamSync {
+    VertexStreamFence,
+    VertexStreamOrphan,
+};
+
+template <typename Traits>
+class VertexStream {
+public:
+    VertexStream() : m_buffer(0), m_bytes(0), m_regionBytes(0), m_sync(VertexStreamFence), m_region(0), m_used(0) { ResetStats(); }
+    ~VertexStream() { Detach(); }
+    // buffer 须已分配 bytes 字节的存储（用途为 GL_STREAM_DRAW），各分区为 bytes / regions 字节（向下按 16 字节对齐）。
+    void Attach(unsigned int buffer, size_t bytes, unsigned int regions, VertexStreamSync sync)
+    {
+        Detach();
+        m_buffer = buffer;
+        m_bytes = bytes;
+        m_regionBytes = (bytes / (regions ? regions : 1)) & ~size_t(15);
+        m_sync = sync;
+        m_fences.assign(regions ? regions : 1, Fence());
+        m_pending.assign(m_fences.size(), false);
+        m_region = m_fences.size() - 1;
+        m_used = 0;
+    }
+    // 删除尚未完成的栅栏，此后不再使用缓冲区。
+    void Detach()
+    {
+        DeleteFences();
+        m_buffer = 0;
+    }
+    bool Attached() const { return m_buffer != 0; }
+    unsigned int Buffer() const { return m_buffer; }
+    size_t Bytes() const { return m_bytes; }
+    // 每帧第一次调用 Map() 之前调用：切换至下一个分区，必要时等待其栅栏或孤立缓冲区。
+    void BeginFrame()
+    {
+        if (!m_buffer)
+            return;
+        m_region = (m_region + 1) % m_fences.size();
+        m_used = 0;
+        if (m_sync == VertexStreamOrphan) {
+            if (m_region == 0 && m_stats.Frames > 0) {
+                Traits::Orphan(m_buffer, m_bytes);
+                m_stats.Orphans++;
+                m_stats.StallsAvoided++;
+            }
+        } else if (m_pending[m_region]) {
+            if (Traits::FenceSignaled(m_fences[m_region])) {
+                m_stats.StallsAvoided++;
+            } else {
+                Traits::WaitFence(m_fences[m_region]);
+                m_stats.Stalls++;
+            }
+            Traits::DeleteFence(m_fences[m_region]);
+            m_pending[m_region] = false;
+        }
+    }
+    // 在当前分区中分配并映射 bytes 字节，返回写指针；offset 为其在缓冲区中的偏移量。写入完毕后须调用 Unmap()。
+    void* Map(size_t bytes, size_t& offset)
+    {
+        if (bytes == 0 || bytes > m_regionBytes)
+            return 0;
+        size_t start = (m_used + 15) & ~size_t(15);
+        if (start + bytes > m_regionBytes) {
+            Traits::Orphan(m_buffer, m_bytes);
+            DeleteFences();
+            m_stats.Orphans++;
+            m_stats.Overflows++;
+            start = 0;
+        }
+        offset = m_region * m_regionBytes + start;
+        void* pointer = Traits::Map(m_buffer, offset, bytes);
+        if (!pointer)
+            return 0;
+        m_used = start + bytes;
+        m_stats.Allocations++;
+        m_stats.BytesStreamed += bytes;
+        return pointer;
+    }
+    void Unmap() { Traits::Unmap(m_buffer); }
+    // 每帧最后一个使用本帧数据的绘制调用之后调用。
+    void EndFrame()
+    {
+        if (!m_buffer)
+            return;
+        if (m_sync == VertexStreamFence && m_used > 0) {
+            m_fences[m_region] = Traits::InsertFence();
+            m_pending[m_region] = true;
+        }
+        m_stats.Frames++;
+    }
+    const VertexStreamStats& Stats() const { return m_stats; }
+    void ResetStats()
+    {
+        m_stats.Frames = 0;
+        m_stats.Allocations = 0;
+        m_stats.BytesStreamed = 0;
+        m_stats.StallsAvoided = 0;
+        m_stats.Stalls = 0;
+        m_stats.Orphans = 0;
+        m_stats.Overflows = 0;
+    }
+private:
+    typedef typename Traits::Fence Fence;
+    VertexStream(const VertexStream&);
+    VertexStream& operator=(const VertexStream&);
+    void DeleteFences()
+    {
+        for (size_t i = 0; i < m_pending.size(); ++i) {
+            if (m_pending[i])
+                Traits::DeleteFence(m_fences[i]);
+            m_pending[i] = false;
+        }
+    }
+    unsigned int m_buffer;
+    size_t m_bytes;
+    size_t m_regionBytes;
+    VertexStreamSync m_sync;
+    std::vector<Fence> m_fences;
+    std::vector<bool> m_pending;
+    size_t m_region;
+    size_t m_used;                      // 当前分区中已分配的字节数
+    VertexStreamStats m_stats;
+};
+
+#endif /* VertexStream_hpp */